@@ -0,0 +1,100 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <SFML/Graphics/Transform.hpp>
+
+#include "core/affine2.hpp"
+
+using core::affine2f;
+using core::vec2f;
+
+static constexpr size_t points_count  = 1 << 16;
+static constexpr size_t sprites_count = 1 << 14;
+static constexpr size_t repeats       = 200;
+
+/* Nanoseconds per item */
+template <typename F>
+static double measure(size_t items, F&& function) {
+    function();
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < repeats; ++i) function();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+           double(repeats * items);
+}
+
+static void report(const std::string& name, double sfml_ns, double affine_ns, float difference) {
+    std::cout << name << sfml_ns << " -> " << affine_ns << " ns, x" << sfml_ns / affine_ns << ", max difference "
+              << difference << std::endl;
+}
+
+/*
+ * sf::Transform against affine2f: composition of a batch and a sprite transform with the four quad corners
+ * as the vertex batching path of scene does, and transformation of 65536 points one by one and by transform_points
+ */
+int main() {
+    std::mt19937                          rng(1);
+    std::uniform_real_distribution<float> dist(-100.f, 100.f);
+
+    std::vector<sf::Transform> sprite_transforms(sprites_count);
+    std::vector<affine2f>      sprite_affines(sprites_count);
+    for (size_t i = 0; i < sprites_count; ++i) {
+        sprite_transforms[i].translate(dist(rng), dist(rng)).rotate(dist(rng)).scale(dist(rng) / 50, dist(rng) / 50);
+        sprite_affines[i] = affine2f(sprite_transforms[i]);
+    }
+
+    sf::Transform batch_transform;
+    batch_transform.translate(10.f, 20.f).scale(1.5f, 0.5f, 3.f, 4.f);
+    affine2f batch_affine(batch_transform);
+
+    constexpr float width  = 64.f;
+    constexpr float height = 32.f;
+
+    std::vector<sf::Vector2f> sfml_quads(sprites_count * 4);
+    std::vector<vec2f>        affine_quads(sprites_count * 4);
+
+    auto quads_sfml = measure(sprites_count, [&] {
+        for (size_t i = 0; i < sprites_count; ++i) {
+            auto matrix           = batch_transform * sprite_transforms[i];
+            sfml_quads[i * 4]     = matrix.transformPoint(0.f, 0.f);
+            sfml_quads[i * 4 + 1] = matrix.transformPoint(0.f, height);
+            sfml_quads[i * 4 + 2] = matrix.transformPoint(width, 0.f);
+            sfml_quads[i * 4 + 3] = matrix.transformPoint(width, height);
+        }
+    });
+
+    constexpr std::array<vec2f, 4> corners = {
+        vec2f{0.f, 0.f}, vec2f{0.f, height}, vec2f{width, 0.f}, vec2f{width, height}};
+
+    auto quads_affine = measure(sprites_count, [&] {
+        for (size_t i = 0; i < sprites_count; ++i)
+            (batch_affine * sprite_affines[i]).transform_points(corners, std::span(affine_quads).subspan(i * 4, 4));
+    });
+
+    float quads_difference = 0.f;
+    for (size_t i = 0; i < affine_quads.size(); ++i)
+        quads_difference = std::max(quads_difference, (vec2f(sfml_quads[i]) - affine_quads[i]).magnitude());
+    report("sprite quads:     ", quads_sfml, quads_affine, quads_difference);
+
+    std::vector<vec2f> points(points_count), sfml_points(points_count), affine_points(points_count);
+    for (auto&& point : points) point = vec2f{dist(rng), dist(rng)};
+
+    auto points_sfml = measure(points_count, [&] {
+        for (size_t i = 0; i < points_count; ++i) sfml_points[i] = vec2f(batch_transform.transformPoint(points[i]));
+    });
+    auto points_scalar = measure(points_count, [&] {
+        for (size_t i = 0; i < points_count; ++i) affine_points[i] = batch_affine.transform_point(points[i]);
+    });
+    auto points_batch = measure(points_count, [&] { batch_affine.transform_points(points, affine_points); });
+
+    float points_difference = 0.f;
+    for (size_t i = 0; i < points_count; ++i)
+        points_difference = std::max(points_difference, (sfml_points[i] - affine_points[i]).magnitude());
+    report("transform_point:  ", points_sfml, points_scalar, points_difference);
+    report("transform_points: ", points_sfml, points_batch, points_difference);
+}
@@ -0,0 +1,148 @@
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <SFML/Graphics/Image.hpp>
+
+#include "core/asset_registry.hpp"
+#include "grx/texture_mgr.hpp"
+
+namespace fs = std::filesystem;
+
+static constexpr size_t threads_count = 16;
+static constexpr size_t keys_count    = 1024;
+static constexpr size_t lookups       = 1 << 20; /* Per thread */
+
+/* Runs function(thread_idx) on all threads at once, returns millions of lookups per second */
+template <typename F>
+static double run_threads(F&& function) {
+    std::atomic<bool>        go = false;
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < threads_count; ++i)
+        threads.emplace_back([&, i] {
+            while (!go.load()) std::this_thread::yield();
+            function(i);
+        });
+
+    auto start = std::chrono::steady_clock::now();
+    go.store(true);
+    for (auto&& thread : threads) thread.join();
+
+    auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return double(threads_count * lookups) / seconds / 1e6;
+}
+
+/* Each thread walks the keys with its own stride, so threads hit different and the same keys */
+static size_t key_index(size_t thread_idx, size_t i) {
+    return (i * (2 * thread_idx + 1) + thread_idx) % keys_count;
+}
+
+/*
+ * 16 threads looking up 1024 resident asset keys:
+ * the former texture_mgr layout (std::map under one mutex), an unordered_map under a shared_mutex,
+ * core::asset_registry and texture_mgr::acquire of resident textures
+ * Then 16 threads request the same 64 slow assets at once, every one should be loaded once
+ */
+int main() {
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < keys_count; ++i) keys.push_back("textures/asset_" + std::to_string(i) + ".png");
+
+    std::atomic<size_t> checksum = 0;
+
+    std::map<std::string, size_t> map;
+    std::mutex                    map_mtx;
+    for (size_t i = 0; i < keys_count; ++i) map[keys[i]] = i;
+
+    auto map_mops = run_threads([&](size_t thread_idx) {
+        size_t sum = 0;
+        for (size_t i = 0; i < lookups; ++i) {
+            std::lock_guard lock{map_mtx};
+            sum += map.find(keys[key_index(thread_idx, i)])->second;
+        }
+        checksum += sum;
+    });
+
+    std::unordered_map<std::string, size_t> hash_map;
+    std::shared_mutex                       hash_map_mtx;
+    for (size_t i = 0; i < keys_count; ++i) hash_map[keys[i]] = i;
+
+    auto shared_mops = run_threads([&](size_t thread_idx) {
+        size_t sum = 0;
+        for (size_t i = 0; i < lookups; ++i) {
+            std::shared_lock lock{hash_map_mtx};
+            sum += hash_map.find(keys[key_index(thread_idx, i)])->second;
+        }
+        checksum += sum;
+    });
+
+    core::asset_registry<std::string, size_t> registry;
+    for (size_t i = 0; i < keys_count; ++i) registry.get(keys[i]) = i;
+
+    auto registry_mops = run_threads([&](size_t thread_idx) {
+        size_t sum = 0;
+        for (size_t i = 0; i < lookups; ++i) sum += *registry.find(keys[key_index(thread_idx, i)]);
+        checksum += sum;
+    });
+
+    /* Resident textures, each acquire makes and drops a counted handle */
+    auto dir = fs::temp_directory_path() / "fever_dream_asset_registry_contention";
+    fs::create_directories(dir);
+
+    std::vector<grx::texture_def> defs;
+    for (size_t i = 0; i < 64; ++i) {
+        defs.push_back({(dir / ("texture_" + std::to_string(i) + ".png")).string()});
+
+        sf::Image image;
+        image.create(16, 16, sf::Color(uint8_t(i * 4), 128, 255 - uint8_t(i * 4)));
+        image.saveToFile(defs.back().path);
+    }
+
+    grx::texture_mgr tx_mgr;
+    for (auto&& def : defs) tx_mgr.acquire(def);
+
+    auto acquire_mops = run_threads([&](size_t thread_idx) {
+        size_t sum = 0;
+        for (size_t i = 0; i < lookups; ++i)
+            sum += tx_mgr.acquire(defs[key_index(thread_idx, i) % defs.size()]).is_ready();
+        checksum += sum;
+    });
+
+    /* Single flight, the loader takes 2 ms */
+    core::asset_registry<std::string, size_t> slow_registry;
+    std::atomic<size_t>                       loads = 0;
+
+    auto                     flight_start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (size_t thread_idx = 0; thread_idx < threads_count; ++thread_idx)
+        threads.emplace_back([&, thread_idx] {
+            for (size_t i = 0; i < 64; ++i) {
+                auto idx = (i + thread_idx) % 64;
+                checksum += slow_registry.get_or_load(keys[idx], [&](size_t& value) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+                    value = idx;
+                    ++loads;
+                });
+            }
+        });
+    for (auto&& thread : threads) thread.join();
+    auto flight_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - flight_start).count();
+
+    std::cout << "threads: " << threads_count << ", hardware threads: " << std::thread::hardware_concurrency()
+              << std::endl;
+    std::cout << "map + mutex:              " << map_mops << " M lookups/s" << std::endl;
+    std::cout << "unordered_map + shared:   " << shared_mops << " M lookups/s" << std::endl;
+    std::cout << "asset_registry:           " << registry_mops << " M lookups/s" << std::endl;
+    std::cout << "texture_mgr::acquire:     " << acquire_mops << " M lookups/s" << std::endl;
+    std::cout << "single flight:            " << loads.load() << " loads for " << threads_count * 64 << " requests in "
+              << flight_ms << " ms" << std::endl;
+    std::cout << "checksum:                 " << checksum.load() << std::endl;
+
+    fs::remove_all(dir);
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+namespace bench
+{
+struct result {
+    std::string name;
+    double      value;
+    std::string unit;
+    bool        lower_is_better = true;
+};
+
+/*
+ * Nanoseconds per item of function, which processes items per call: the median of runs timings of repeats calls,
+ * so a preempted run does not move the result
+ */
+template <typename F>
+double measure_ns(size_t items, size_t repeats, F&& function, size_t runs = 7) {
+    function();
+
+    std::vector<double> timings;
+    for (size_t run = 0; run < runs; ++run) {
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < repeats; ++i) function();
+        auto ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        timings.push_back(ns / double(repeats * items));
+    }
+
+    std::nth_element(timings.begin(), timings.begin() + timings.size() / 2, timings.end());
+    return timings[timings.size() / 2];
+}
+
+/*
+ * Collects results of a benchmark run, prints each as it is added and with --json <path> writes them as
+ *   {"suite": name, "results": [{"name", "value", "unit", "lower_is_better"}...]}
+ * --filter <substring> skips cases whose names do not contain it, see enabled()
+ * tools/bench_compare reads two such files and reports regressions
+ */
+class reporter {
+public:
+    reporter(std::string isuite, int argc, char** argv): suite(std::move(isuite)) {
+        for (int i = 1; i + 1 < argc; ++i) {
+            if (std::string_view(argv[i]) == "--json")
+                json_path = argv[++i];
+            else if (std::string_view(argv[i]) == "--filter")
+                filter = argv[++i];
+        }
+    }
+
+    bool enabled(const std::string& name) const {
+        return filter.empty() || name.find(filter) != std::string::npos;
+    }
+
+    void add(const std::string& name, double value, const std::string& unit, bool lower_is_better = true) {
+        std::cout << name << ": " << value << " " << unit << std::endl;
+        results.push_back({name, value, unit, lower_is_better});
+    }
+
+    /* Adds nanoseconds per item of function as measure_ns takes them, if the case is enabled */
+    template <typename F>
+    void measure(const std::string& name, const std::string& unit, size_t items, size_t repeats, F&& function) {
+        if (enabled(name))
+            add(name, measure_ns(items, repeats, std::forward<F>(function)), unit);
+    }
+
+    /* Returns the process exit code, 1 if the JSON file cannot be written */
+    int finish() const {
+        if (json_path.empty())
+            return 0;
+
+        auto json = nlohmann::json::array();
+        for (auto&& r : results)
+            json.push_back(
+                {{"name", r.name}, {"value", r.value}, {"unit", r.unit}, {"lower_is_better", r.lower_is_better}});
+
+        std::ofstream ofs(json_path);
+        ofs << nlohmann::json{{"suite", suite}, {"results", json}}.dump(4) << std::endl;
+        if (!ofs) {
+            std::cerr << "Cannot write '" << json_path << "'" << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+private:
+    std::string         suite;
+    std::string         json_path;
+    std::string         filter;
+    std::vector<result> results;
+};
+
+} // namespace bench
@@ -0,0 +1,86 @@
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#include <SFML/Graphics/Image.hpp>
+
+#include "grx/efx_editor.hpp"
+
+namespace fs = std::filesystem;
+
+static nlohmann::json make_effect_json(size_t idx, const fs::path& texture_path) {
+    using nlohmann::json;
+
+    auto keys = json::array();
+    for (size_t i = 0; i < 32; ++i) {
+        auto t = float(i) / 31.f;
+        keys.push_back({{"time", t}, {"value", {1 + t, 1 + t}}, {"in", {0.41, 0.8}}, {"out", {0.47, 1.64}}});
+    }
+
+    return {
+        {"name", "effect_" + std::to_string(idx)},
+        {"duration", 2.0},
+        {"animations", {{{"name", "scale0"}, {"type", "scale"}, {"apply_to", "all"}, {"keys", keys}}}},
+        {"textures", {{"texture", {{"path", texture_path.string()}}}}},
+        {"templates", {{"sprite", {{"type", "sprite"}, {"texture", "texture"}}}}},
+        {"primitives", {{{"template", "sprite"}}, {{"template", "sprite"}}}},
+    };
+}
+
+/* Returns milliseconds to build all effects, the cache is optional */
+static double load_all(const std::vector<fs::path>& paths, core::disk_cache* cache) {
+    grx::texture_mgr tx_mgr;
+    tx_mgr.set_cache(cache);
+
+    auto start = std::chrono::steady_clock::now();
+    for (auto&& path : paths) {
+        if (cache)
+            grx::efx_editor::efx_builder(tx_mgr, path.string(), *cache).build();
+        else
+            grx::efx_editor::efx_builder(tx_mgr, path.string()).build();
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/*
+ * Builds 200 generated effects, each with its own 512x512 texture:
+ * without cache, with empty cache (parse and store) and with filled cache
+ */
+int main() {
+    constexpr size_t effects_count = 200;
+
+    auto dir       = fs::temp_directory_path() / "fever_dream_efx_cache_startup";
+    auto cache_dir = dir / "cache";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+
+    std::vector<fs::path> paths;
+    for (size_t i = 0; i < effects_count; ++i) {
+        auto texture_path = dir / ("texture_" + std::to_string(i) + ".png");
+
+        sf::Image image;
+        image.create(512, 512, sf::Color(uint8_t(i), 128, 255 - uint8_t(i)));
+        for (unsigned y = 0; y < 512; ++y)
+            for (unsigned x = 0; x < 512; ++x)
+                if ((x ^ y) & 16)
+                    image.setPixel(x, y, sf::Color(uint8_t(x), uint8_t(y), uint8_t(i)));
+        image.saveToFile(texture_path.string());
+
+        paths.push_back(dir / ("effect_" + std::to_string(i) + ".json"));
+        std::ofstream(paths.back()) << make_effect_json(i, texture_path).dump(4);
+    }
+
+    core::disk_cache cache(cache_dir.string(), uint64_t(1) << 30);
+
+    auto no_cache_ms = load_all(paths, nullptr);
+    auto cold_ms     = load_all(paths, &cache);
+    auto warm_ms     = load_all(paths, &cache);
+
+    std::cout << "effects: " << effects_count << std::endl;
+    std::cout << "no cache:   " << no_cache_ms << " ms" << std::endl;
+    std::cout << "cold cache: " << cold_ms << " ms" << std::endl;
+    std::cout << "warm cache: " << warm_ms << " ms (" << cache.get_size() / (1 << 20) << " MiB cached)" << std::endl;
+
+    fs::remove_all(dir);
+}
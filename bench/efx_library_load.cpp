@@ -0,0 +1,93 @@
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#include <SFML/Graphics/Image.hpp>
+
+#include "grx/efx_library.hpp"
+
+namespace fs = std::filesystem;
+
+static nlohmann::json make_effect_json(size_t idx, const fs::path& texture_dir, size_t textures_count) {
+    using nlohmann::json;
+
+    auto make_keys = [](size_t count, auto&& value) {
+        auto keys = json::array();
+        for (size_t i = 0; i < count; ++i) {
+            auto t = float(i) / float(count - 1);
+            keys.push_back({{"time", t}, {"value", value(t)}, {"in", {0.41, 0.8}}, {"out", {0.47, 1.64}}});
+        }
+        return keys;
+    };
+
+    auto animations = json::array();
+    animations.push_back({{"name", "scale0"},
+                          {"type", "scale"},
+                          {"apply_to", "all"},
+                          {"keys", make_keys(32, [](float t) { return json{1 + t, 1 + t}; })}});
+    animations.push_back({{"name", "rotation0"},
+                          {"type", "rotation"},
+                          {"apply_to", "all"},
+                          {"keys", make_keys(32, [](float t) { return 360 * t; })}});
+
+    auto textures  = json::object();
+    auto templates = json::object();
+    for (size_t i = 0; i < 4; ++i) {
+        auto texture_name = "texture" + std::to_string(i);
+        auto texture_path = texture_dir / ("texture_" + std::to_string((idx + i) % textures_count) + ".png");
+
+        textures[texture_name]                  = {{"path", texture_path.string()}};
+        templates["sprite" + std::to_string(i)] = {{"type", "sprite"}, {"texture", texture_name}};
+    }
+
+    auto primitives = json::array();
+    for (size_t i = 0; i < 16; ++i) primitives.push_back({{"template", "sprite" + std::to_string(i % 4)}});
+
+    return {
+        {"name", "effect_" + std::to_string(idx)},
+        {"duration", 2.0},
+        {"animations", animations},
+        {"textures", textures},
+        {"templates", templates},
+        {"primitives", primitives},
+    };
+}
+
+/*
+ * Builds 500 generated effects sharing 32 textures with 1, 4 and 8 loader threads
+ */
+int main() {
+    constexpr size_t effects_count  = 500;
+    constexpr size_t textures_count = 32;
+
+    auto dir = fs::temp_directory_path() / "fever_dream_efx_library_load";
+    fs::create_directories(dir);
+
+    for (size_t i = 0; i < textures_count; ++i) {
+        sf::Image image;
+        image.create(512, 512, sf::Color(uint8_t(i * 8), 128, 255 - uint8_t(i * 8)));
+        image.saveToFile((dir / ("texture_" + std::to_string(i) + ".png")).string());
+    }
+
+    for (size_t i = 0; i < effects_count; ++i)
+        std::ofstream(dir / ("effect_" + std::to_string(i) + ".json")) << make_effect_json(i, dir, textures_count).dump(4);
+
+    auto paths = grx::efx_editor::efx_library_loader::list_directory(dir.string());
+
+    std::cout << "effects: " << paths.size() << ", textures: " << textures_count << std::endl;
+
+    for (size_t threads : {1, 4, 8}) {
+        grx::texture_mgr tx_mgr;
+        grx::scene       scene;
+        grx::efx_mgr     efx_mgr{scene};
+
+        auto start = std::chrono::steady_clock::now();
+        grx::efx_editor::efx_library_loader(tx_mgr, threads).load(efx_mgr, paths);
+        auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        std::cout << "threads " << threads << ": " << ms << " ms" << std::endl;
+    }
+
+    fs::remove_all(dir);
+}
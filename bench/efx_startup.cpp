@@ -0,0 +1,113 @@
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#include "grx/efx_binary.hpp"
+#include "grx/efx_editor.hpp"
+#include "grx/efx_sax_builder.hpp"
+
+namespace fs = std::filesystem;
+
+static nlohmann::json make_effect_json(size_t idx) {
+    using nlohmann::json;
+
+    auto make_keys = [](size_t count, auto&& value) {
+        auto keys = json::array();
+        for (size_t i = 0; i < count; ++i) {
+            auto t   = float(i) / float(count - 1);
+            auto key = json{{"time", t}, {"value", value(t)}};
+            if (i % 2)
+                key["in"] = {0.41, 0.8};
+            if (i + 1 < count)
+                key["out"] = {0.47, 1.64};
+            keys.push_back(key);
+        }
+        return keys;
+    };
+
+    auto animations = json::array();
+    animations.push_back({{"name", "scale0"},
+                          {"type", "scale"},
+                          {"apply_to", "all"},
+                          {"keys", make_keys(16, [](float t) { return json{1 + t, 1 + t}; })}});
+    animations.push_back({{"name", "rotation0"},
+                          {"type", "rotation"},
+                          {"apply_to", "all"},
+                          {"keys", make_keys(16, [](float t) { return 360 * t; })}});
+    animations.push_back({{"name", "position0"},
+                          {"type", "position"},
+                          {"apply_to", {0, 2}},
+                          {"keys", make_keys(16, [](float t) { return json{600 * t, 400 * t}; })}});
+
+    auto templates = json::object();
+    templates["square"] = {{"type", "rect"}, {"fill_color", "#ff00ffff"}, {"size", {100, 100}}, {"origin", {50, 50}}};
+    templates["circle"] = {{"type", "circle"}, {"fill_color", "#ffff00ff"}, {"radius", 20}, {"point_count", 64}};
+
+    auto primitives = json::array();
+    for (size_t i = 0; i < 8; ++i) primitives.push_back({{"template", i % 2 ? "square" : "circle"}});
+
+    return {
+        {"name", "effect_" + std::to_string(idx)},
+        {"duration", 2.0},
+        {"animations", animations},
+        {"templates", templates},
+        {"primitives", primitives},
+    };
+}
+
+template <typename Loader>
+static double load_all(const std::vector<fs::path>& paths, size_t& elements) {
+    grx::texture_mgr tx_mgr;
+
+    auto start = std::chrono::steady_clock::now();
+    for (auto&& path : paths) {
+        auto [name, effect] = Loader(tx_mgr, path.string()).build();
+        elements += effect.get_elements().size();
+    }
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/*
+ * Builds 1000 generated effects from JSON (DOM and SAX) and from compiled binaries
+ */
+int main() {
+    constexpr size_t effects_count = 1000;
+
+    auto dir = fs::temp_directory_path() / "fever_dream_efx_startup";
+    fs::create_directories(dir);
+
+    std::vector<fs::path> json_paths;
+    std::vector<fs::path> binary_paths;
+
+    grx::texture_mgr tx_mgr;
+    for (size_t i = 0; i < effects_count; ++i) {
+        auto json_path   = dir / ("effect_" + std::to_string(i) + ".json");
+        auto binary_path = dir / ("effect_" + std::to_string(i) + ".efxb");
+
+        std::ofstream(json_path) << make_effect_json(i).dump(4);
+
+        grx::efx_editor::efx_binary_writer writer;
+        writer.write(grx::efx_editor::efx_builder(tx_mgr, json_path.string()).describe());
+        writer.save(binary_path.string());
+
+        json_paths.push_back(json_path);
+        binary_paths.push_back(binary_path);
+    }
+
+    size_t json_elements   = 0;
+    size_t sax_elements    = 0;
+    size_t binary_elements = 0;
+
+    auto json_ms   = load_all<grx::efx_editor::efx_builder>(json_paths, json_elements);
+    auto sax_ms    = load_all<grx::efx_editor::efx_sax_builder>(json_paths, sax_elements);
+    auto binary_ms = load_all<grx::efx_editor::efx_binary_loader>(binary_paths, binary_elements);
+
+    std::cout << "effects: " << effects_count << std::endl;
+    std::cout << "json:   " << json_ms << " ms (" << json_elements << " elements)" << std::endl;
+    std::cout << "sax:    " << sax_ms << " ms (" << sax_elements << " elements)" << std::endl;
+    std::cout << "binary: " << binary_ms << " ms (" << binary_elements << " elements)" << std::endl;
+    std::cout << "speedup: " << json_ms / binary_ms << "x" << std::endl;
+
+    fs::remove_all(dir);
+}
@@ -0,0 +1,241 @@
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "core/fastmath.hpp"
+
+namespace fastmath = core::fastmath;
+using core::vec2f;
+
+static constexpr size_t block_size = 4096;
+static constexpr size_t repeats    = 2000;
+
+/* Largest error against the double reference and count of span results which differ from the scalar ones */
+struct error_stats {
+    double max_error  = 0.;
+    float  worst_arg  = 0.f;
+    size_t mismatches = 0;
+    size_t samples    = 0;
+
+    void add(double error, float arg) {
+        ++samples;
+        if (error > max_error) {
+            max_error = error;
+            worst_arg = arg;
+        }
+    }
+};
+
+static bool failed = false;
+
+static void report(const std::string& name, const error_stats& stats, float bound) {
+    auto ok = stats.max_error <= double(bound) && stats.mismatches == 0;
+    failed  = failed || !ok;
+    std::cout << name << stats.samples << " samples, max error " << stats.max_error << " at " << stats.worst_arg
+              << ", bound " << bound << ", span mismatches " << stats.mismatches << (ok ? "" : "  FAILED")
+              << std::endl;
+}
+
+/* Calls block(args) for every stride-th float bit pattern from first to last and their negations */
+template <typename F>
+static void for_floats(float first, float last, uint32_t stride, bool negate, F&& block) {
+    std::vector<float> args;
+    args.reserve(block_size);
+    for (auto bits = std::bit_cast<uint32_t>(first); bits <= std::bit_cast<uint32_t>(last); bits += stride) {
+        args.push_back(std::bit_cast<float>(bits));
+        if (negate)
+            args.push_back(-std::bit_cast<float>(bits));
+        if (args.size() >= block_size) {
+            block(args);
+            args.clear();
+        }
+    }
+    if (!args.empty())
+        block(args);
+}
+
+static error_stats check_sincos(bool cosine) {
+    error_stats        stats;
+    std::vector<float> sines(block_size), cosines(block_size);
+    for_floats(0.f, 8192.f, 32, true, [&](const std::vector<float>& args) {
+        fastmath::sincos(args, sines, cosines);
+        for (size_t i = 0; i < args.size(); ++i) {
+            float s, c;
+            fastmath::sincos(args[i], s, c);
+            auto result = cosine ? c : s;
+            auto span   = cosine ? cosines[i] : sines[i];
+            stats.mismatches += std::bit_cast<uint32_t>(result) != std::bit_cast<uint32_t>(span);
+            auto exact = cosine ? std::cos(double(args[i])) : std::sin(double(args[i]));
+            stats.add(std::abs(double(result) - exact), args[i]);
+        }
+    });
+    return stats;
+}
+
+static error_stats check_exp() {
+    error_stats        stats;
+    std::vector<float> results(block_size);
+    auto               check = [&](const std::vector<float>& args) {
+        fastmath::exp(args, results);
+        for (size_t i = 0; i < args.size(); ++i) {
+            auto result = fastmath::exp(args[i]);
+            stats.mismatches += std::bit_cast<uint32_t>(result) != std::bit_cast<uint32_t>(results[i]);
+            auto exact = std::exp(double(args[i]));
+            stats.add(std::abs(double(result) - exact) / exact, args[i]);
+        }
+    };
+    for_floats(0.f, 88.f, 32, false, check);
+    for_floats(-0.f, -87.f, 32, false, check);
+    return stats;
+}
+
+/* All floats in [1, 4) cover every mantissa for both exponent parities, the relative error repeats in other binades */
+static error_stats check_rsqrt() {
+    error_stats        stats;
+    std::vector<float> results(block_size);
+    for_floats(1.f, std::nextafter(4.f, 0.f), 1, false, [&](const std::vector<float>& args) {
+        fastmath::rsqrt(args, results);
+        for (size_t i = 0; i < args.size(); ++i) {
+            auto result = fastmath::rsqrt(args[i]);
+            stats.mismatches += std::bit_cast<uint32_t>(result) != std::bit_cast<uint32_t>(results[i]);
+            auto exact = 1. / std::sqrt(double(args[i]));
+            stats.add(std::abs(double(result) - exact) / exact, args[i]);
+        }
+    });
+    return stats;
+}
+
+/* Components spread over magnitudes from 2^-20 to 2^20, the worst argument reported is y */
+static error_stats check_atan2(std::mt19937& rng) {
+    std::uniform_real_distribution<float> exponent(-20.f, 20.f);
+    std::uniform_int_distribution<int>    sign(0, 1);
+    auto random = [&] { return (sign(rng) ? -1.f : 1.f) * std::exp2(exponent(rng)); };
+
+    error_stats        stats;
+    std::vector<float> ys(block_size), xs(block_size), results(block_size);
+    for (size_t block = 0; block < 4096; ++block) {
+        for (size_t i = 0; i < block_size; ++i) {
+            ys[i] = random();
+            xs[i] = i % 64 == 0 ? 0.f : random();
+        }
+        fastmath::atan2(ys, xs, results);
+        for (size_t i = 0; i < block_size; ++i) {
+            auto result = fastmath::atan2(ys[i], xs[i]);
+            stats.mismatches += std::bit_cast<uint32_t>(result) != std::bit_cast<uint32_t>(results[i]);
+            stats.add(std::abs(double(result) - std::atan2(double(ys[i]), double(xs[i]))), ys[i]);
+        }
+    }
+    return stats;
+}
+
+/* Error of components of unit vectors, the worst argument reported is x */
+static error_stats check_normalize(std::mt19937& rng) {
+    std::uniform_real_distribution<float> dist(-1000.f, 1000.f);
+
+    error_stats        stats;
+    std::vector<vec2f> vecs(block_size), results(block_size);
+    for (size_t block = 0; block < 1024; ++block) {
+        for (auto&& v : vecs) v = vec2f{dist(rng), dist(rng)};
+        fastmath::normalize(vecs, results);
+        for (size_t i = 0; i < block_size; ++i) {
+            auto result = fastmath::normalize(vecs[i]);
+            stats.mismatches += result.x() != results[i].x() || result.y() != results[i].y();
+
+            auto x         = double(vecs[i].x());
+            auto y         = double(vecs[i].y());
+            auto magnitude = std::sqrt(x * x + y * y);
+            auto error     = std::max(std::abs(double(result.x()) - x / magnitude),
+                                      std::abs(double(result.y()) - y / magnitude));
+            stats.add(error, vecs[i].x());
+        }
+    }
+    return stats;
+}
+
+/* Nanoseconds per element */
+template <typename F>
+static double measure(F&& function) {
+    function();
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < repeats; ++i) function();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+           double(repeats * block_size);
+}
+
+static void report_time(const std::string& name, double std_ns, double scalar_ns, double span_ns) {
+    std::cout << name << std_ns << " -> scalar " << scalar_ns << " (x" << std_ns / scalar_ns << "), span " << span_ns
+              << " (x" << std_ns / span_ns << ") ns/element" << std::endl;
+}
+
+/*
+ * Checks the documented error bounds of core::fastmath and that span variants give the same bits as scalar ones:
+ * sin, cos and exp on every 32nd float of their ranges, rsqrt on every float of [1, 4),
+ * atan2 and normalize on random arguments, then compares times with the std functions
+ * Exits with 1 if a bound is exceeded
+ */
+int main() {
+    std::mt19937 rng(1);
+
+    report("sin:       ", check_sincos(false), fastmath::sin_max_error);
+    report("cos:       ", check_sincos(true), fastmath::cos_max_error);
+    report("atan2:     ", check_atan2(rng), fastmath::atan2_max_error);
+    report("exp:       ", check_exp(), fastmath::exp_max_error);
+    report("rsqrt:     ", check_rsqrt(), fastmath::rsqrt_max_error);
+    report("normalize: ", check_normalize(rng), fastmath::rsqrt_max_error + std::numeric_limits<float>::epsilon());
+
+    std::uniform_real_distribution<float> dist(-10.f, 10.f);
+    std::vector<float> args(block_size), ys(block_size), out(block_size), out2(block_size);
+    std::vector<vec2f> vecs(block_size), vec_out(block_size);
+    for (size_t i = 0; i < block_size; ++i) {
+        args[i] = dist(rng);
+        ys[i]   = dist(rng);
+        vecs[i] = vec2f{dist(rng), dist(rng)};
+    }
+
+    auto sincos_std = measure([&] {
+        for (size_t i = 0; i < block_size; ++i) {
+            out[i]  = std::sin(args[i]);
+            out2[i] = std::cos(args[i]);
+        }
+    });
+    auto sincos_scalar = measure([&] {
+        for (size_t i = 0; i < block_size; ++i) fastmath::sincos(args[i], out[i], out2[i]);
+    });
+    auto sincos_span = measure([&] { fastmath::sincos(args, out, out2); });
+    report_time("sincos:    ", sincos_std, sincos_scalar, sincos_span);
+
+    auto atan2_std = measure([&] {
+        for (size_t i = 0; i < block_size; ++i) out[i] = std::atan2(ys[i], args[i]);
+    });
+    auto atan2_scalar = measure([&] {
+        for (size_t i = 0; i < block_size; ++i) out[i] = fastmath::atan2(ys[i], args[i]);
+    });
+    auto atan2_span = measure([&] { fastmath::atan2(ys, args, out); });
+    report_time("atan2:     ", atan2_std, atan2_scalar, atan2_span);
+
+    auto exp_std = measure([&] {
+        for (size_t i = 0; i < block_size; ++i) out[i] = std::exp(args[i]);
+    });
+    auto exp_scalar = measure([&] {
+        for (size_t i = 0; i < block_size; ++i) out[i] = fastmath::exp(args[i]);
+    });
+    auto exp_span = measure([&] { fastmath::exp(args, out); });
+    report_time("exp:       ", exp_std, exp_scalar, exp_span);
+
+    auto normalize_vec = measure([&] {
+        for (size_t i = 0; i < block_size; ++i) vec_out[i] = vecs[i].normalize();
+    });
+    auto normalize_scalar = measure([&] {
+        for (size_t i = 0; i < block_size; ++i) vec_out[i] = fastmath::normalize(vecs[i]);
+    });
+    auto normalize_span = measure([&] { fastmath::normalize(vecs, vec_out); });
+    report_time("normalize: ", normalize_vec, normalize_scalar, normalize_span);
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,256 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <SFML/Graphics/CircleShape.hpp>
+
+#include "core/noise.hpp"
+#include "grx/efx.hpp"
+
+namespace noise = core::noise;
+using core::vec2f;
+using core::vec3f;
+
+static constexpr size_t samples_count = 1 << 16;
+static constexpr size_t repeats       = 50;
+
+/* Improved noise with the permutation table of the reference implementation, the per-element scalar baseline */
+class table_perlin {
+public:
+    table_perlin() {
+        std::array<uint8_t, 256> p;
+        std::iota(p.begin(), p.end(), uint8_t(0));
+        std::shuffle(p.begin(), p.end(), std::mt19937(1));
+        for (size_t i = 0; i < 512; ++i) perm[i] = p[i & 255];
+    }
+
+    float operator()(float x, float y, float z) const {
+        auto fx = std::floor(x);
+        auto fy = std::floor(y);
+        auto fz = std::floor(z);
+        auto xi = int(fx) & 255;
+        auto yi = int(fy) & 255;
+        auto zi = int(fz) & 255;
+        x -= fx;
+        y -= fy;
+        z -= fz;
+        auto u = fade(x);
+        auto v = fade(y);
+        auto w = fade(z);
+
+        auto a  = perm[xi] + yi;
+        auto aa = perm[a] + zi;
+        auto ab = perm[a + 1] + zi;
+        auto b  = perm[xi + 1] + yi;
+        auto ba = perm[b] + zi;
+        auto bb = perm[b + 1] + zi;
+
+        return lerp(lerp(lerp(grad(perm[aa], x, y, z), grad(perm[ba], x - 1, y, z), u),
+                         lerp(grad(perm[ab], x, y - 1, z), grad(perm[bb], x - 1, y - 1, z), u),
+                         v),
+                    lerp(lerp(grad(perm[aa + 1], x, y, z - 1), grad(perm[ba + 1], x - 1, y, z - 1), u),
+                         lerp(grad(perm[ab + 1], x, y - 1, z - 1), grad(perm[bb + 1], x - 1, y - 1, z - 1), u),
+                         v),
+                    w);
+    }
+
+private:
+    static float fade(float t) {
+        return t * t * t * (t * (t * 6 - 15) + 10);
+    }
+
+    static float lerp(float a, float b, float t) {
+        return a + (b - a) * t;
+    }
+
+    static float grad(int hash, float x, float y, float z) {
+        auto h = hash & 15;
+        auto u = h < 8 ? x : y;
+        auto v = h < 4 ? y : (h == 12 || h == 14 ? x : z);
+        return ((h & 1) ? -u : u) + ((h & 2) ? -v : v);
+    }
+
+    std::array<int, 512> perm;
+};
+
+/* Millions of samples per second */
+template <typename F>
+static double msamples(F&& function) {
+    function();
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < repeats; ++i) function();
+    auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return double(repeats * samples_count) / seconds / 1e6;
+}
+
+static std::vector<float> xs(samples_count), ys(samples_count), zs(samples_count);
+static std::vector<float> scalar_out(samples_count), span_out(samples_count);
+
+/* Throughput of the scalar function and of the span variant, extremes and count of differing results */
+template <typename S, typename V>
+static void report(const std::string& name, S&& scalar, V&& span) {
+    auto scalar_rate = msamples([&] {
+        for (size_t i = 0; i < samples_count; ++i) scalar_out[i] = scalar(i);
+    });
+    auto span_rate = msamples(span);
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < samples_count; ++i)
+        mismatches += std::bit_cast<uint32_t>(scalar_out[i]) != std::bit_cast<uint32_t>(span_out[i]);
+    auto [min, max] = std::minmax_element(span_out.begin(), span_out.end());
+
+    std::cout << name << scalar_rate << " -> " << span_rate << " Msamples/s, x" << span_rate / scalar_rate
+              << ", range [" << *min << ", " << *max << "], span mismatches " << mismatches << std::endl;
+}
+
+/* Milliseconds per update of an effect with 1024 elements and the turbulence handler */
+static double turbulence_ms() {
+    grx::scene scene;
+    grx::efx   effect;
+    effect.set_duration(grx::duration_endless);
+    for (size_t i = 0; i < 1024; ++i) {
+        sf::CircleShape element{4};
+        element.setPosition(float(i % 32) * 24.f, float(i / 32) * 24.f);
+        effect.get_elements().push_back(element);
+    }
+    effect.add_handler("turbulence", grx::efx_handlers::turbulence(8.f, 0.02f, 2.f));
+
+    grx::efx_instance instance(scene, 0, effect);
+    instance.update(0.016f);
+
+    constexpr size_t updates = 200;
+    auto             start   = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < updates; ++i) instance.update(0.016f);
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / updates;
+}
+
+struct path_offset_stats {
+    float max_offset = 0.f;
+    float max_error  = 0.f;
+};
+
+/*
+ * Offsets of elements moved along a path and displaced by turbulence from the path position: the largest component
+ * and the largest difference from the noise sampled at the path position
+ * The path handler is added under path_name, so it runs before or after turbulence in name order
+ */
+static path_offset_stats turbulence_path_offset(const std::string& path_name, float amplitude) {
+    constexpr float duration  = 4.f;
+    constexpr float timestep  = 0.016f;
+    constexpr float frequency = 0.02f;
+    constexpr float speed     = 2.f;
+
+    grx::anim_path path({{0.f, 0.f}, {400.f, 100.f}, {800.f, 0.f}, {400.f, 300.f}});
+
+    grx::scene scene;
+    grx::efx   effect;
+    effect.set_duration(duration);
+    for (size_t i = 0; i < 64; ++i) effect.get_elements().push_back(sf::CircleShape{4});
+    effect.add_handler(path_name, grx::efx_handlers::path(path));
+    effect.add_handler("turbulence", grx::efx_handlers::turbulence(amplitude, frequency, speed));
+
+    grx::efx_instance instance(scene, 0, effect);
+    path_offset_stats stats;
+    for (float time = 0.f; time < duration; time += timestep) {
+        instance.update(timestep);
+
+        auto base   = path.position(time / duration);
+        auto sample = vec3f{base.x() * frequency, base.y() * frequency, time * speed};
+        auto noise  = vec2f{noise::simplex(sample), noise::simplex(sample, 1)} * amplitude;
+        for (auto&& element : instance.get_elements()) {
+            auto offset      = vec2f(std::get<sf::CircleShape>(element).getPosition()) - base;
+            stats.max_offset = std::max({stats.max_offset, std::abs(offset.x()), std::abs(offset.y())});
+            stats.max_error  = std::max({stats.max_error,
+                                         std::abs(offset.x() - noise.x()),
+                                         std::abs(offset.y() - noise.y())});
+        }
+    }
+    return stats;
+}
+
+/*
+ * Samples per second of every noise over 65536 random points, the scalar functions against the span variants,
+ * the 3D permutation table Perlin noise evaluated per element is the baseline
+ * Ranges are the extremes over the sampled points
+ * Then checks that turbulence displaces elements moved by path by the noise at the path position, within its
+ * amplitude whatever the handler order, exits with 1 otherwise
+ */
+int main() {
+    std::mt19937                          rng(1);
+    std::uniform_real_distribution<float> dist(-1000.f, 1000.f);
+    for (size_t i = 0; i < samples_count; ++i) {
+        xs[i] = dist(rng);
+        ys[i] = dist(rng);
+        zs[i] = dist(rng);
+    }
+
+    table_perlin reference;
+    auto         reference_rate = msamples([&] {
+        for (size_t i = 0; i < samples_count; ++i) scalar_out[i] = reference(xs[i], ys[i], zs[i]);
+    });
+    std::cout << "table perlin 3D: " << reference_rate << " Msamples/s" << std::endl;
+
+    report(
+        "value 1D:        ", [](size_t i) { return noise::value(xs[i]); }, [] { noise::value(xs, span_out); });
+    report(
+        "value 2D:        ",
+        [](size_t i) { return noise::value(vec2f{xs[i], ys[i]}); },
+        [] { noise::value(xs, ys, span_out); });
+    report(
+        "value 3D:        ",
+        [](size_t i) { return noise::value(vec3f{xs[i], ys[i], zs[i]}); },
+        [] { noise::value(xs, ys, zs, span_out); });
+    report(
+        "perlin 1D:       ", [](size_t i) { return noise::perlin(xs[i]); }, [] { noise::perlin(xs, span_out); });
+    report(
+        "perlin 2D:       ",
+        [](size_t i) { return noise::perlin(vec2f{xs[i], ys[i]}); },
+        [] { noise::perlin(xs, ys, span_out); });
+    report(
+        "perlin 3D:       ",
+        [](size_t i) { return noise::perlin(vec3f{xs[i], ys[i], zs[i]}); },
+        [] { noise::perlin(xs, ys, zs, span_out); });
+    report(
+        "simplex 1D:      ", [](size_t i) { return noise::simplex(xs[i]); }, [] { noise::simplex(xs, span_out); });
+    report(
+        "simplex 2D:      ",
+        [](size_t i) { return noise::simplex(vec2f{xs[i], ys[i]}); },
+        [] { noise::simplex(xs, ys, span_out); });
+    report(
+        "simplex 3D:      ",
+        [](size_t i) { return noise::simplex(vec3f{xs[i], ys[i], zs[i]}); },
+        [] { noise::simplex(xs, ys, zs, span_out); });
+
+    /* Only x components of curl are compared */
+    std::vector<float> curl_ys(samples_count), curl_zs(samples_count);
+    report(
+        "curl 2D:         ",
+        [](size_t i) { return noise::curl(vec2f{xs[i], ys[i]}).x(); },
+        [&] { noise::curl(xs, ys, span_out, curl_ys); });
+    report(
+        "curl 3D:         ",
+        [](size_t i) { return noise::curl(vec3f{xs[i], ys[i], zs[i]}).x(); },
+        [&] { noise::curl(xs, ys, zs, span_out, curl_ys, curl_zs); });
+
+    std::cout << "turbulence handler, 1024 elements: " << turbulence_ms() << " ms/update" << std::endl;
+
+    constexpr float amplitude = 8.f;
+    bool            failed    = false;
+    for (auto&& path_name : {"path", "z_path"}) {
+        auto stats = turbulence_path_offset(path_name, amplitude);
+        auto ok    = stats.max_offset <= amplitude * (1.f + 1e-5f) && stats.max_error < 1e-3f;
+        failed     = failed || !ok;
+        std::cout << "turbulence with " << path_name << ": max offset from path " << stats.max_offset
+                  << ", amplitude " << amplitude << ", max error against noise " << stats.max_error
+                  << (ok ? "" : "  FAILED") << std::endl;
+    }
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,108 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <numbers>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "grx/keyframe_animation.hpp"
+#include "grx/path_animation.hpp"
+
+using core::vec2f;
+
+static constexpr size_t samples_count = 1 << 16;
+static constexpr size_t repeats       = 100;
+static constexpr size_t frames_count  = 240;
+
+/* Nanoseconds per sample */
+template <typename F>
+static double measure(F&& function) {
+    function();
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < repeats; ++i) function();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+           double(repeats * samples_count);
+}
+
+/*
+ * Largest deviation of distances moved per frame from their mean over 4 seconds at 60 fps, in percents,
+ * distances are measured along 64 substeps of the frame so they follow the curve
+ */
+static double speed_deviation(auto&& position_at) {
+    constexpr size_t substeps = 64;
+
+    std::vector<double> steps;
+    for (size_t i = 0; i < frames_count; ++i) {
+        auto step = 0.;
+        auto from = position_at(float(i) / float(frames_count));
+        for (size_t j = 1; j <= substeps; ++j) {
+            auto to = position_at((float(i) + float(j) / float(substeps)) / float(frames_count));
+            step += (to - from).magnitude();
+            from = to;
+        }
+        steps.push_back(step);
+    }
+
+    auto mean = 0.;
+    for (auto step : steps) mean += step;
+    mean /= double(steps.size());
+
+    auto deviation = 0.;
+    for (auto step : steps) deviation = std::max(deviation, std::abs(step - mean));
+    return deviation / mean * 100.;
+}
+
+/* Same points as linear keys evenly spread over time, as a position animation through them is written today */
+static grx::anim_key_sequence<vec2f> make_keys(const std::vector<vec2f>& points) {
+    grx::anim_key_sequence<vec2f> keys;
+    for (size_t i = 0; i < points.size(); ++i) keys.push_linear(points[i], float(i) / float(points.size() - 1));
+    return keys;
+}
+
+static void report(std::mt19937& rng, size_t points_count) {
+    /* Unevenly spaced points of a spiral with four turns */
+    std::uniform_real_distribution<float> dist(0.f, 8.f * std::numbers::pi_v<float>);
+    std::vector<float>                    angles(points_count);
+    for (auto&& angle : angles) angle = dist(rng);
+    std::sort(angles.begin(), angles.end());
+
+    std::vector<vec2f> points;
+    for (auto angle : angles) points.push_back(vec2f{std::cos(angle), std::sin(angle)} * (100.f + 20.f * angle));
+
+    auto build_start = std::chrono::steady_clock::now();
+    auto path        = grx::anim_path(points);
+    auto build_us =
+        std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - build_start).count();
+    auto keys = make_keys(points);
+
+    /* Time 0 is left out, keys interpolate from a zero time key before the first one there */
+    std::vector<float> times(samples_count);
+    for (size_t i = 0; i < samples_count; ++i) times[i] = float(i + 1) / float(samples_count);
+    std::vector<vec2f> path_positions(samples_count), key_positions(samples_count);
+
+    auto keys_ns = measure([&] {
+        for (size_t i = 0; i < samples_count; ++i) key_positions[i] = keys.lookup(times[i]);
+    });
+    auto orient_ns = measure([&] {
+        for (size_t i = 0; i < samples_count; ++i) path_positions[i] = path.lookup(times[i]).position;
+    });
+    auto path_ns = measure([&] {
+        for (size_t i = 0; i < samples_count; ++i) path_positions[i] = path.position(times[i]);
+    });
+
+    std::cout << points_count << " points: keys " << keys_ns << " -> path " << path_ns << ", with tangent "
+              << orient_ns << " ns/sample, build " << build_us << " us, speed deviation keys "
+              << speed_deviation([&](float time) { return keys.lookup(std::max(time, 1e-6f)); }) << "% -> path "
+              << speed_deviation([&](float time) { return path.position(time); }) << "%" << std::endl;
+}
+
+/*
+ * Positions along a spiral through random control points sampled at 65536 time steps: linear anim_key_sequence
+ * against anim_path, which follows a spline, keeps the speed even and costs the same whatever the number of points is
+ */
+int main() {
+    std::mt19937 rng(1);
+    for (auto points_count : {4, 16, 64, 256, 1024}) report(rng, size_t(points_count));
+}
@@ -0,0 +1,93 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <SFML/Graphics/Texture.hpp>
+
+#include "grx/render_backend.hpp"
+
+using grx::recording_backend;
+
+struct expected_command {
+    sf::PrimitiveType  primitive;
+    size_t             vertex_count;
+    const sf::Texture* texture;
+};
+
+static bool failed = false;
+
+static const char* primitive_name(sf::PrimitiveType type) {
+    switch (type) {
+    case sf::Points: return "points";
+    case sf::Lines: return "lines";
+    case sf::LineStrip: return "line strip";
+    case sf::Triangles: return "triangles";
+    case sf::TriangleStrip: return "triangle strip";
+    case sf::TriangleFan: return "triangle fan";
+    default: return "quads";
+    }
+}
+
+/* Records one element and compares its commands with the draw calls SFML issues for it */
+static void check(const std::string& name, const grx::drawable_t& element, std::vector<expected_command> expected) {
+    recording_backend backend;
+    backend.draw(element, sf::RenderStates::Default);
+
+    auto& commands = backend.get_commands();
+    auto  ok       = commands.size() == expected.size();
+    for (size_t i = 0; ok && i < commands.size(); ++i)
+        ok = commands[i].primitive == expected[i].primitive && commands[i].vertex_count == expected[i].vertex_count &&
+             commands[i].texture == expected[i].texture;
+
+    size_t total = 0;
+    for (auto&& e : expected) total += e.vertex_count;
+    ok     = ok && backend.get_vertex_count() == total;
+    failed = failed || !ok;
+
+    std::cout << name;
+    for (auto&& c : commands) std::cout << " [" << primitive_name(c.primitive) << " " << c.vertex_count << "]";
+    if (!ok) {
+        std::cout << "  FAILED, expected";
+        for (auto&& e : expected) std::cout << " [" << primitive_name(e.primitive) << " " << e.vertex_count << "]";
+    }
+    std::cout << std::endl;
+}
+
+/*
+ * Checks that recording_backend records the draw calls SFML makes: a sprite is a strip of 4 vertices,
+ * a shape a fan of its points + 2 and, if outlined, an untextured strip of (points + 1) * 2,
+ * a text 6 vertices per visible character, vertex arrays as they are
+ * Exits with 1 on a mismatch
+ */
+int main() {
+    sf::Texture texture;
+
+    sf::Sprite sprite(texture);
+    check("sprite:            ", sprite, {{sf::TriangleStrip, 4, &texture}});
+
+    sf::RectangleShape rect({10.f, 20.f});
+    check("rectangle:         ", rect, {{sf::TriangleFan, 6, nullptr}});
+
+    rect.setTexture(&texture);
+    rect.setOutlineThickness(2.f);
+    check("outlined rectangle:", rect, {{sf::TriangleFan, 6, &texture}, {sf::TriangleStrip, 10, nullptr}});
+
+    sf::CircleShape circle(5.f, 12);
+    circle.setOutlineThickness(-1.f);
+    check("outlined circle:   ", circle, {{sf::TriangleFan, 14, nullptr}, {sf::TriangleStrip, 26, nullptr}});
+
+    sf::Text text;
+    text.setString("Hi there\n\tx ");
+    check("text:              ", text, {{sf::Triangles, 48, nullptr}});
+
+    recording_backend backend;
+    sf::Vertex        vertices[3];
+    backend.draw(vertices, 3, sf::Triangles, sf::RenderStates(&texture));
+    auto& commands = backend.get_commands();
+    auto  ok       = commands.size() == 1 && commands[0].primitive == sf::Triangles && commands[0].vertex_count == 3 &&
+             commands[0].texture == &texture && backend.get_vertices().size() == 3;
+    failed = failed || !ok;
+    std::cout << "vertex array:       " << (ok ? "ok" : "FAILED") << std::endl;
+
+    return failed ? 1 : 0;
+}
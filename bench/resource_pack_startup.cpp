@@ -0,0 +1,85 @@
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#include <SFML/Graphics/Image.hpp>
+
+#include "core/resource_pack.hpp"
+#include "grx/efx_library.hpp"
+
+namespace fs = std::filesystem;
+
+static nlohmann::json make_effect_json(size_t idx, const fs::path& texture_path) {
+    return {
+        {"name", "effect_" + std::to_string(idx)},
+        {"duration", 2.0},
+        {"animations", nlohmann::json::array()},
+        {"textures", {{"texture", {{"path", texture_path.string()}}}}},
+        {"templates", {{"sprite", {{"type", "sprite"}, {"texture", "texture"}}}}},
+        {"primitives", {{{"template", "sprite"}}}},
+    };
+}
+
+/* Returns milliseconds to list and build all effects with their textures, the pack is optional */
+static double load_all(const fs::path& effects_dir, const core::resource_pack* pack) {
+    auto start = std::chrono::steady_clock::now();
+
+    grx::texture_mgr tx_mgr;
+    tx_mgr.set_pack(pack);
+
+    grx::scene   scene;
+    grx::efx_mgr efx_mgr{scene};
+
+    grx::efx_editor::efx_library_loader loader(tx_mgr, 1);
+    loader.set_pack(pack);
+    loader.load(efx_mgr, grx::efx_editor::efx_library_loader::list_directory(effects_dir.string(), pack));
+
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/*
+ * 1000 small effects each with its own 32x32 texture, 2000 files in total,
+ * loaded from loose files and from one pack, both with warm page cache
+ */
+int main() {
+    constexpr size_t effects_count = 1000;
+
+    auto dir          = fs::temp_directory_path() / "fever_dream_resource_pack_startup";
+    auto effects_dir  = dir / "effects";
+    auto textures_dir = dir / "textures";
+    fs::remove_all(dir);
+    fs::create_directories(effects_dir);
+    fs::create_directories(textures_dir);
+
+    for (size_t i = 0; i < effects_count; ++i) {
+        auto texture_path = textures_dir / ("texture_" + std::to_string(i) + ".png");
+
+        sf::Image image;
+        image.create(32, 32, sf::Color(uint8_t(i), 128, 255 - uint8_t(i)));
+        image.saveToFile(texture_path.string());
+
+        std::ofstream(effects_dir / ("effect_" + std::to_string(i) + ".json")) << make_effect_json(i, texture_path);
+    }
+
+    core::resource_pack_writer writer;
+    for (auto&& entry : fs::recursive_directory_iterator(dir))
+        if (entry.is_regular_file())
+            writer.add_file(entry.path().string());
+    writer.save((dir / "resources.pack").string());
+
+    core::resource_pack pack((dir / "resources.pack").string());
+
+    /* Warm up the page cache for both */
+    load_all(effects_dir, nullptr);
+    load_all(effects_dir, &pack);
+
+    auto loose_ms = load_all(effects_dir, nullptr);
+    auto pack_ms  = load_all(effects_dir, &pack);
+
+    std::cout << "files:       " << pack.get_entries().size() << std::endl;
+    std::cout << "loose files: " << loose_ms << " ms" << std::endl;
+    std::cout << "pack:        " << pack_ms << " ms" << std::endl;
+
+    fs::remove_all(dir);
+}
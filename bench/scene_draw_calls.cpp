@@ -0,0 +1,93 @@
+#include <filesystem>
+#include <iostream>
+
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/Graphics/RenderTexture.hpp>
+
+#include "grx/efx_desc.hpp"
+
+namespace fs = std::filesystem;
+
+/* Effect with 6 sprites using two of its own 64x64 textures and one circle */
+static grx::efx_editor::efx_desc make_effect_desc(size_t idx, const fs::path& dir) {
+    using namespace grx::efx_editor;
+
+    efx_desc desc;
+    desc.name     = "effect_" + std::to_string(idx);
+    desc.duration = grx::duration_endless;
+
+    for (size_t i = 0; i < 2; ++i) {
+        auto texture_name = "texture" + std::to_string(i);
+        auto texture_path = dir / ("texture_" + std::to_string(idx) + "_" + std::to_string(i) + ".png");
+
+        sf::Image image;
+        image.create(64, 64, sf::Color(uint8_t(idx * 8), uint8_t(i * 128), 255));
+        image.saveToFile(texture_path.string());
+
+        desc.textures.push_back({texture_name, {texture_path.string()}});
+
+        efx_template_desc sprite;
+        sprite.name     = "sprite" + std::to_string(i);
+        sprite.type     = efx_template_type::sprite;
+        sprite.texture  = texture_name;
+        sprite.position = grx::vec2f{float(i) * 70.f, 0.f};
+        desc.templates.push_back(sprite);
+    }
+
+    efx_template_desc circle;
+    circle.name   = "circle";
+    circle.type   = efx_template_type::circle;
+    circle.radius = 10.f;
+    desc.templates.push_back(circle);
+
+    desc.primitives = {"sprite0", "sprite1", "sprite0", "sprite1", "sprite0", "sprite1", "circle"};
+    return desc;
+}
+
+/*
+ * 32 effect kinds with their own textures, 8 instances of each played in interleaved order
+ * Draw calls without batching, with sprite batching only and with batching over atlas pages
+ */
+int main() {
+    constexpr size_t kinds_count     = 32;
+    constexpr size_t instances_count = 8;
+
+    auto dir = fs::temp_directory_path() / "fever_dream_scene_draw_calls";
+    fs::create_directories(dir);
+
+    std::vector<grx::efx_editor::efx_desc> descs;
+    for (size_t i = 0; i < kinds_count; ++i) descs.push_back(make_effect_desc(i, dir));
+
+    sf::RenderTexture target;
+    target.create(1024, 1024);
+
+    auto count_draw_calls = [&](bool batching, bool atlas) {
+        grx::texture_mgr tx_mgr;
+        if (atlas)
+            tx_mgr.enable_atlas();
+
+        grx::scene scene;
+        scene.set_sprite_batching(batching);
+
+        grx::efx_mgr efx_mgr{scene};
+        for (auto&& desc : descs) {
+            auto [name, effect] = grx::efx_editor::efx_assembler(tx_mgr).assemble(desc);
+            efx_mgr.add_effect(name, std::move(effect));
+        }
+
+        for (size_t instance = 0; instance < instances_count; ++instance)
+            for (auto&& desc : descs)
+                efx_mgr.play(desc.name, 0, {float(instance) * 100.f, float(&desc - descs.data()) * 30.f});
+
+        efx_mgr.update(0.f);
+        scene.draw(target);
+        return scene.get_draw_calls();
+    };
+
+    std::cout << "elements: " << kinds_count * instances_count * 7 << std::endl;
+    std::cout << "no batching:       " << count_draw_calls(false, false) << " draw calls" << std::endl;
+    std::cout << "sprite batching:   " << count_draw_calls(true, false) << " draw calls" << std::endl;
+    std::cout << "batching + atlas:  " << count_draw_calls(true, true) << " draw calls" << std::endl;
+
+    fs::remove_all(dir);
+}
@@ -0,0 +1,101 @@
+#include <chrono>
+#include <iostream>
+
+#include "grx/skeleton.hpp"
+
+/*
+ * 500 characters with 24-bone skeletons, each frame every character samples two clips,
+ * blends them and flattens the pose to the world palette
+ */
+int main() {
+    constexpr size_t characters_count = 500;
+    constexpr size_t frames_count     = 600;
+    constexpr float  timestep         = 1.f / 60.f;
+    constexpr double frame_budget_ms  = 1000.0 / 60.0;
+
+    grx::skeleton skel;
+    auto          root = skel.add_bone("root", grx::skeleton::no_parent);
+    auto          hip  = skel.add_bone("hip", root, {0, -40});
+    auto          neck = skel.add_bone("neck", hip, {0, -60});
+    skel.add_bone("head", neck, {0, -20});
+    for (auto side : {"l", "r"}) {
+        auto dir      = side[0] == 'l' ? -1.f : 1.f;
+        auto shoulder = skel.add_bone(std::string("shoulder_") + side, neck, {dir * 15, 0});
+        auto arm      = skel.add_bone(std::string("arm_") + side, shoulder, {dir * 20, 0});
+        auto forearm  = skel.add_bone(std::string("forearm_") + side, arm, {dir * 20, 0});
+        auto hand     = skel.add_bone(std::string("hand_") + side, forearm, {dir * 15, 0});
+        skel.add_bone(std::string("fingers_") + side, hand, {dir * 5, 0});
+        auto thigh = skel.add_bone(std::string("thigh_") + side, hip, {dir * 10, 0});
+        auto shin  = skel.add_bone(std::string("shin_") + side, thigh, {0, 30});
+        auto foot  = skel.add_bone(std::string("foot_") + side, shin, {0, 30});
+        skel.add_bone(std::string("toes_") + side, foot, {dir * 8, 0});
+    }
+    while (skel.size() < 24)
+        skel.add_bone("extra_" + std::to_string(skel.size()), hip, {0, -10});
+
+    auto make_clip = [&](float duration, float amplitude) {
+        grx::skeleton_clip clip{skel.size(), duration};
+        for (grx::skeleton::index_t bone = 1; bone < skel.size(); ++bone) {
+            grx::anim_key_sequence<float> rotation;
+            rotation.push_linear_to_bezier(0, 0, {0.47, 1.64});
+            rotation.push_bezier(amplitude, duration * 0.5f, {0.41, 0.8}, {0.47, 1.64});
+            rotation.push_bezier_to_linear(0, duration, {0.41, 0.8});
+
+            grx::anim_key_sequence<core::vec2f> scale;
+            scale.push_linear({1, 1}, 0);
+            scale.push_linear({1.1f, 0.9f}, duration * 0.25f);
+            scale.push_linear({1, 1}, duration);
+
+            clip.get_track(bone).set_rotation(std::move(rotation));
+            clip.get_track(bone).set_scale(std::move(scale));
+        }
+        return clip;
+    };
+
+    auto walk = make_clip(1.f, 30.f);
+    auto run  = make_clip(0.6f, 55.f);
+
+    struct character {
+        float                 time;
+        float                 blend;
+        grx::skeleton_pose    walk_pose, run_pose, pose;
+        grx::skeleton_palette palette;
+    };
+
+    std::vector<character> characters(characters_count);
+    for (size_t i = 0; i < characters.size(); ++i) {
+        characters[i].time  = float(i) * 0.013f;
+        characters[i].blend = float(i % 100) / 100.f;
+    }
+
+    double total_ms = 0.0;
+    double worst_ms = 0.0;
+    float  checksum = 0.f;
+
+    for (size_t frame = 0; frame < frames_count; ++frame) {
+        auto start = std::chrono::steady_clock::now();
+
+        for (auto& c : characters) {
+            c.time += timestep;
+            walk.sample(skel, c.time, c.walk_pose);
+            run.sample(skel, c.time, c.run_pose);
+            grx::blend_poses(c.walk_pose, c.run_pose, c.blend, c.pose);
+            skel.calc_palette(c.pose, c.palette);
+        }
+
+        auto frame_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        total_ms += frame_ms;
+        worst_ms = std::max(worst_ms, frame_ms);
+
+        checksum += characters[frame % characters.size()].palette.back().tx;
+    }
+
+    auto avg_ms = total_ms / double(frames_count);
+    std::cout << "characters: " << characters_count << " bones: " << skel.size() << " frames: " << frames_count
+              << std::endl;
+    std::cout << "avg frame: " << avg_ms << " ms, worst frame: " << worst_ms << " ms, budget: " << frame_budget_ms
+              << " ms (" << (worst_ms < frame_budget_ms ? "ok" : "exceeded") << ")" << std::endl;
+    std::cout << "checksum: " << checksum << std::endl;
+
+    return worst_ms < frame_budget_ms ? 0 : 1;
+}
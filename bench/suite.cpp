@@ -0,0 +1,276 @@
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <vector>
+
+#include <SFML/Graphics/CircleShape.hpp>
+#include <SFML/Graphics/RectangleShape.hpp>
+
+#include "bench.hpp"
+#include "core/profiler.hpp"
+#include "core/vec_batch.hpp"
+#include "grx/efx.hpp"
+#include "grx/efx_editor.hpp"
+#include "grx/render_backend.hpp"
+#include "grx/scene.hpp"
+
+namespace fs = std::filesystem;
+using core::vec2f;
+
+static grx::anim_key_sequence<vec2f> make_keys(size_t count) {
+    grx::anim_key_sequence<vec2f> keys;
+    for (size_t i = 0; i < count; ++i) {
+        auto t = float(i) / float(count - 1);
+        keys.push_bezier(vec2f{600 * t, 400 * t * t}, t, {0.41f, 0.8f}, {0.47f, 1.64f});
+    }
+    return keys;
+}
+
+/* Effect of 8 shapes with position, scale and rotation keys applied to all of them */
+static grx::efx make_effect() {
+    grx::efx effect;
+    effect.set_duration(2.f);
+    for (size_t i = 0; i < 8; ++i) {
+        if (i % 2)
+            effect.create_element(sf::RectangleShape({20.f, 20.f}));
+        else
+            effect.create_element(sf::CircleShape(10.f));
+    }
+
+    grx::anim_key_sequence<float> rotation;
+    rotation.push_linear(0.f, 0.f);
+    rotation.push_linear(360.f, 1.f);
+
+    grx::anim_transform_track track;
+    track.set_position(make_keys(16));
+    track.set_scale(make_keys(4));
+    track.set_rotation(rotation);
+    effect.add_handler("transform", grx::efx_handlers::transform(track));
+    return effect;
+}
+
+static void bench_scene(bench::reporter& reporter) {
+    constexpr size_t batches_count = 1000;
+    constexpr size_t per_batch     = 8;
+
+    if (reporter.enabled("scene/create_delete")) {
+        grx::scene                    scene;
+        std::vector<grx::scene::id_t> ids(batches_count);
+        auto ns = bench::measure_ns(batches_count, 10, [&] {
+            for (auto&& id : ids) {
+                auto batch = scene.create_batch(0);
+                for (size_t i = 0; i < per_batch; ++i) batch->create_element<sf::CircleShape>(4.f);
+                id = batch.get_id();
+            }
+            for (auto id : ids) scene.delete_item(id);
+        });
+        reporter.add("scene/create_delete", ns, "ns/batch");
+    }
+
+    grx::scene scene;
+    for (size_t i = 0; i < batches_count; ++i) {
+        auto batch = scene.create_batch(grx::scene::layer_t(i % 4));
+        for (size_t j = 0; j < per_batch; ++j) {
+            sf::RectangleShape rect({8.f, 8.f});
+            rect.setPosition(float(j) * 10.f, float(i % 100) * 10.f);
+            batch->create_element<sf::RectangleShape>(rect);
+        }
+        batch->move({float(i / 100) * 100.f, 0.f});
+    }
+
+    if (!reporter.enabled("scene/draw"))
+        return;
+
+    /* Commands are recorded without vertices, so the cost is traversal and what a backend gets per call */
+    grx::recording_backend target({1920, 1080}, false);
+    reporter.measure("scene/draw", "ns/element", batches_count * per_batch, 10, [&] {
+        target.clear();
+        scene.draw(target);
+    });
+    reporter.add("scene/draw_calls", double(target.get_commands().size()), "calls");
+    reporter.add("scene/vertices", double(target.get_vertex_count()), "vertices");
+}
+
+static void bench_efx(bench::reporter& reporter) {
+    constexpr size_t instances_count = 500;
+    constexpr float  timestep        = 1.f / 60.f;
+
+    if (reporter.enabled("efx/play_update")) {
+        grx::scene   scene;
+        grx::efx_mgr mgr{scene};
+        auto         effect   = make_effect();
+        auto         duration = effect.get_duration();
+        mgr.add_effect("effect", std::move(effect));
+
+        /*
+         * Instances are spread over the effect duration, then each frame plays as many as finish in a frame,
+         * so instances_count stay alive. The time is divided by the average count measured over the run
+         */
+        for (size_t i = 0; i < instances_count; ++i) {
+            mgr.play("effect", 0, {float(i), 0.f});
+            mgr.update(duration / float(instances_count));
+        }
+
+        size_t frame          = 0;
+        size_t alive_total    = 0;
+        float  to_play        = 0.f;
+        auto   play_per_frame = float(instances_count) * timestep / duration;
+        auto   ns             = bench::measure_ns(1, 60, [&] {
+            for (to_play += play_per_frame; to_play >= 1.f; to_play -= 1.f)
+                mgr.play("effect", 0, {float(frame % 1000), 0.f});
+            mgr.update(timestep);
+            alive_total += mgr.get_instances_count();
+            ++frame;
+        });
+        reporter.add("efx/play_update", ns * double(frame) / double(alive_total), "ns/instance");
+    }
+
+    for (auto math : {grx::efx_math::exact, grx::efx_math::fast}) {
+        auto name = std::string("efx/gravity_") + (math == grx::efx_math::fast ? "fast" : "exact");
+        if (!reporter.enabled(name))
+            continue;
+
+        constexpr size_t bodies_count = 256;
+
+        grx::efx effect;
+        effect.set_duration(grx::duration_endless);
+        std::mt19937                          rng(1);
+        std::uniform_real_distribution<float> dist(0.f, 1000.f);
+        for (size_t i = 0; i < bodies_count; ++i) {
+            sf::CircleShape body{2.f};
+            body.setPosition(dist(rng), dist(rng));
+            effect.create_element(std::move(body));
+        }
+        effect.add_handler("gravity", grx::efx_handlers::gravity({}, {}, math));
+
+        grx::scene        scene;
+        grx::efx_instance instance(scene, 0, effect);
+        reporter.measure(name, "ns/body", bodies_count, 20, [&] { instance.update(timestep); });
+    }
+}
+
+static void bench_keyframes(bench::reporter& reporter) {
+    constexpr size_t samples_count = 4096;
+
+    auto keys = make_keys(16);
+
+    grx::anim_transform_track track;
+    track.set_position(keys);
+    track.set_scale(make_keys(4));
+
+    std::vector<float> times(samples_count);
+    for (size_t i = 0; i < samples_count; ++i) times[i] = float(i + 1) / float(samples_count);
+
+    std::vector<vec2f> out(samples_count);
+    reporter.measure("keyframes/lookup", "ns/sample", samples_count, 100, [&] {
+        for (size_t i = 0; i < samples_count; ++i) out[i] = keys.lookup(times[i]);
+    });
+    reporter.measure("keyframes/transform_track", "ns/sample", samples_count, 100, [&] {
+        for (size_t i = 0; i < samples_count; ++i) out[i] = *track.lookup(times[i]).position;
+    });
+}
+
+/* Effects of shapes only, so nothing needs a GL context */
+static nlohmann::json make_effect_json() {
+    using nlohmann::json;
+
+    auto keys = json::array();
+    for (size_t i = 0; i < 16; ++i) {
+        auto t = float(i) / 15.f;
+        keys.push_back({{"time", t}, {"value", {600 * t, 400 * t}}, {"in", {0.41, 0.8}}, {"out", {0.47, 1.64}}});
+    }
+
+    auto templates      = json::object();
+    templates["square"] = {{"type", "rect"}, {"fill_color", "#ff00ffff"}, {"size", {100, 100}}};
+    templates["circle"] = {{"type", "circle"}, {"fill_color", "#ffff00ff"}, {"radius", 20}};
+
+    auto primitives = json::array();
+    for (size_t i = 0; i < 8; ++i) primitives.push_back({{"template", i % 2 ? "square" : "circle"}});
+
+    return {
+        {"name", "effect"},
+        {"duration", 2.0},
+        {"animations", {{{"name", "position0"}, {"type", "position"}, {"apply_to", "all"}, {"keys", keys}}}},
+        {"templates", templates},
+        {"primitives", primitives},
+    };
+}
+
+static void bench_efx_builder(bench::reporter& reporter) {
+    if (!reporter.enabled("efx_builder/load"))
+        return;
+
+    auto dir = fs::temp_directory_path() / "fever_dream_bench_suite";
+    fs::create_directories(dir);
+    auto path = dir / "effect.json";
+    std::ofstream(path) << make_effect_json().dump();
+
+    grx::texture_mgr tx_mgr;
+    size_t           elements = 0;
+    auto             ns       = bench::measure_ns(1, 200, [&] {
+        auto [name, effect] = grx::efx_editor::efx_builder(tx_mgr, path.string()).build();
+        elements += effect.get_elements().size();
+    });
+    reporter.add("efx_builder/load", ns / 1000., "us/effect");
+
+    fs::remove_all(dir);
+}
+
+static void bench_vec(bench::reporter& reporter) {
+    constexpr size_t vectors_count = 4096;
+
+    std::mt19937                          rng(1);
+    std::uniform_real_distribution<float> dist(-100.f, 100.f);
+    std::vector<vec2f>                    a(vectors_count), b(vectors_count), out(vectors_count);
+    std::vector<float>                    dots(vectors_count);
+    for (size_t i = 0; i < vectors_count; ++i) {
+        a[i] = vec2f{dist(rng), dist(rng)};
+        b[i] = vec2f{dist(rng), dist(rng)};
+    }
+
+    reporter.measure("vec/add", "ns/vector", vectors_count, 1000, [&] {
+        for (size_t i = 0; i < vectors_count; ++i) out[i] = a[i] + b[i];
+    });
+    reporter.measure("vec/normalize", "ns/vector", vectors_count, 1000, [&] {
+        for (size_t i = 0; i < vectors_count; ++i) out[i] = a[i].normalize();
+    });
+    reporter.measure(
+        "vec/batch_normalize", "ns/vector", vectors_count, 1000, [&] { core::batch_normalize<2>(a, out); });
+    reporter.measure("vec/batch_dot", "ns/vector", vectors_count, 1000, [&] { core::batch_dot<2>(a, b, dots); });
+}
+
+/* Cost of a zone outside and during a capture, the capture spans the whole measurement */
+static void bench_profiler(bench::reporter& reporter) {
+    constexpr size_t zones_count = 1024;
+
+    auto& profiler = core::profiler::instance();
+    auto  zone     = profiler.intern("bench/zone");
+    auto  zones    = [&] {
+        for (size_t i = 0; i < zones_count; ++i) core::profile_zone profile{zone};
+    };
+
+    reporter.measure("profiler/zone_idle", "ns/zone", zones_count, 1000, zones);
+
+    profiler.request_capture();
+    profiler.frame();
+    reporter.measure("profiler/zone_capturing", "ns/zone", zones_count, 100, zones);
+    profiler.frame();
+    profiler.take_finished_capture();
+}
+
+/*
+ * Headless benchmark suite of scene, efx, keyframes, effect loading, vec operations and profiler zones
+ * Usage: bench_suite [--json <path>] [--filter <substring>], see bench::reporter
+ */
+int main(int argc, char** argv) {
+    bench::reporter reporter("suite", argc, argv);
+
+    bench_scene(reporter);
+    bench_efx(reporter);
+    bench_keyframes(reporter);
+    bench_efx_builder(reporter);
+    bench_vec(reporter);
+    bench_profiler(reporter);
+
+    return reporter.finish();
+}
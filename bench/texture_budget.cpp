@@ -0,0 +1,74 @@
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <limits>
+
+#include <SFML/Graphics/Image.hpp>
+
+#include "grx/texture_mgr.hpp"
+
+namespace fs = std::filesystem;
+
+/*
+ * Level streaming under a memory budget: every level holds handles to 24 of 96 textures of 1 MiB,
+ * neighbouring levels share half of them, the walk goes through the levels twice
+ * Prints resident size, hits, misses and evictions per level with and without the budget
+ */
+static void run(const std::vector<std::string>& paths, uint64_t budget) {
+    constexpr size_t levels_count       = 8;
+    constexpr size_t textures_per_level = 24;
+
+    grx::texture_mgr tx_mgr;
+    tx_mgr.set_memory_budget(budget);
+
+    std::cout << "budget: ";
+    if (budget == std::numeric_limits<uint64_t>::max())
+        std::cout << "unlimited" << std::endl;
+    else
+        std::cout << budget / (1 << 20) << " MiB" << std::endl;
+    std::cout << "level,load_ms,resident_mib,hits,misses,evictions" << std::endl;
+
+    std::vector<grx::texture_handle> level_handles;
+    for (size_t step = 0; step < levels_count * 2; ++step) {
+        auto level = step % levels_count;
+        auto first = level * textures_per_level / 2;
+
+        auto start = std::chrono::steady_clock::now();
+
+        std::vector<grx::texture_handle> handles;
+        for (size_t i = 0; i < textures_per_level; ++i)
+            handles.push_back(tx_mgr.acquire(paths[(first + i) % paths.size()]));
+
+        auto load_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        /* The previous level is released after the next one is loaded, as a loading screen would do */
+        level_handles = std::move(handles);
+        tx_mgr.trim();
+
+        auto stats = tx_mgr.get_stats();
+        std::cout << level << "," << load_ms << "," << stats.resident_bytes / (1 << 20) << "," << stats.hits << ","
+                  << stats.misses << "," << stats.evictions << std::endl;
+    }
+}
+
+int main() {
+    constexpr size_t textures_count = 96;
+
+    auto dir = fs::temp_directory_path() / "fever_dream_texture_budget";
+    fs::create_directories(dir);
+
+    std::vector<std::string> paths;
+    for (size_t i = 0; i < textures_count; ++i) {
+        paths.push_back((dir / ("texture_" + std::to_string(i) + ".png")).string());
+
+        sf::Image image;
+        image.create(512, 512, sf::Color(uint8_t(i), 128, 255 - uint8_t(i)));
+        image.saveToFile(paths.back());
+    }
+
+    run(paths, std::numeric_limits<uint64_t>::max());
+    std::cout << std::endl;
+    run(paths, uint64_t(64) << 20);
+
+    fs::remove_all(dir);
+}
@@ -0,0 +1,58 @@
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+
+#include <SFML/Graphics/Image.hpp>
+
+#include "grx/texture_mgr.hpp"
+
+namespace fs = std::filesystem;
+
+/* Returns milliseconds to load all textures, the cache is optional */
+static double load_all(const std::vector<std::string>& paths, core::disk_cache* cache) {
+    grx::texture_mgr tx_mgr;
+    tx_mgr.set_cache(cache);
+
+    auto start = std::chrono::steady_clock::now();
+    for (auto&& path : paths) tx_mgr.load(path);
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/*
+ * Loads 500 textures of 256x256: decoded from image files, decoded and stored into empty cache,
+ * then mapped from the filled cache
+ */
+int main() {
+    constexpr size_t textures_count = 500;
+
+    auto dir       = fs::temp_directory_path() / "fever_dream_texture_cache_startup";
+    auto cache_dir = dir / "cache";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+
+    std::vector<std::string> paths;
+    for (size_t i = 0; i < textures_count; ++i) {
+        paths.push_back((dir / ("texture_" + std::to_string(i) + ".png")).string());
+
+        sf::Image image;
+        image.create(256, 256, sf::Color(uint8_t(i), 128, 255 - uint8_t(i)));
+        for (unsigned y = 0; y < 256; ++y)
+            for (unsigned x = 0; x < 256; ++x)
+                if ((x ^ y) & 8)
+                    image.setPixel(x, y, sf::Color(uint8_t(x), uint8_t(y), uint8_t(i)));
+        image.saveToFile(paths.back());
+    }
+
+    core::disk_cache cache(cache_dir.string(), uint64_t(1) << 30);
+
+    auto decode_ms = load_all(paths, nullptr);
+    auto cold_ms   = load_all(paths, &cache);
+    auto warm_ms   = load_all(paths, &cache);
+
+    std::cout << "textures: " << textures_count << std::endl;
+    std::cout << "decode:     " << decode_ms << " ms" << std::endl;
+    std::cout << "cold cache: " << cold_ms << " ms" << std::endl;
+    std::cout << "warm cache: " << warm_ms << " ms (" << cache.get_size() / (1 << 20) << " MiB cached)" << std::endl;
+
+    fs::remove_all(dir);
+}
@@ -0,0 +1,89 @@
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <thread>
+
+#include <SFML/Graphics/Image.hpp>
+
+#include "grx/texture_mgr.hpp"
+
+namespace fs = std::filesystem;
+
+using bench_clock = std::chrono::steady_clock;
+
+static double elapsed_ms(bench_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(bench_clock::now() - start).count();
+}
+
+/*
+ * Streams 200 textures in, 10 new requests per frame, and prints frame time trace
+ * for synchronous loading and for load_async + upload under the default budget
+ */
+int main() {
+    constexpr size_t textures_count     = 200;
+    constexpr size_t requests_per_frame = 10;
+
+    auto dir = fs::temp_directory_path() / "fever_dream_texture_streaming";
+    fs::create_directories(dir);
+
+    std::vector<std::string> paths;
+    for (size_t i = 0; i < textures_count; ++i) {
+        paths.push_back((dir / ("texture_" + std::to_string(i) + ".png")).string());
+
+        sf::Image image;
+        image.create(512, 512, sf::Color(uint8_t(i), 128, 255 - uint8_t(i)));
+        image.saveToFile(paths.back());
+    }
+
+    std::vector<double> sync_frames;
+    {
+        grx::texture_mgr tx_mgr;
+        for (size_t first = 0; first < textures_count; first += requests_per_frame) {
+            auto start = bench_clock::now();
+            for (size_t i = first; i < std::min(first + requests_per_frame, textures_count); ++i) tx_mgr.load(paths[i]);
+            sync_frames.push_back(elapsed_ms(start));
+        }
+    }
+
+    std::vector<double> async_frames;
+    std::vector<size_t> async_pending;
+    {
+        grx::texture_mgr                 tx_mgr(4);
+        std::vector<grx::texture_handle> handles;
+
+        for (size_t frame = 0; handles.size() < textures_count || tx_mgr.get_pending_count() > 0; ++frame) {
+            auto start = bench_clock::now();
+
+            for (size_t i = 0; i < requests_per_frame && handles.size() < textures_count; ++i)
+                handles.push_back(tx_mgr.load_async(paths[handles.size()]));
+            tx_mgr.upload();
+
+            async_frames.push_back(elapsed_ms(start));
+            async_pending.push_back(tx_mgr.get_pending_count());
+
+            /* Rest of the 60 fps frame */
+            std::this_thread::sleep_until(start + std::chrono::microseconds(16667));
+        }
+
+        if (!std::all_of(handles.begin(), handles.end(), [](auto&& handle) { return handle.is_ready(); }))
+            std::cout << "not all textures are ready" << std::endl;
+    }
+
+    std::cout << "frame,sync_ms,async_ms,async_pending" << std::endl;
+    for (size_t frame = 0; frame < std::max(sync_frames.size(), async_frames.size()); ++frame) {
+        std::cout << frame << ",";
+        if (frame < sync_frames.size())
+            std::cout << sync_frames[frame];
+        std::cout << ",";
+        if (frame < async_frames.size())
+            std::cout << async_frames[frame] << "," << async_pending[frame];
+        std::cout << std::endl;
+    }
+
+    std::cout << "max sync frame:  " << *std::max_element(sync_frames.begin(), sync_frames.end()) << " ms" << std::endl;
+    std::cout << "max async frame: " << *std::max_element(async_frames.begin(), async_frames.end()) << " ms"
+              << std::endl;
+
+    fs::remove_all(dir);
+}
@@ -0,0 +1,110 @@
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <set>
+#include <thread>
+
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/Graphics/RenderTexture.hpp>
+#include <SFML/Graphics/Sprite.hpp>
+
+#include "grx/scene.hpp"
+#include "grx/texture_mgr.hpp"
+
+namespace fs = std::filesystem;
+
+using bench_clock = std::chrono::steady_clock;
+
+static double elapsed_ms(bench_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(bench_clock::now() - start).count();
+}
+
+/*
+ * 32 textures of 1024x1024 with 3 variants drawn as sprites at scale 0.2
+ * Prints how long the variants take to appear while the render thread only uploads,
+ * the size of textures sampled by a frame and the CPU cost of variant selection in scene::draw
+ */
+int main() {
+    constexpr size_t textures_count = 32;
+    constexpr float  sprite_scale   = 0.2f;
+
+    auto dir = fs::temp_directory_path() / "fever_dream_texture_variants";
+    fs::create_directories(dir);
+
+    std::vector<std::string> paths;
+    for (size_t i = 0; i < textures_count; ++i) {
+        paths.push_back((dir / ("texture_" + std::to_string(i) + ".png")).string());
+
+        sf::Image image;
+        image.create(1024, 1024, sf::Color(uint8_t(i * 8), 128, 255 - uint8_t(i * 8)));
+        image.saveToFile(paths.back());
+    }
+
+    grx::texture_mgr                 tx_mgr(4);
+    std::vector<grx::texture_handle> handles;
+    for (auto&& path : paths) handles.push_back(tx_mgr.acquire(grx::texture_def{path, true, false, false, false, 3}));
+
+    /* Variants are decoded in background, the render thread only uploads them */
+    auto   start     = bench_clock::now();
+    double max_frame = 0.;
+    while (true) {
+        auto frame_start = bench_clock::now();
+        tx_mgr.upload();
+        max_frame = std::max(max_frame, elapsed_ms(frame_start));
+
+        auto ready = std::all_of(handles.begin(), handles.end(), [&](auto&& handle) {
+            return tx_mgr.get_variants().select(&handle.get(), sprite_scale).texture != &handle.get();
+        });
+        if (ready)
+            break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    auto variants_ms = elapsed_ms(start);
+
+    std::vector<grx::drawable_t> sprites;
+    for (size_t i = 0; i < 256; ++i) {
+        sf::Sprite sprite(handles[i % textures_count].get());
+        sprite.setScale(sprite_scale, sprite_scale);
+        sprite.setPosition(float(i % 16) * 80.f, float(i / 16) * 45.f);
+        sprites.emplace_back(sprite);
+    }
+
+    grx::scene scene;
+    scene.create_batch(0, sprites);
+
+    /* Texture bytes sampled by one frame, each distinct texture counted once */
+    auto sampled_bytes = [&](const grx::texture_variants* variants) {
+        std::set<const sf::Texture*> used;
+        for (auto&& handle : handles)
+            used.insert(variants ? variants->select(&handle.get(), sprite_scale).texture : &handle.get());
+
+        uint64_t bytes = 0;
+        for (auto texture : used) bytes += uint64_t(texture->getSize().x) * texture->getSize().y * 4;
+        return bytes;
+    };
+
+    sf::RenderTexture target;
+    target.create(1280, 720);
+
+    auto draw_ms = [&](const grx::texture_variants* variants) {
+        scene.set_texture_variants(variants);
+        scene.set_sprite_batching(true);
+
+        constexpr size_t frames     = 200;
+        auto             draw_start = bench_clock::now();
+        for (size_t frame = 0; frame < frames; ++frame) scene.draw(target);
+        return elapsed_ms(draw_start) / frames;
+    };
+
+    auto stats = tx_mgr.get_stats();
+    std::cout << "variants ready after:     " << variants_ms << " ms (max upload frame " << max_frame << " ms)"
+              << std::endl;
+    std::cout << "resident with variants:   " << stats.resident_bytes / (1 << 20) << " MiB" << std::endl;
+    std::cout << "sampled without variants: " << sampled_bytes(nullptr) / (1 << 20) << " MiB" << std::endl;
+    std::cout << "sampled with variants:    " << sampled_bytes(&tx_mgr.get_variants()) / 1024 << " KiB" << std::endl;
+    std::cout << "draw without variants:    " << draw_ms(nullptr) << " ms" << std::endl;
+    std::cout << "draw with variants:       " << draw_ms(&tx_mgr.get_variants()) << " ms" << std::endl;
+
+    fs::remove_all(dir);
+}
@@ -0,0 +1,109 @@
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <SFML/Graphics/CircleShape.hpp>
+
+#include "core/vec2_soa.hpp"
+#include "grx/efx.hpp"
+
+using bench_clock = std::chrono::steady_clock;
+
+static double elapsed_ms(bench_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(bench_clock::now() - start).count();
+}
+
+/* The gravity handler before positions were gathered into vec2_soa */
+static auto gravity_per_element(const std::vector<float>& masses) {
+    return [masses = masses, velocities = std::vector<core::vec2f>{}](sf::Transformable&    obj,
+                                                                      const grx::efx_state& state) mutable {
+        auto  idx    = state.idx;
+        auto& bodies = state.batch->get_elements();
+        if (bodies.size() > velocities.size())
+            velocities.resize(bodies.size(), {0, 0});
+
+        core::vec2f accel{0, 0};
+        for (size_t i = 0; i < bodies.size(); ++i) {
+            if (i == idx)
+                continue;
+            auto pos = std::visit([](auto&& body) { return body.getPosition(); }, bodies[i]);
+            auto dir = core::vec2f(pos - obj.getPosition()).normalize();
+            accel += dir * masses[i];
+        }
+
+        auto& velocity = velocities[idx];
+        velocity += accel * state.timestep;
+        obj.move(velocity * state.timestep);
+    };
+}
+
+/* Milliseconds per update of an effect with the handler */
+template <typename F>
+static double gravity_ms(size_t bodies_count, F&& handler) {
+    grx::scene scene;
+    grx::efx   effect;
+    effect.set_duration(grx::duration_endless);
+    for (size_t i = 0; i < bodies_count; ++i) {
+        sf::CircleShape body{4};
+        body.setPosition(float(i % 32) * 24.f, float(i / 32) * 24.f);
+        effect.get_elements().push_back(body);
+    }
+    effect.add_handler("gravity", std::forward<F>(handler));
+
+    grx::efx_instance instance(scene, 0, effect);
+    instance.update(0.016f);
+
+    constexpr size_t updates = 20;
+    auto             start   = bench_clock::now();
+    for (size_t i = 0; i < updates; ++i) instance.update(0.016f);
+    return elapsed_ms(start) / updates;
+}
+
+/*
+ * Explicit integration of 65536 particles stored as vec2f array and as vec2_soa,
+ * then the gravity handler on 1024 bodies with per-element lookups, with gathered positions and with fast math
+ */
+int main() {
+    constexpr size_t particles_count = 1 << 16;
+    constexpr size_t steps           = 500;
+    constexpr float  timestep        = 0.016f;
+
+    std::mt19937                          rng(1);
+    std::uniform_real_distribution<float> dist(-100.f, 100.f);
+
+    std::vector<core::vec2f> positions(particles_count), velocities(particles_count);
+    for (size_t i = 0; i < particles_count; ++i) {
+        positions[i]  = core::vec2f{dist(rng), dist(rng)};
+        velocities[i] = core::vec2f{dist(rng), dist(rng)};
+    }
+
+    core::vec2f_soa soa_positions(positions), soa_velocities(velocities);
+
+    auto start = bench_clock::now();
+    for (size_t step = 0; step < steps; ++step)
+        for (size_t i = 0; i < particles_count; ++i) positions[i] += velocities[i] * timestep;
+    auto aos_ms = elapsed_ms(start) / steps;
+
+    start = bench_clock::now();
+    for (size_t step = 0; step < steps; ++step) soa_positions.add_scaled(soa_velocities, timestep);
+    auto soa_ms = elapsed_ms(start) / steps;
+
+    float difference = 0.f;
+    for (size_t i = 0; i < particles_count; ++i)
+        difference = std::max(difference, (positions[i] - soa_positions[i].get()).magnitude());
+
+    constexpr size_t bodies_count = 1024;
+
+    std::vector<float> masses(bodies_count, 0.1f);
+
+    auto per_element_ms = gravity_ms(bodies_count, gravity_per_element(masses));
+    auto gathered_ms    = gravity_ms(bodies_count, grx::efx_handlers::gravity(masses));
+    auto fast_ms        = gravity_ms(bodies_count, grx::efx_handlers::gravity(masses, {}, grx::efx_math::fast));
+
+    std::cout << "integrate vec2f array: " << aos_ms << " ms" << std::endl;
+    std::cout << "integrate vec2_soa:    " << soa_ms << " ms (max difference " << difference << ")" << std::endl;
+    std::cout << "gravity per element:   " << per_element_ms << " ms/update" << std::endl;
+    std::cout << "gravity gathered:      " << gathered_ms << " ms/update" << std::endl;
+    std::cout << "gravity fast math:     " << fast_ms << " ms/update" << std::endl;
+}
@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "core/vec_batch.hpp"
+
+using core::vec2f;
+using core::vec4f;
+
+static constexpr size_t vectors_count = 4096;
+static constexpr size_t repeats       = 2000;
+
+/* Nanoseconds per vector */
+template <typename F>
+static double measure(F&& function) {
+    function();
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < repeats; ++i) function();
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+           double(repeats * vectors_count);
+}
+
+template <typename T>
+static float max_difference(const std::vector<T>& a, const std::vector<T>& b) {
+    float difference = 0.f;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if constexpr (std::is_same_v<T, float>)
+            difference = std::max(difference, std::abs(a[i] - b[i]));
+        else
+            for (size_t j = 0; j < T::size(); ++j) difference = std::max(difference, std::abs(a[i].v[j] - b[i].v[j]));
+    }
+    return difference;
+}
+
+static void report(const std::string& name, double scalar_ns, double simd_ns, float difference) {
+    std::cout << name << scalar_ns << " -> " << simd_ns << " ns/vector, x" << scalar_ns / simd_ns
+              << ", max difference " << difference << std::endl;
+}
+
+/* The scalar code vec used before the SSE kernels */
+template <size_t S>
+static core::vec<float, S> scalar_normalize(const core::vec<float, S>& v) {
+    auto magnitude = sqrtf(v.magnitude_2());
+    return v / magnitude;
+}
+
+/*
+ * 4096 vectors processed 2000 times, per-vector operators and scalar loops against the span operations
+ * Results of both are compared, the only expected difference is the summation order of vec4 dot products
+ */
+int main() {
+    std::mt19937                          rng(1);
+    std::uniform_real_distribution<float> dist(-100.f, 100.f);
+
+    std::vector<vec2f> a2(vectors_count), b2(vectors_count), scalar2(vectors_count), simd2(vectors_count);
+    std::vector<vec4f> a4(vectors_count), b4(vectors_count), scalar4(vectors_count), simd4(vectors_count);
+    std::vector<float> scalar_dots(vectors_count), simd_dots(vectors_count);
+    for (size_t i = 0; i < vectors_count; ++i) {
+        a2[i] = vec2f{dist(rng), dist(rng)};
+        b2[i] = vec2f{dist(rng), dist(rng)};
+        a4[i] = vec4f{dist(rng), dist(rng), dist(rng), dist(rng)};
+        b4[i] = vec4f{dist(rng), dist(rng), dist(rng), dist(rng)};
+    }
+
+    constexpr float t     = 0.3f;
+    constexpr float angle = 0.7f;
+
+    auto add_scalar = measure([&] {
+        for (size_t i = 0; i < vectors_count; ++i) scalar2[i] = a2[i] + b2[i];
+    });
+    auto add_simd = measure([&] { core::batch_add<2>(a2, b2, simd2); });
+    report("vec2f add:             ", add_scalar, add_simd, max_difference(scalar2, simd2));
+
+    auto scale_scalar = measure([&] {
+        for (size_t i = 0; i < vectors_count; ++i) scalar2[i] = a2[i] * 1.5f;
+    });
+    auto scale_simd = measure([&] { core::batch_scale<2>(a2, 1.5f, simd2); });
+    report("vec2f scale:           ", scale_scalar, scale_simd, max_difference(scalar2, simd2));
+
+    auto lerp_scalar = measure([&] {
+        for (size_t i = 0; i < vectors_count; ++i) scalar2[i] = a2[i] * (1.f - t) + b2[i] * t;
+    });
+    auto lerp_simd = measure([&] { core::batch_lerp<2>(a2, b2, t, simd2); });
+    report("vec2f lerp:            ", lerp_scalar, lerp_simd, max_difference(scalar2, simd2));
+
+    auto dot2_scalar = measure([&] {
+        for (size_t i = 0; i < vectors_count; ++i) scalar_dots[i] = a2[i].dot(b2[i]);
+    });
+    auto dot2_simd = measure([&] { core::batch_dot<2>(a2, b2, simd_dots); });
+    report("vec2f dot:             ", dot2_scalar, dot2_simd, max_difference(scalar_dots, simd_dots));
+
+    auto dot4_scalar = measure([&] {
+        for (size_t i = 0; i < vectors_count; ++i) scalar_dots[i] = a4[i].dot(b4[i]);
+    });
+    auto dot4_simd = measure([&] { core::batch_dot<4>(a4, b4, simd_dots); });
+    report("vec4f dot:             ", dot4_scalar, dot4_simd, max_difference(scalar_dots, simd_dots));
+
+    auto rotate_scalar = measure([&] {
+        auto cos = std::cos(angle);
+        auto sin = std::sin(angle);
+        for (size_t i = 0; i < vectors_count; ++i)
+            scalar2[i] = vec2f{a2[i].x() * cos - a2[i].y() * sin, a2[i].x() * sin + a2[i].y() * cos};
+    });
+    auto rotate_simd = measure([&] { core::batch_rotate(a2, angle, simd2); });
+    report("vec2f rotate:          ", rotate_scalar, rotate_simd, max_difference(scalar2, simd2));
+
+    auto normalize2_scalar = measure([&] {
+        for (size_t i = 0; i < vectors_count; ++i) scalar2[i] = scalar_normalize(a2[i]);
+    });
+    auto normalize2_vec = measure([&] {
+        for (size_t i = 0; i < vectors_count; ++i) simd2[i] = a2[i].normalize();
+    });
+    report("vec2f normalize:       ", normalize2_scalar, normalize2_vec, max_difference(scalar2, simd2));
+
+    auto normalize2_simd = measure([&] { core::batch_normalize<2>(a2, simd2); });
+    report("vec2f batch normalize: ", normalize2_scalar, normalize2_simd, max_difference(scalar2, simd2));
+
+    auto normalize4_scalar = measure([&] {
+        for (size_t i = 0; i < vectors_count; ++i) scalar4[i] = scalar_normalize(a4[i]);
+    });
+    auto normalize4_vec = measure([&] {
+        for (size_t i = 0; i < vectors_count; ++i) simd4[i] = a4[i].normalize();
+    });
+    report("vec4f normalize:       ", normalize4_scalar, normalize4_vec, max_difference(scalar4, simd4));
+
+    auto normalize4_simd = measure([&] { core::batch_normalize<4>(a4, simd4); });
+    report("vec4f batch normalize: ", normalize4_scalar, normalize4_simd, max_difference(scalar4, simd4));
+}
@@ -1,11 +1,15 @@
 #include <iostream>
 
+#include <imgui-SFML.h>
+
 #include <SFML/Window/Event.hpp>
 #include <SFML/Graphics/RenderWindow.hpp>
 #include <SFML/OpenGL.hpp>
 
+#include "core/profiler.hpp"
 #include "grx/scene.hpp"
-#include "grx/efx_editor.hpp"
+#include "grx/efx_hot_reload.hpp"
+#include "grx/ui/perf_overlay.hpp"
 
 
 int main() {
@@ -18,48 +22,68 @@ int main() {
     };
     wnd.setActive();
     wnd.setVerticalSyncEnabled(false);
+    ImGui::SFML::Init(wnd);
 
     grx::scene scene;
     grx::efx_mgr efx_mgr{scene};
     grx::texture_mgr tx_mgr;
 
-    grx::efx_editor::efx_builder efx_builder(tx_mgr, "examples/efx/test_effect.json");
-    auto [efx_name, efx] = efx_builder.build();
-
-    efx_mgr.add_effect(efx_name, std::move(efx));
+    grx::efx_editor::efx_hot_reloader efx_reloader(tx_mgr, efx_mgr);
+    auto efx_name = efx_reloader.watch("examples/efx/test_effect.json");
 
     sf::Clock clock;
     bool      running = true;
 
-    size_t    frames = 0;
-    sf::Clock fps_clock;
+    auto&            profiler = core::profiler::instance();
+    ui::perf_overlay overlay;
 
     while (running) {
+        profiler.frame();
+        if (profiler.take_finished_capture() && profiler.save_chrome_trace("frame_capture.json"))
+            std::cout << "frame captured to frame_capture.json" << std::endl;
+
         auto timestep = clock.getElapsedTime();
         clock.restart();
+        overlay.add_frame(timestep.asSeconds());
 
         sf::Event event;
         while (wnd.pollEvent(event)) {
+            ImGui::SFML::ProcessEvent(wnd, event);
+
             if (event.type == sf::Event::Closed)
                 running = false;
-            if (event.type == sf::Event::MouseButtonPressed) {
+            if (event.type == sf::Event::MouseButtonPressed && !ImGui::GetIO().WantCaptureMouse) {
                 auto pos = sf::Mouse::getPosition(wnd);
                 efx_mgr.play(efx_name, 0, {float(pos.x), float(pos.y)});
             }
+            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F12)
+                profiler.request_capture();
+            if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::F3)
+                overlay.toggle();
         }
 
-        if (frames % 100 == 0) {
-            std::cout << "objects: " << scene.get_elements_count()
-                      << " fps: " << double(frames) / fps_clock.getElapsedTime().asSeconds() << std::endl;
-            frames = 0;
-            fps_clock.restart();
+        ImGui::SFML::Update(wnd, timestep);
+
+        {
+            auto timer = overlay.measure("hot reload");
+            for (auto&& error : efx_reloader.update().errors) std::cerr << error << std::endl;
         }
-        ++frames;
 
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        efx_mgr.update(timestep.asSeconds());
-        scene.draw(wnd);
+        {
+            auto timer = overlay.measure("efx update");
+            efx_mgr.update(timestep.asSeconds());
+        }
+        {
+            auto timer = overlay.measure("scene draw");
+            scene.draw(wnd);
+        }
+
+        overlay.show(scene, efx_mgr, &tx_mgr);
+        ImGui::SFML::Render(wnd);
         wnd.display();
     }
+
+    ImGui::SFML::Shutdown();
 }
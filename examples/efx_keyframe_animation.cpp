@@ -41,9 +41,12 @@ int main() {
     position_keys.push_bezier({600, 400}, 0.5, {0.41, 0.8}, {0.47, 1.64});
     position_keys.push_bezier_to_linear({600, 200}, 1, {0.41, 0.8});
 
-    effect.add_handler("scale", grx::efx_handlers::scale(scale_keys));
-    effect.add_handler("rotation", grx::efx_handlers::rotation(rotation_keys));
-    effect.add_handler("position", grx::efx_handlers::position(position_keys));
+    grx::anim_transform_track transform_track;
+    transform_track.set_rotation(rotation_keys);
+    transform_track.set_scale(scale_keys);
+    transform_track.set_position(position_keys);
+
+    effect.add_handler("transform", grx::efx_handlers::transform(transform_track));
     efx_mgr.add_effect("square", std::move(effect));
 
     sf::Clock clock;
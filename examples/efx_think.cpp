@@ -25,6 +25,7 @@ int main() {
     sf::Texture texture;
     texture.loadFromFile("resources/test/think.png");
     texture.setSmooth(true);
+    texture.generateMipmap(); /* Played at half scale */
 
     grx::efx effect;
     effect.set_duration(2);
@@ -36,8 +37,8 @@ int main() {
         constexpr auto pi2   = M_PIf32 * 2;
         auto           angle = float(i) / 12 * pi2;
 
-        auto x = std::cos(angle);
-        auto y = std::sin(angle);
+        float x, y;
+        core::fastmath::sincos(angle, y, x);
 
         velocities.push_back(core::vec2f{-y, x} * 600.f);
         masses.push_back(1.f);
@@ -56,7 +57,7 @@ int main() {
     velocities.push_back({0.f, 0.f});
     masses.push_back(1000.f);
 
-    effect.add_handler("gravity", grx::efx_handlers::gravity(masses, velocities));
+    effect.add_handler("gravity", grx::efx_handlers::gravity(masses, velocities, grx::efx_math::fast));
     effect.add_handler("opacity", [](sf::Shape& shape, const grx::efx_state& state) {
         constexpr auto threshold = 0.4f;
         auto           opacity   = 1.f;
@@ -0,0 +1,208 @@
+#pragma once
+#include <cmath>
+#include <span>
+
+#include <SFML/Graphics/Transform.hpp>
+
+#include "vec.hpp"
+#include "vec_simd.hpp"
+
+namespace core
+{
+/* Parts of an affine transform, composed in the order translation * rotation * shear * scale */
+template <typename T>
+struct affine2_decomposition {
+    vec2<T> translation = {0, 0};
+    T       rotation    = 0; /* Radians */
+    vec2<T> scale       = {1, 1};
+    T       shear       = 0; /* x += shear * y before the rotation */
+};
+
+/*
+ * 2D affine transform as 2x3 matrix, the last row of the full 3x3 matrix is always 0 0 1
+ *   | m00 m01 m02 |
+ *   | m10 m11 m12 |
+ * Composition a * b applies b first as sf::Transform does, conversions to and from sf::Transform keep the matrix
+ * Angles are in radians
+ */
+template <typename T>
+struct affine2 {
+    T m00 = 1, m01 = 0, m02 = 0;
+    T m10 = 0, m11 = 1, m12 = 0;
+
+    constexpr affine2() = default;
+
+    constexpr affine2(T im00, T im01, T im02, T im10, T im11, T im12):
+        m00(im00), m01(im01), m02(im02), m10(im10), m11(im11), m12(im12) {}
+
+    /* sf::Transform stores the 4x4 matrix column major */
+    explicit affine2(const sf::Transform& transform) {
+        auto m = transform.getMatrix();
+        *this  = {T(m[0]), T(m[4]), T(m[12]), T(m[1]), T(m[5]), T(m[13])};
+    }
+
+    operator sf::Transform() const {
+        return {float(m00), float(m01), float(m02), float(m10), float(m11), float(m12), 0.f, 0.f, 1.f};
+    }
+
+    static constexpr affine2 identity() {
+        return {};
+    }
+
+    static constexpr affine2 translation(const vec2<T>& offset) {
+        return {1, 0, offset.v[0], 0, 1, offset.v[1]};
+    }
+
+    static constexpr affine2 scaling(const vec2<T>& factors) {
+        return {factors.v[0], 0, 0, 0, factors.v[1], 0};
+    }
+
+    /* Scaling which keeps center in place */
+    static constexpr affine2 scaling(const vec2<T>& factors, const vec2<T>& center) {
+        return {factors.v[0], 0, center.v[0] * (1 - factors.v[0]), 0, factors.v[1], center.v[1] * (1 - factors.v[1])};
+    }
+
+    static affine2 rotation(T angle) {
+        auto cos = std::cos(angle);
+        auto sin = std::sin(angle);
+        return {cos, -sin, 0, sin, cos, 0};
+    }
+
+    static affine2 rotation(T angle, const vec2<T>& center) {
+        return translation(center) * rotation(angle) * translation(-center);
+    }
+
+    static constexpr affine2 shearing(T shear) {
+        return {1, shear, 0, 0, 1, 0};
+    }
+
+    static affine2 compose(const affine2_decomposition<T>& parts) {
+        return translation(parts.translation) * rotation(parts.rotation) * shearing(parts.shear) *
+               scaling(parts.scale);
+    }
+
+    constexpr affine2 operator*(const affine2& rhs) const {
+        return {m00 * rhs.m00 + m01 * rhs.m10,
+                m00 * rhs.m01 + m01 * rhs.m11,
+                m00 * rhs.m02 + m01 * rhs.m12 + m02,
+                m10 * rhs.m00 + m11 * rhs.m10,
+                m10 * rhs.m01 + m11 * rhs.m11,
+                m10 * rhs.m02 + m11 * rhs.m12 + m12};
+    }
+
+    constexpr affine2& operator*=(const affine2& rhs) {
+        return *this = *this * rhs;
+    }
+
+    constexpr bool operator==(const affine2&) const = default;
+
+    constexpr vec2<T> transform_point(const vec2<T>& p) const {
+        return {m00 * p.v[0] + m01 * p.v[1] + m02, m10 * p.v[0] + m11 * p.v[1] + m12};
+    }
+
+    /* Without the translation, for directions and sizes */
+    constexpr vec2<T> transform_vector(const vec2<T>& v) const {
+        return {m00 * v.v[0] + m01 * v.v[1], m10 * v.v[0] + m11 * v.v[1]};
+    }
+
+    constexpr vec2<T> get_translation() const {
+        return {m02, m12};
+    }
+
+    /* Images of the unit axes */
+    constexpr vec2<T> get_x_axis() const {
+        return {m00, m10};
+    }
+
+    constexpr vec2<T> get_y_axis() const {
+        return {m01, m11};
+    }
+
+    constexpr T determinant() const {
+        return m00 * m11 - m01 * m10;
+    }
+
+    /* Identity for singular transforms as sf::Transform::getInverse does */
+    constexpr affine2 inverse() const {
+        auto det = determinant();
+        if (det == 0)
+            return {};
+
+        auto i00 = m11 / det;
+        auto i01 = -m01 / det;
+        auto i10 = -m10 / det;
+        auto i11 = m00 / det;
+        return {i00, i01, -(i00 * m02 + i01 * m12), i10, i11, -(i10 * m02 + i11 * m12)};
+    }
+
+    /*
+     * QR decomposition of the linear part, x scale is always positive, reflections give negative y scale
+     * Singular transforms with zero x axis give zero rotation and shear
+     */
+    affine2_decomposition<T> decompose() const {
+        affine2_decomposition<T> parts;
+        parts.translation = get_translation();
+
+        auto sx = std::hypot(m00, m10);
+        if (sx == 0) {
+            parts.scale = vec2<T>{0, std::hypot(m01, m11)};
+            return parts;
+        }
+
+        auto cos       = m00 / sx;
+        auto sin       = m10 / sx;
+        auto sy        = determinant() / sx;
+        parts.rotation = std::atan2(m10, m00);
+        parts.scale    = vec2<T>{sx, sy};
+        parts.shear    = sy == 0 ? T(0) : (cos * m01 + sin * m11) / sy;
+        return parts;
+    }
+
+    /*
+     * Transforms points into out, which should be at least as long, in place transform is allowed
+     * SSE processes two float points at once, AVX four
+     */
+    void transform_points(std::span<const vec2<T>> points, std::span<vec2<T>> out) const {
+        size_t i = 0;
+        if constexpr (std::is_same_v<T, float>) {
+            auto pi = points.empty() ? nullptr : points.front().v.data();
+            auto po = out.empty() ? nullptr : out.front().v.data();
+            auto n  = points.size() * 2;
+
+            /* (x, x) * (m00, m10) + (y, y) * (m01, m11) + (m02, m12) per point */
+#ifdef __AVX__
+            auto col0_8 = _mm256_setr_ps(m00, m10, m00, m10, m00, m10, m00, m10);
+            auto col1_8 = _mm256_setr_ps(m01, m11, m01, m11, m01, m11, m01, m11);
+            auto col2_8 = _mm256_setr_ps(m02, m12, m02, m12, m02, m12, m02, m12);
+            for (; i + 8 <= n; i += 8) {
+                auto v  = _mm256_loadu_ps(pi + i);
+                auto xs = _mm256_permute_ps(v, _MM_SHUFFLE(2, 2, 0, 0));
+                auto ys = _mm256_permute_ps(v, _MM_SHUFFLE(3, 3, 1, 1));
+                auto r  = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(xs, col0_8), _mm256_mul_ps(ys, col1_8)), col2_8);
+                _mm256_storeu_ps(po + i, r);
+            }
+#endif
+#ifdef CORE_VEC_SSE
+            auto col0 = _mm_setr_ps(m00, m10, m00, m10);
+            auto col1 = _mm_setr_ps(m01, m11, m01, m11);
+            auto col2 = _mm_setr_ps(m02, m12, m02, m12);
+            for (; i + 4 <= n; i += 4) {
+                auto v  = _mm_loadu_ps(pi + i);
+                auto xs = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 0, 0));
+                auto ys = _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 1, 1));
+                _mm_storeu_ps(po + i, _mm_add_ps(_mm_add_ps(_mm_mul_ps(xs, col0), _mm_mul_ps(ys, col1)), col2));
+            }
+#endif
+            i /= 2;
+        }
+        for (; i < points.size(); ++i) out[i] = transform_point(points[i]);
+    }
+
+    void transform_points(std::span<vec2<T>> points) const {
+        transform_points(points, points);
+    }
+};
+
+using affine2f = affine2<float>;
+using affine2d = affine2<double>;
+} // namespace core
@@ -0,0 +1,37 @@
+#pragma once
+#include <cstddef>
+#include <new>
+
+namespace core
+{
+/*
+ * Allocator for containers of SIMD data, the storage starts at the given alignment
+ */
+template <typename T, size_t Alignment = 32>
+struct aligned_allocator {
+    using value_type = T;
+
+    template <typename U>
+    struct rebind {
+        using other = aligned_allocator<U, Alignment>;
+    };
+
+    aligned_allocator() = default;
+
+    template <typename U>
+    aligned_allocator(const aligned_allocator<U, Alignment>&) noexcept {}
+
+    T* allocate(size_t count) {
+        return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t{Alignment}));
+    }
+
+    void deallocate(T* pointer, size_t) noexcept {
+        ::operator delete(pointer, std::align_val_t{Alignment});
+    }
+
+    template <typename U>
+    bool operator==(const aligned_allocator<U, Alignment>&) const noexcept {
+        return true;
+    }
+};
+} // namespace core
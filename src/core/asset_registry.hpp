@@ -0,0 +1,173 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace core
+{
+/*
+ * Insert-only map from asset keys to values which never move or disappear
+ * Lookups of existing keys are wait-free: the key hash picks a shard, the shard table is read with atomic loads only
+ * Insertions lock their shard, a full table is rebuilt twice larger and published atomically,
+ * old tables are kept until destruction (their total size is less than the current one)
+ * get_or_load runs the loader once per key, concurrent requests for the same key wait for it (single flight)
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key>, size_t ShardsCount = 16>
+class asset_registry {
+public:
+    asset_registry() {
+        for (auto&& shard : shards) shard.publish(std::make_unique<table_t>(initial_buckets));
+    }
+
+    asset_registry(const asset_registry&)            = delete;
+    asset_registry& operator=(const asset_registry&) = delete;
+
+    Value* find(const Key& key) {
+        auto node = find_node(key, Hash{}(key));
+        return node ? &node->value : nullptr;
+    }
+
+    const Value* find(const Key& key) const {
+        auto node = find_node(key, Hash{}(key));
+        return node ? &node->value : nullptr;
+    }
+
+    /* Value is default-constructed on the first request */
+    Value& get(const Key& key) {
+        return get_node(key).value;
+    }
+
+    /* loader(Value&) runs once per key, if it throws the exception is passed to the caller and the next call retries */
+    template <typename F>
+    Value& get_or_load(const Key& key, F&& loader) {
+        auto& node = get_node(key);
+        std::call_once(node.loaded, [&] { loader(node.value); });
+        return node.value;
+    }
+
+    /* function(const Key&, Value&), values inserted concurrently may be missed */
+    template <typename F>
+    void for_each(F&& function) {
+        for (auto&& shard : shards) {
+            std::lock_guard lock{shard.mtx};
+            for (auto&& node : shard.nodes) function(std::as_const(node.key), node.value);
+        }
+    }
+
+    template <typename F>
+    void for_each(F&& function) const {
+        for (auto&& shard : shards) {
+            std::lock_guard lock{shard.mtx};
+            for (auto&& node : shard.nodes) function(node.key, std::as_const(node.value));
+        }
+    }
+
+    size_t size() const {
+        size_t count = 0;
+        for (auto&& shard : shards) count += shard.count.load(std::memory_order_relaxed);
+        return count;
+    }
+
+private:
+    static inline constexpr size_t initial_buckets = 64;
+
+    struct node_t {
+        node_t(const Key& ikey): key(ikey) {}
+
+        Key            key;
+        Value          value;
+        std::once_flag loaded;
+    };
+
+    struct link_t {
+        size_t               hash;
+        node_t*              node;
+        std::atomic<link_t*> next = nullptr;
+    };
+
+    struct table_t {
+        table_t(size_t buckets_count): buckets(buckets_count) {}
+
+        std::vector<std::atomic<link_t*>> buckets;
+        std::deque<link_t>                links;
+    };
+
+    struct shard_t {
+        void publish(std::unique_ptr<table_t> table) {
+            current.store(table.get(), std::memory_order_release);
+            tables.push_back(std::move(table));
+        }
+
+        mutable std::mutex                    mtx;
+        std::atomic<const table_t*>           current = nullptr;
+        std::vector<std::unique_ptr<table_t>> tables; /* Last is the current one, others are retired */
+        std::deque<node_t>                    nodes;
+        std::atomic<size_t>                   count = 0;
+    };
+
+    /* Low bits pick the bucket, the mixed hash picks the shard so identity hashes spread too */
+    static size_t shard_index(size_t hash) {
+        return size_t((uint64_t(hash) * 0x9e3779b97f4a7c15ULL) >> 56) % ShardsCount;
+    }
+
+    static node_t* find_in(const table_t& table, const Key& key, size_t hash) {
+        auto& bucket = table.buckets[hash & (table.buckets.size() - 1)];
+        auto  link   = bucket.load(std::memory_order_acquire);
+        for (; link; link = link->next.load(std::memory_order_acquire))
+            if (link->hash == hash && link->node->key == key)
+                return link->node;
+        return nullptr;
+    }
+
+    node_t* find_node(const Key& key, size_t hash) const {
+        auto& shard = shards[shard_index(hash)];
+        return find_in(*shard.current.load(std::memory_order_acquire), key, hash);
+    }
+
+    node_t& get_node(const Key& key) {
+        auto hash = Hash{}(key);
+        if (auto node = find_node(key, hash))
+            return *node;
+
+        auto&           shard = shards[shard_index(hash)];
+        std::lock_guard lock{shard.mtx};
+
+        auto& table = *shard.tables.back();
+        if (auto node = find_in(table, key, hash))
+            return *node;
+
+        auto& node = shard.nodes.emplace_back(key);
+        shard.count.fetch_add(1, std::memory_order_relaxed);
+
+        if (shard.nodes.size() > table.buckets.size() / 4 * 3)
+            shard.publish(rebuild(shard, table.buckets.size() * 2));
+        else
+            insert(*shard.tables.back(), node, hash);
+        return node;
+    }
+
+    /* Readers may walk the bucket at the same time, the link is complete before it is published */
+    static void insert(table_t& table, node_t& node, size_t hash) {
+        auto& bucket = table.buckets[hash & (table.buckets.size() - 1)];
+        auto& link   = table.links.emplace_back(hash, &node);
+        link.next.store(bucket.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        bucket.store(&link, std::memory_order_release);
+    }
+
+    static std::unique_ptr<table_t> rebuild(shard_t& shard, size_t buckets_count) {
+        auto table = std::make_unique<table_t>(buckets_count);
+        for (auto&& node : shard.nodes) insert(*table, node, Hash{}(node.key));
+        return table;
+    }
+
+private:
+    std::array<shard_t, ShardsCount> shards;
+};
+} // namespace core
@@ -0,0 +1,151 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "hash.hpp"
+#include "mapped_file.hpp"
+
+namespace core
+{
+/*
+ * Directory of immutable blobs keyed by content hash
+ * Entries are written to a temporary file and renamed, so readers never see partial data
+ * Modification time is the last use, the least recently used entries are removed over max_size
+ * Thread-safe
+ */
+class disk_cache {
+public:
+    disk_cache(const std::string& dir_path, uint64_t imax_size): dir(dir_path), max_size(imax_size) {
+        std::error_code ec;
+        std::filesystem::create_directories(dir, ec);
+        opened = !ec && std::filesystem::is_directory(dir, ec);
+
+        if (opened)
+            for (auto&& entry : std::filesystem::directory_iterator(dir, ec))
+                if (entry.is_regular_file(ec))
+                    size += entry.file_size(ec);
+    }
+
+    disk_cache(const disk_cache&)            = delete;
+    disk_cache& operator=(const disk_cache&) = delete;
+
+    /* Key from the kind of data (include its format version) and the content hash of the source */
+    static std::string make_key(std::string_view tag, uint64_t content_hash) {
+        char hex[17];
+        std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(content_hash));
+        return std::string(tag) + "_" + hex;
+    }
+
+    bool is_open() const {
+        return opened;
+    }
+
+    bool load(const std::string& key, mapped_file& file) const {
+        if (!opened || !file.open((dir / key).string()))
+            return false;
+
+        std::error_code ec;
+        std::filesystem::last_write_time(dir / key, std::filesystem::file_time_type::clock::now(), ec);
+        return true;
+    }
+
+    bool store(const std::string& key, std::span<const std::byte> data) {
+        if (!opened)
+            return false;
+
+        auto tmp_path =
+            dir / (key + ".tmp" + std::to_string(::getpid()) + "_" + std::to_string(tmp_counter.fetch_add(1)));
+        {
+            std::ofstream ofs(tmp_path, std::ios::binary);
+            ofs.write(reinterpret_cast<const char*>(data.data()), std::streamsize(data.size()));
+            if (!ofs) {
+                std::error_code ec;
+                std::filesystem::remove(tmp_path, ec);
+                return false;
+            }
+        }
+
+        /* An existing entry of the key is replaced, its size is taken back under the lock with the rename */
+        std::lock_guard lock{mtx};
+        std::error_code ec;
+        auto            path     = dir / key;
+        auto            replaced = std::filesystem::file_size(path, ec);
+        if (ec)
+            replaced = 0;
+
+        std::filesystem::rename(tmp_path, path, ec);
+        if (ec) {
+            std::filesystem::remove(tmp_path, ec);
+            return false;
+        }
+
+        size = size - std::min(size, replaced) + data.size();
+        if (size > max_size)
+            trim_locked();
+        return true;
+    }
+
+    uint64_t get_size() const {
+        std::lock_guard lock{mtx};
+        return size;
+    }
+
+    uint64_t get_max_size() const {
+        return max_size;
+    }
+
+    void clear() {
+        std::lock_guard lock{mtx};
+        std::error_code ec;
+        for (auto&& entry : std::filesystem::directory_iterator(dir, ec)) std::filesystem::remove(entry.path(), ec);
+        size = 0;
+    }
+
+private:
+    /* Removes the oldest entries until the cache fits 3/4 of max_size, so trimming does not run on every store */
+    void trim_locked() {
+        struct entry_t {
+            std::filesystem::path           path;
+            std::filesystem::file_time_type time;
+            uint64_t                        size;
+        };
+
+        std::error_code      ec;
+        std::vector<entry_t> entries;
+        size = 0;
+        for (auto&& entry : std::filesystem::directory_iterator(dir, ec)) {
+            /* Files being written by other threads are not counted */
+            if (!entry.is_regular_file(ec) || entry.path().filename().string().find(".tmp") != std::string::npos)
+                continue;
+            entries.push_back({entry.path(), entry.last_write_time(ec), entry.file_size(ec)});
+            size += entries.back().size;
+        }
+
+        std::sort(entries.begin(), entries.end(), [](auto&& a, auto&& b) { return a.time < b.time; });
+
+        for (auto&& entry : entries) {
+            if (size <= max_size / 4 * 3)
+                break;
+            if (std::filesystem::remove(entry.path, ec))
+                size -= entry.size;
+        }
+    }
+
+private:
+    std::filesystem::path dir;
+    uint64_t              max_size;
+    uint64_t              size   = 0;
+    bool                  opened = false;
+    mutable std::mutex    mtx;
+    std::atomic<uint64_t> tmp_counter = 0;
+};
+} // namespace core
@@ -0,0 +1,317 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <numbers>
+#include <span>
+#include <utility>
+
+#include "vec.hpp"
+#include "vec_simd.hpp"
+
+namespace core
+{
+/*
+ * Approximate math for effects and handlers which call it per element every frame
+ * Functions have scalar, SSE and span variants which evaluate the same operations and give the same results,
+ * the bounds below are checked by bench/fastmath_accuracy against double precision std functions:
+ *   sin, cos    absolute error for |x| <= 8192, the reduction to [-pi / 4, pi / 4] loses precision above
+ *   atan2       absolute error in radians, atan2(0, 0) is 0
+ *   exp         relative error for -87 <= x <= 88, smaller arguments give 0 and larger give infinity
+ *   rsqrt       relative error for positive normal floats, normalize adds one rounding of the product
+ * NaN and infinite arguments are not handled
+ * Scalar exp and normalize are no faster than glibc expf and vec::normalize, their gain is in the SSE and span variants
+ */
+namespace fastmath
+{
+    inline constexpr float sin_max_error   = 2e-7f;
+    inline constexpr float cos_max_error   = 2e-7f;
+    inline constexpr float atan2_max_error = 3e-6f;
+    inline constexpr float exp_max_error   = 3e-7f;
+    inline constexpr float rsqrt_max_error = 5e-7f;
+
+    namespace detail
+    {
+        /* Cody-Waite splits, high parts have trailing zero bits so their products with small integers are exact */
+        inline constexpr float two_over_pi = float(2. / std::numbers::pi);
+        inline constexpr float pio2_hi     = 1.5703125f;
+        inline constexpr float pio2_mid    = 4.8351287841796875e-4f;
+        inline constexpr float pio2_lo     = 3.13916473e-7f;
+        inline constexpr float ln2_hi      = 0.693359375f;
+        inline constexpr float ln2_lo      = -2.12194440e-4f;
+        inline constexpr float exp_min     = -87.f;
+        inline constexpr float exp_max     = 88.f;
+        inline constexpr float pi          = std::numbers::pi_v<float>;
+        inline constexpr float pi_2        = std::numbers::pi_v<float> / 2;
+
+        /* Polynomials of cephes sinf, cosf and expf on the reduced ranges, atan is a minimax fit on [0, 1] */
+        inline float sin_poly(float r, float r2) {
+            return r + r * r2 * (-1.6666654611e-1f + r2 * (8.3321608736e-3f + r2 * -1.9515295891e-4f));
+        }
+
+        inline float cos_poly(float r2) {
+            return 1.f - 0.5f * r2 +
+                   r2 * r2 * (4.166664568298827e-2f + r2 * (-1.388731625493765e-3f + r2 * 2.443315711809948e-5f));
+        }
+
+        inline float atan_poly(float z) {
+            auto z2 = z * z;
+            return z * (0.99997726f +
+                        z2 * (-0.33262347f +
+                              z2 * (0.19354346f + z2 * (-0.11643287f + z2 * (0.05265332f + z2 * -0.01172120f)))));
+        }
+
+        inline float exp_poly(float r) {
+            return 1.f + r +
+                   r * r *
+                       (5.0000001201e-1f +
+                        r * (1.6666665459e-1f +
+                             r * (4.1665795894e-2f +
+                                  r * (8.3334519073e-3f + r * (1.3981999507e-3f + r * 1.9875691500e-4f)))));
+        }
+
+        /* Round to nearest the same way cvtps2dq does in the SSE variants */
+        inline int32_t round_int(float x) {
+#ifdef CORE_VEC_SSE
+            return _mm_cvtss_si32(_mm_set_ss(x));
+#else
+            return int32_t(std::lrint(x));
+#endif
+        }
+
+#ifdef CORE_VEC_SSE
+        inline __m128 madd(__m128 a, __m128 b, float c) {
+            return _mm_add_ps(_mm_mul_ps(a, b), _mm_set1_ps(c));
+        }
+
+        inline __m128 select(__m128 mask, __m128 a, __m128 b) {
+            return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+        }
+
+        inline __m128 sin_poly(__m128 r, __m128 r2) {
+            auto p = madd(r2, _mm_set1_ps(-1.9515295891e-4f), 8.3321608736e-3f);
+            p      = madd(r2, p, -1.6666654611e-1f);
+            return _mm_add_ps(r, _mm_mul_ps(_mm_mul_ps(r, r2), p));
+        }
+
+        inline __m128 cos_poly(__m128 r2) {
+            auto p = madd(r2, _mm_set1_ps(2.443315711809948e-5f), -1.388731625493765e-3f);
+            p      = madd(r2, p, 4.166664568298827e-2f);
+            return _mm_add_ps(_mm_sub_ps(_mm_set1_ps(1.f), _mm_mul_ps(_mm_set1_ps(0.5f), r2)),
+                              _mm_mul_ps(_mm_mul_ps(r2, r2), p));
+        }
+
+        inline __m128 atan_poly(__m128 z) {
+            auto z2 = _mm_mul_ps(z, z);
+            auto p  = madd(z2, _mm_set1_ps(-0.01172120f), 0.05265332f);
+            p       = madd(z2, p, -0.11643287f);
+            p       = madd(z2, p, 0.19354346f);
+            p       = madd(z2, p, -0.33262347f);
+            p       = madd(z2, p, 0.99997726f);
+            return _mm_mul_ps(z, p);
+        }
+
+        inline __m128 exp_poly(__m128 r) {
+            auto p = madd(r, _mm_set1_ps(1.9875691500e-4f), 1.3981999507e-3f);
+            p      = madd(r, p, 8.3334519073e-3f);
+            p      = madd(r, p, 4.1665795894e-2f);
+            p      = madd(r, p, 1.6666665459e-1f);
+            p      = madd(r, p, 5.0000001201e-1f);
+            return _mm_add_ps(_mm_add_ps(_mm_set1_ps(1.f), r), _mm_mul_ps(_mm_mul_ps(r, r), p));
+        }
+#endif
+    } // namespace detail
+
+    inline void sincos(float x, float& sin, float& cos) {
+        auto q  = detail::round_int(x * detail::two_over_pi);
+        auto fq = float(q);
+        auto r  = ((x - fq * detail::pio2_hi) - fq * detail::pio2_mid) - fq * detail::pio2_lo;
+        auto r2 = r * r;
+        auto s  = detail::sin_poly(r, r2);
+        auto c  = detail::cos_poly(r2);
+
+        /* Odd quadrants swap sin and cos, quadrants 2 and 3 negate sin, 1 and 2 negate cos */
+        if (q & 1)
+            std::swap(s, c);
+        sin = (q & 2) ? -s : s;
+        cos = ((q + 1) & 2) ? -c : c;
+    }
+
+    inline float sin(float x) {
+        float s, c;
+        sincos(x, s, c);
+        return s;
+    }
+
+    inline float cos(float x) {
+        float s, c;
+        sincos(x, s, c);
+        return c;
+    }
+
+    inline float atan2(float y, float x) {
+        auto ax = std::abs(x);
+        auto ay = std::abs(y);
+        auto mx = std::max(ax, ay);
+        auto a  = mx == 0.f ? 0.f : detail::atan_poly(std::min(ax, ay) / mx);
+        if (ay > ax)
+            a = detail::pi_2 - a;
+        if (x < 0.f)
+            a = detail::pi - a;
+        return y < 0.f ? -a : a;
+    }
+
+    inline float exp(float x) {
+        if (x < detail::exp_min)
+            return 0.f;
+        if (x > detail::exp_max)
+            return std::numeric_limits<float>::infinity();
+
+        auto n  = detail::round_int(x * std::numbers::log2e_v<float>);
+        auto fn = float(n);
+        auto r  = (x - fn * detail::ln2_hi) - fn * detail::ln2_lo;
+        return detail::exp_poly(r) * std::bit_cast<float>(uint32_t(n + 127) << 23);
+    }
+
+    /* Hardware estimate refined by one Newton step, the fallback starts from the bit trick and needs three */
+    inline float rsqrt(float x) {
+#ifdef CORE_VEC_SSE
+        auto y = _mm_cvtss_f32(_mm_rsqrt_ss(_mm_set_ss(x)));
+#else
+        auto y = std::bit_cast<float>(0x5f375a86u - (std::bit_cast<uint32_t>(x) >> 1));
+        y      = y * (1.5f - 0.5f * x * (y * y));
+        y      = y * (1.5f - 0.5f * x * (y * y));
+#endif
+        return y * (1.5f - 0.5f * x * (y * y));
+    }
+
+    /* Zero vectors give NaN as vec::normalize does */
+    template <size_t S>
+    inline vec<float, S> normalize(const vec<float, S>& v) {
+        return v * rsqrt(v.magnitude_2());
+    }
+
+#ifdef CORE_VEC_SSE
+    inline void sincos(__m128 x, __m128& sin, __m128& cos) {
+        auto q  = _mm_cvtps_epi32(_mm_mul_ps(x, _mm_set1_ps(detail::two_over_pi)));
+        auto fq = _mm_cvtepi32_ps(q);
+        auto r  = _mm_sub_ps(x, _mm_mul_ps(fq, _mm_set1_ps(detail::pio2_hi)));
+        r       = _mm_sub_ps(r, _mm_mul_ps(fq, _mm_set1_ps(detail::pio2_mid)));
+        r       = _mm_sub_ps(r, _mm_mul_ps(fq, _mm_set1_ps(detail::pio2_lo)));
+        auto r2 = _mm_mul_ps(r, r);
+        auto s  = detail::sin_poly(r, r2);
+        auto c  = detail::cos_poly(r2);
+
+        /* Bit 1 of the quadrant shifted to the sign bit negates */
+        auto one      = _mm_set1_epi32(1);
+        auto swap     = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(q, one), one));
+        auto sign_bit = _mm_set1_ps(-0.f);
+        auto sin_sign = _mm_and_ps(_mm_castsi128_ps(_mm_slli_epi32(q, 30)), sign_bit);
+        auto cos_sign = _mm_and_ps(_mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(q, one), 30)), sign_bit);
+        sin           = _mm_xor_ps(detail::select(swap, c, s), sin_sign);
+        cos           = _mm_xor_ps(detail::select(swap, s, c), cos_sign);
+    }
+
+    inline __m128 sin(__m128 x) {
+        __m128 s, c;
+        sincos(x, s, c);
+        return s;
+    }
+
+    inline __m128 cos(__m128 x) {
+        __m128 s, c;
+        sincos(x, s, c);
+        return c;
+    }
+
+    inline __m128 atan2(__m128 y, __m128 x) {
+        auto sign_bit = _mm_set1_ps(-0.f);
+        auto zero     = _mm_setzero_ps();
+        auto ax       = _mm_andnot_ps(sign_bit, x);
+        auto ay       = _mm_andnot_ps(sign_bit, y);
+        auto mx       = _mm_max_ps(ax, ay);
+        auto z        = _mm_and_ps(_mm_cmpneq_ps(mx, zero), _mm_div_ps(_mm_min_ps(ax, ay), mx));
+        auto a        = detail::atan_poly(z);
+        a             = detail::select(_mm_cmpgt_ps(ay, ax), _mm_sub_ps(_mm_set1_ps(detail::pi_2), a), a);
+        a             = detail::select(_mm_cmplt_ps(x, zero), _mm_sub_ps(_mm_set1_ps(detail::pi), a), a);
+        return _mm_xor_ps(a, _mm_and_ps(_mm_cmplt_ps(y, zero), sign_bit));
+    }
+
+    inline __m128 exp(__m128 x) {
+        auto min = _mm_set1_ps(detail::exp_min);
+        auto max = _mm_set1_ps(detail::exp_max);
+        auto xc  = _mm_min_ps(_mm_max_ps(x, min), max);
+        auto n   = _mm_cvtps_epi32(_mm_mul_ps(xc, _mm_set1_ps(std::numbers::log2e_v<float>)));
+        auto fn  = _mm_cvtepi32_ps(n);
+        auto r   = _mm_sub_ps(xc, _mm_mul_ps(fn, _mm_set1_ps(detail::ln2_hi)));
+        r        = _mm_sub_ps(r, _mm_mul_ps(fn, _mm_set1_ps(detail::ln2_lo)));
+        auto p   = _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(n, _mm_set1_epi32(127)), 23));
+        auto e   = _mm_andnot_ps(_mm_cmplt_ps(x, min), _mm_mul_ps(detail::exp_poly(r), p));
+        return detail::select(_mm_cmpgt_ps(x, max), _mm_set1_ps(std::numeric_limits<float>::infinity()), e);
+    }
+
+    inline __m128 rsqrt(__m128 x) {
+        auto y = _mm_rsqrt_ps(x);
+        auto h = _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), x), _mm_mul_ps(y, y));
+        return _mm_mul_ps(y, _mm_sub_ps(_mm_set1_ps(1.5f), h));
+    }
+#endif
+
+    /*
+     * Span variants, the outputs should be at least as long as the inputs
+     * SSE processes four floats or two vec2f at once, the tail goes through the scalar functions
+     */
+    inline void sincos(std::span<const float> angles, std::span<float> sines, std::span<float> cosines) {
+        size_t i = 0;
+#ifdef CORE_VEC_SSE
+        for (; i + 4 <= angles.size(); i += 4) {
+            __m128 s, c;
+            sincos(_mm_loadu_ps(&angles[i]), s, c);
+            _mm_storeu_ps(&sines[i], s);
+            _mm_storeu_ps(&cosines[i], c);
+        }
+#endif
+        for (; i < angles.size(); ++i) sincos(angles[i], sines[i], cosines[i]);
+    }
+
+    inline void atan2(std::span<const float> ys, std::span<const float> xs, std::span<float> result) {
+        size_t i = 0;
+#ifdef CORE_VEC_SSE
+        for (; i + 4 <= ys.size(); i += 4)
+            _mm_storeu_ps(&result[i], atan2(_mm_loadu_ps(&ys[i]), _mm_loadu_ps(&xs[i])));
+#endif
+        for (; i < ys.size(); ++i) result[i] = atan2(ys[i], xs[i]);
+    }
+
+    inline void exp(std::span<const float> values, std::span<float> result) {
+        size_t i = 0;
+#ifdef CORE_VEC_SSE
+        for (; i + 4 <= values.size(); i += 4) _mm_storeu_ps(&result[i], exp(_mm_loadu_ps(&values[i])));
+#endif
+        for (; i < values.size(); ++i) result[i] = exp(values[i]);
+    }
+
+    inline void rsqrt(std::span<const float> values, std::span<float> result) {
+        size_t i = 0;
+#ifdef CORE_VEC_SSE
+        for (; i + 4 <= values.size(); i += 4) _mm_storeu_ps(&result[i], rsqrt(_mm_loadu_ps(&values[i])));
+#endif
+        for (; i < values.size(); ++i) result[i] = rsqrt(values[i]);
+    }
+
+    inline void normalize(std::span<const vec2f> vecs, std::span<vec2f> result) {
+        size_t i = 0;
+#ifdef CORE_VEC_SSE
+        for (; i + 2 <= vecs.size(); i += 2) {
+            auto v       = _mm_loadu_ps(vecs[i].v.data());
+            auto squares = _mm_mul_ps(v, v);
+            auto m       = _mm_add_ps(squares, _mm_shuffle_ps(squares, squares, _MM_SHUFFLE(2, 3, 0, 1)));
+            _mm_storeu_ps(result[i].v.data(), _mm_mul_ps(v, rsqrt(m)));
+        }
+#endif
+        for (; i < vecs.size(); ++i) result[i] = normalize(vecs[i]);
+    }
+} // namespace fastmath
+} // namespace core
@@ -0,0 +1,89 @@
+#pragma once
+#include <algorithm>
+#include <filesystem>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <sys/inotify.h>
+#include <unistd.h>
+
+namespace core
+{
+/*
+ * Non-blocking inotify watcher
+ * Directories are watched instead of files so editors replacing the file by rename are noticed too
+ */
+class file_watcher {
+public:
+    file_watcher(): fd(::inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) {}
+
+    file_watcher(const file_watcher&)            = delete;
+    file_watcher& operator=(const file_watcher&) = delete;
+
+    ~file_watcher() {
+        if (fd >= 0)
+            ::close(fd);
+    }
+
+    bool is_open() const {
+        return fd >= 0;
+    }
+
+    /* Starts watching the directory of the file, returns false if inotify cannot watch it */
+    bool watch_file(const std::string& path) {
+        return watch_directory(normalize(path).parent_path().string());
+    }
+
+    bool watch_directory(const std::string& path) {
+        if (fd < 0)
+            return false;
+
+        auto dir = normalize(path).string();
+        auto wd  = ::inotify_add_watch(fd, dir.data(), IN_CLOSE_WRITE | IN_MOVED_TO);
+        if (wd < 0)
+            return false;
+
+        dirs.insert_or_assign(wd, std::move(dir));
+        return true;
+    }
+
+    /* Normalized paths of files written or moved in since the last poll, each path once */
+    std::vector<std::string> poll() {
+        std::vector<std::string> changed;
+        if (fd < 0)
+            return changed;
+
+        alignas(inotify_event) char buff[4096];
+        while (true) {
+            auto size = ::read(fd, buff, sizeof(buff));
+            if (size <= 0)
+                break;
+
+            for (ssize_t offset = 0; offset < size;) {
+                auto event = reinterpret_cast<const inotify_event*>(buff + offset);
+                offset += ssize_t(sizeof(inotify_event) + event->len);
+
+                auto dir = dirs.find(event->wd);
+                if (dir == dirs.end() || event->len == 0)
+                    continue;
+
+                auto path = (std::filesystem::path(dir->second) / event->name).string();
+                if (std::find(changed.begin(), changed.end(), path) == changed.end())
+                    changed.push_back(std::move(path));
+            }
+        }
+
+        return changed;
+    }
+
+    static std::filesystem::path normalize(const std::string& path) {
+        return std::filesystem::absolute(path).lexically_normal();
+    }
+
+private:
+    int                        fd;
+    std::map<int, std::string> dirs;
+};
+} // namespace core
@@ -0,0 +1,26 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+namespace core
+{
+/*
+ * 64-bit FNV-1a, used as content hash for cache keys
+ */
+inline constexpr uint64_t fnv1a64_basis = 0xcbf29ce484222325ULL;
+inline constexpr uint64_t fnv1a64_prime = 0x100000001b3ULL;
+
+inline uint64_t fnv1a64(std::span<const std::byte> bytes, uint64_t hash = fnv1a64_basis) {
+    for (auto byte : bytes) {
+        hash ^= uint64_t(byte);
+        hash *= fnv1a64_prime;
+    }
+    return hash;
+}
+
+inline uint64_t fnv1a64(std::string_view str, uint64_t hash = fnv1a64_basis) {
+    return fnv1a64(std::as_bytes(std::span(str)), hash);
+}
+} // namespace core
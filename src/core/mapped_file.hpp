@@ -0,0 +1,107 @@
+#pragma once
+#include <cstddef>
+#include <span>
+#include <string>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace core
+{
+/*
+ * Read-only memory mapping of a whole file
+ */
+class mapped_file {
+public:
+    mapped_file() = default;
+
+    mapped_file(const std::string& path) {
+        open(path);
+    }
+
+    mapped_file(const mapped_file&)            = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+    mapped_file(mapped_file&& file) noexcept:
+        addr(std::exchange(file.addr, nullptr)),
+        length(std::exchange(file.length, 0)),
+        opened(std::exchange(file.opened, false)) {}
+
+    mapped_file& operator=(mapped_file&& file) noexcept {
+        if (&file == this)
+            return *this;
+
+        close();
+        addr   = std::exchange(file.addr, nullptr);
+        length = std::exchange(file.length, 0);
+        opened = std::exchange(file.opened, false);
+        return *this;
+    }
+
+    ~mapped_file() {
+        close();
+    }
+
+    bool open(const std::string& path) {
+        close();
+
+        auto fd = ::open(path.data(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            return false;
+
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            return false;
+        }
+
+        length = size_t(st.st_size);
+        if (length > 0) {
+            auto p = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p == MAP_FAILED) {
+                ::close(fd);
+                length = 0;
+                return false;
+            }
+            addr = static_cast<std::byte*>(p);
+        }
+
+        /* The mapping stays valid after the descriptor is closed */
+        ::close(fd);
+        opened = true;
+        return true;
+    }
+
+    void close() {
+        if (addr)
+            ::munmap(addr, length);
+        addr   = nullptr;
+        length = 0;
+        opened = false;
+    }
+
+    bool is_open() const {
+        return opened;
+    }
+
+    const std::byte* data() const {
+        return addr;
+    }
+
+    size_t size() const {
+        return length;
+    }
+
+    std::span<const std::byte> bytes() const {
+        return {addr, length};
+    }
+
+private:
+    std::byte* addr   = nullptr;
+    size_t     length = 0;
+    bool       opened = false;
+};
+} // namespace core
@@ -90,7 +90,7 @@ namespace dependence {
 
     template <typename T>
     T square_root(T value) {
-        return std::pow(value, T(0.5));
+        return std::sqrt(value);
     }
 } // namespace dependence
 } // namespace core
@@ -0,0 +1,692 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <span>
+
+#include "vec.hpp"
+#include "vec_simd.hpp"
+
+namespace core
+{
+/*
+ * Gradient noise fields for turbulence, wobble and shake
+ *   value    hashed lattice values with quintic interpolation
+ *   perlin   hashed lattice gradients with quintic interpolation
+ *   simplex  hashed gradients summed over the corners of the simplex containing the point, cheaper in 3D
+ *   curl     curl of simplex noise by central differences, a divergence free flow, its magnitude is not normalized
+ * Noise values are in [-1, 1]: value noise and 1D perlin by construction, the others are scaled so their extremes
+ * over dense sweeps of the lattice come close to +-1 and clamped
+ * Lattice hashes are arithmetic instead of permutation tables, so span variants evaluate four points per
+ * SSE register with the same operations and give the same results as the scalar functions
+ * Coordinates should stay within +-2^23, larger ones have no fractional part
+ */
+namespace noise
+{
+    namespace detail
+    {
+        /* Lanes of the generic kernels, float with uint32_t and bool, or four SSE lanes */
+#ifdef CORE_VEC_SSE
+        struct f4 {
+            __m128 v;
+
+            f4(__m128 iv): v(iv) {}
+            f4(float value): v(_mm_set1_ps(value)) {}
+        };
+
+        struct i4 {
+            __m128i v;
+
+            i4(__m128i iv): v(iv) {}
+            i4(uint32_t value): v(_mm_set1_epi32(int32_t(value))) {}
+        };
+
+        struct m4 {
+            __m128 v;
+        };
+
+        inline f4 operator+(f4 a, f4 b) {
+            return _mm_add_ps(a.v, b.v);
+        }
+
+        inline f4 operator-(f4 a, f4 b) {
+            return _mm_sub_ps(a.v, b.v);
+        }
+
+        inline f4 operator*(f4 a, f4 b) {
+            return _mm_mul_ps(a.v, b.v);
+        }
+
+        inline f4 operator/(f4 a, f4 b) {
+            return _mm_div_ps(a.v, b.v);
+        }
+
+        inline i4 operator+(i4 a, i4 b) {
+            return _mm_add_epi32(a.v, b.v);
+        }
+
+        inline i4 operator^(i4 a, i4 b) {
+            return _mm_xor_si128(a.v, b.v);
+        }
+
+        inline i4 operator&(i4 a, i4 b) {
+            return _mm_and_si128(a.v, b.v);
+        }
+
+        inline i4 operator>>(i4 a, int shift) {
+            return _mm_srli_epi32(a.v, shift);
+        }
+
+        /* Low 32 bits of the products, SSE2 has only the 64 bit multiply of even lanes */
+        inline i4 operator*(i4 a, i4 b) {
+#ifdef __SSE4_1__
+            return _mm_mullo_epi32(a.v, b.v);
+#else
+            auto even = _mm_mul_epu32(a.v, b.v);
+            auto odd  = _mm_mul_epu32(_mm_srli_si128(a.v, 4), _mm_srli_si128(b.v, 4));
+            return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                                      _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+#endif
+        }
+
+        inline m4 operator>(f4 a, f4 b) {
+            return {_mm_cmpgt_ps(a.v, b.v)};
+        }
+
+        inline m4 operator>=(f4 a, f4 b) {
+            return {_mm_cmpge_ps(a.v, b.v)};
+        }
+
+        inline m4 operator&(m4 a, m4 b) {
+            return {_mm_and_ps(a.v, b.v)};
+        }
+
+        inline m4 operator|(m4 a, m4 b) {
+            return {_mm_or_ps(a.v, b.v)};
+        }
+
+        inline m4 operator!(m4 a) {
+            return {_mm_xor_ps(a.v, _mm_castsi128_ps(_mm_set1_epi32(-1)))};
+        }
+
+        /* !a & b in one instruction */
+        inline m4 andnot(m4 a, m4 b) {
+            return {_mm_andnot_ps(a.v, b.v)};
+        }
+
+        inline f4 select(m4 mask, f4 a, f4 b) {
+            return _mm_or_ps(_mm_and_ps(mask.v, a.v), _mm_andnot_ps(mask.v, b.v));
+        }
+
+        inline i4 select(m4 mask, i4 a, i4 b) {
+            auto m = _mm_castps_si128(mask.v);
+            return _mm_or_si128(_mm_and_si128(m, a.v), _mm_andnot_si128(m, b.v));
+        }
+
+        /* Exact for |x| < 2^31 as std::floor */
+        inline f4 floor(f4 x) {
+            auto t = _mm_cvtepi32_ps(_mm_cvttps_epi32(x.v));
+            return _mm_sub_ps(t, _mm_and_ps(_mm_cmpgt_ps(t, x.v), _mm_set1_ps(1.f)));
+        }
+
+        inline f4 min(f4 a, f4 b) {
+            return _mm_min_ps(a.v, b.v);
+        }
+
+        inline f4 max(f4 a, f4 b) {
+            return _mm_max_ps(a.v, b.v);
+        }
+
+        inline i4 to_int(f4 x) {
+            return _mm_cvttps_epi32(x.v);
+        }
+
+        inline f4 to_float(i4 x) {
+            return _mm_cvtepi32_ps(x.v);
+        }
+
+        inline i4 lane_int(f4);
+#endif
+
+        inline bool andnot(bool a, bool b) {
+            return !a && b;
+        }
+
+        inline float select(bool mask, float a, float b) {
+            return mask ? a : b;
+        }
+
+        inline uint32_t select(bool mask, uint32_t a, uint32_t b) {
+            return mask ? a : b;
+        }
+
+        inline float floor(float x) {
+            return std::floor(x);
+        }
+
+        inline float min(float a, float b) {
+            return std::min(a, b);
+        }
+
+        inline float max(float a, float b) {
+            return std::max(a, b);
+        }
+
+        inline uint32_t to_int(float x) {
+            return uint32_t(int32_t(x));
+        }
+
+        inline float to_float(uint32_t x) {
+            return float(int32_t(x));
+        }
+
+        inline uint32_t lane_int(float);
+
+        template <typename F>
+        using int_t = decltype(lane_int(std::declval<F>()));
+
+        /* Primes spreading lattice coordinates before the finalizer */
+        inline constexpr uint32_t prime_x = 0x8da6b343u;
+        inline constexpr uint32_t prime_y = 0xd8163841u;
+        inline constexpr uint32_t prime_z = 0xcb1ab31fu;
+
+        template <typename I>
+        inline I hash(I seed, I h) {
+            h = h ^ seed;
+            h = h ^ (h >> 15);
+            h = h * I(0x2c1b3c6du);
+            h = h ^ (h >> 12);
+            h = h * I(0x297a2d39u);
+            return h ^ (h >> 15);
+        }
+
+        /* Lattice value in [-1, 1] */
+        template <typename F, typename I>
+        inline F lattice_value(I h) {
+            return to_float(h & I(0xffffu)) * F(2.f / 65535.f) - F(1.f);
+        }
+
+        /* Gradient components in [-1, 1] from bytes of the hash */
+        template <typename F, typename I>
+        inline F gradient_component(I h, int byte) {
+            return to_float((h >> (byte * 8)) & I(0xffu)) * F(2.f / 255.f) - F(1.f);
+        }
+
+        template <typename F, typename I>
+        inline F grad(I h, F x) {
+            return lattice_value<F>(h) * x;
+        }
+
+        template <typename F, typename I>
+        inline F grad(I h, F x, F y) {
+            return gradient_component<F>(h, 0) * x + gradient_component<F>(h, 1) * y;
+        }
+
+        template <typename F, typename I>
+        inline F grad(I h, F x, F y, F z) {
+            return gradient_component<F>(h, 0) * x + gradient_component<F>(h, 1) * y + gradient_component<F>(h, 2) * z;
+        }
+
+        template <typename F>
+        inline F fade(F t) {
+            return t * t * t * (t * (t * F(6.f) - F(15.f)) + F(10.f));
+        }
+
+        template <typename F>
+        inline F lerp(F a, F b, F t) {
+            return a + (b - a) * t;
+        }
+
+        template <typename F>
+        inline F scale_clamped(F value, float scale) {
+            return max(min(value * F(scale), F(1.f)), F(-1.f));
+        }
+
+        template <typename F>
+        inline F value1(F x, uint32_t seed) {
+            using I = int_t<F>;
+            auto s  = I(seed);
+            auto fx = floor(x);
+            auto ix = to_int(fx) * I(prime_x);
+            auto v0 = lattice_value<F>(hash(s, ix));
+            auto v1 = lattice_value<F>(hash(s, ix + I(prime_x)));
+            return lerp(v0, v1, fade(x - fx));
+        }
+
+        template <typename F>
+        inline F value2(F x, F y, uint32_t seed) {
+            using I  = int_t<F>;
+            auto s   = I(seed);
+            auto fx  = floor(x);
+            auto fy  = floor(y);
+            auto ix0 = to_int(fx) * I(prime_x);
+            auto ix1 = ix0 + I(prime_x);
+            auto iy0 = to_int(fy) * I(prime_y);
+            auto iy1 = iy0 + I(prime_y);
+            auto u   = fade(x - fx);
+            auto v   = fade(y - fy);
+            auto v0  = lerp(lattice_value<F>(hash(s, ix0 ^ iy0)), lattice_value<F>(hash(s, ix1 ^ iy0)), u);
+            auto v1  = lerp(lattice_value<F>(hash(s, ix0 ^ iy1)), lattice_value<F>(hash(s, ix1 ^ iy1)), u);
+            return lerp(v0, v1, v);
+        }
+
+        template <typename F>
+        inline F value3(F x, F y, F z, uint32_t seed) {
+            using I  = int_t<F>;
+            auto s   = I(seed);
+            auto fx  = floor(x);
+            auto fy  = floor(y);
+            auto fz  = floor(z);
+            auto ix0 = to_int(fx) * I(prime_x);
+            auto ix1 = ix0 + I(prime_x);
+            auto iy0 = to_int(fy) * I(prime_y);
+            auto iy1 = iy0 + I(prime_y);
+            auto iz0 = to_int(fz) * I(prime_z);
+            auto iz1 = iz0 + I(prime_z);
+            auto u   = fade(x - fx);
+            auto v   = fade(y - fy);
+            auto w   = fade(z - fz);
+
+            auto layer = [&](I iz) {
+                auto v0 = lerp(lattice_value<F>(hash(s, ix0 ^ iy0 ^ iz)), lattice_value<F>(hash(s, ix1 ^ iy0 ^ iz)), u);
+                auto v1 = lerp(lattice_value<F>(hash(s, ix0 ^ iy1 ^ iz)), lattice_value<F>(hash(s, ix1 ^ iy1 ^ iz)), u);
+                return lerp(v0, v1, v);
+            };
+            return lerp(layer(iz0), layer(iz1), w);
+        }
+
+        /* Worst case of the 1D gradient dot products is 1/2 at the cell center */
+        template <typename F>
+        inline F perlin1(F x, uint32_t seed) {
+            using I = int_t<F>;
+            auto s  = I(seed);
+            auto fx = floor(x);
+            auto dx = x - fx;
+            auto ix = to_int(fx) * I(prime_x);
+            auto g0 = grad(hash(s, ix), dx);
+            auto g1 = grad(hash(s, ix + I(prime_x)), dx - F(1.f));
+            return lerp(g0, g1, fade(dx)) * F(2.f);
+        }
+
+        template <typename F>
+        inline F perlin2(F x, F y, uint32_t seed) {
+            using I  = int_t<F>;
+            auto s   = I(seed);
+            auto fx  = floor(x);
+            auto fy  = floor(y);
+            auto dx0 = x - fx;
+            auto dy0 = y - fy;
+            auto dx1 = dx0 - F(1.f);
+            auto dy1 = dy0 - F(1.f);
+            auto ix0 = to_int(fx) * I(prime_x);
+            auto ix1 = ix0 + I(prime_x);
+            auto iy0 = to_int(fy) * I(prime_y);
+            auto iy1 = iy0 + I(prime_y);
+            auto u   = fade(dx0);
+            auto v0  = lerp(grad(hash(s, ix0 ^ iy0), dx0, dy0), grad(hash(s, ix1 ^ iy0), dx1, dy0), u);
+            auto v1  = lerp(grad(hash(s, ix0 ^ iy1), dx0, dy1), grad(hash(s, ix1 ^ iy1), dx1, dy1), u);
+            return scale_clamped(lerp(v0, v1, fade(dy0)), 1.2f);
+        }
+
+        template <typename F>
+        inline F perlin3(F x, F y, F z, uint32_t seed) {
+            using I  = int_t<F>;
+            auto s   = I(seed);
+            auto fx  = floor(x);
+            auto fy  = floor(y);
+            auto fz  = floor(z);
+            auto dx0 = x - fx;
+            auto dy0 = y - fy;
+            auto dz0 = z - fz;
+            auto dx1 = dx0 - F(1.f);
+            auto dy1 = dy0 - F(1.f);
+            auto ix0 = to_int(fx) * I(prime_x);
+            auto ix1 = ix0 + I(prime_x);
+            auto iy0 = to_int(fy) * I(prime_y);
+            auto iy1 = iy0 + I(prime_y);
+            auto iz0 = to_int(fz) * I(prime_z);
+            auto u   = fade(dx0);
+            auto v   = fade(dy0);
+
+            auto layer = [&](I iz, F dz) {
+                auto g00 = grad(hash(s, ix0 ^ iy0 ^ iz), dx0, dy0, dz);
+                auto g10 = grad(hash(s, ix1 ^ iy0 ^ iz), dx1, dy0, dz);
+                auto g01 = grad(hash(s, ix0 ^ iy1 ^ iz), dx0, dy1, dz);
+                auto g11 = grad(hash(s, ix1 ^ iy1 ^ iz), dx1, dy1, dz);
+                return lerp(lerp(g00, g10, u), lerp(g01, g11, u), v);
+            };
+            return scale_clamped(lerp(layer(iz0, dz0), layer(iz0 + I(prime_z), dz0 - F(1.f)), fade(dz0)), 1.1f);
+        }
+
+        /* Corner contributions are (r0^2 - r^2)^4 * dot(gradient, offset), r0^2 is 1 in 1D and 1/2 in 2D and 3D */
+        template <typename F>
+        inline F simplex1(F x, uint32_t seed) {
+            using I = int_t<F>;
+            auto s  = I(seed);
+            auto fx = floor(x);
+            auto x0 = x - fx;
+            auto x1 = x0 - F(1.f);
+            auto ix = to_int(fx) * I(prime_x);
+
+            auto t0 = F(1.f) - x0 * x0;
+            auto t1 = F(1.f) - x1 * x1;
+            t0      = t0 * t0;
+            t1      = t1 * t1;
+            auto n  = t0 * t0 * grad(hash(s, ix), x0) + t1 * t1 * grad(hash(s, ix + I(prime_x)), x1);
+            return scale_clamped(n, 3.15f);
+        }
+
+        template <typename F>
+        inline F simplex2(F x, F y, uint32_t seed) {
+            using I            = int_t<F>;
+            constexpr float f2 = 0.36602540378f; /* (sqrt(3) - 1) / 2 */
+            constexpr float g2 = 0.21132486540f; /* (3 - sqrt(3)) / 6 */
+
+            auto s    = I(seed);
+            auto skew = (x + y) * F(f2);
+            auto fi   = floor(x + skew);
+            auto fj   = floor(y + skew);
+            auto t    = (fi + fj) * F(g2);
+            auto x0   = x - (fi - t);
+            auto y0   = y - (fj - t);
+
+            /* Lower or upper triangle of the skewed cell */
+            auto lower = x0 > y0;
+            auto i1    = select(lower, F(1.f), F(0.f));
+            auto x1    = x0 - i1 + F(g2);
+            auto y1    = y0 - (F(1.f) - i1) + F(g2);
+            auto x2    = x0 - F(1.f - 2.f * g2);
+            auto y2    = y0 - F(1.f - 2.f * g2);
+
+            auto ix = to_int(fi) * I(prime_x);
+            auto iy = to_int(fj) * I(prime_y);
+            auto h0 = hash(s, ix ^ iy);
+            auto h1 = hash(s, select(lower, ix + I(prime_x), ix) ^ select(lower, iy, iy + I(prime_y)));
+            auto h2 = hash(s, (ix + I(prime_x)) ^ (iy + I(prime_y)));
+
+            auto corner = [](I h, F cx, F cy) {
+                auto c = max(F(0.5f) - cx * cx - cy * cy, F(0.f));
+                c      = c * c;
+                return c * c * grad(h, cx, cy);
+            };
+            return scale_clamped(corner(h0, x0, y0) + corner(h1, x1, y1) + corner(h2, x2, y2), 70.f);
+        }
+
+        template <typename F>
+        inline F simplex3(F x, F y, F z, uint32_t seed) {
+            using I            = int_t<F>;
+            constexpr float g3 = 1.f / 6.f;
+
+            auto s    = I(seed);
+            auto skew = (x + y + z) * F(1.f / 3.f);
+            auto fi   = floor(x + skew);
+            auto fj   = floor(y + skew);
+            auto fk   = floor(z + skew);
+            auto t    = (fi + fj + fk) * F(g3);
+            auto x0   = x - (fi - t);
+            auto y0   = y - (fj - t);
+            auto z0   = z - (fk - t);
+
+            /* Second corner steps along the largest offset, third along the two largest */
+            auto x_ge_y = x0 >= y0;
+            auto y_ge_z = y0 >= z0;
+            auto x_ge_z = x0 >= z0;
+            auto i1     = x_ge_y & x_ge_z;
+            auto j1     = andnot(x_ge_y, y_ge_z);
+            auto k1     = !(x_ge_z | y_ge_z);
+            auto i2     = x_ge_y | x_ge_z;
+            auto j2     = !andnot(y_ge_z, x_ge_y);
+            auto k2     = !(y_ge_z & x_ge_z);
+
+            auto one = F(1.f);
+            auto x1  = x0 - select(i1, one, F(0.f)) + F(g3);
+            auto y1  = y0 - select(j1, one, F(0.f)) + F(g3);
+            auto z1  = z0 - select(k1, one, F(0.f)) + F(g3);
+            auto x2  = x0 - select(i2, one, F(0.f)) + F(2.f * g3);
+            auto y2  = y0 - select(j2, one, F(0.f)) + F(2.f * g3);
+            auto z2  = z0 - select(k2, one, F(0.f)) + F(2.f * g3);
+            auto x3  = x0 - F(1.f - 3.f * g3);
+            auto y3  = y0 - F(1.f - 3.f * g3);
+            auto z3  = z0 - F(1.f - 3.f * g3);
+
+            auto ix  = to_int(fi) * I(prime_x);
+            auto iy  = to_int(fj) * I(prime_y);
+            auto iz  = to_int(fk) * I(prime_z);
+            auto ix1 = ix + I(prime_x);
+            auto iy1 = iy + I(prime_y);
+            auto iz1 = iz + I(prime_z);
+            auto h0  = hash(s, ix ^ iy ^ iz);
+            auto h1  = hash(s, select(i1, ix1, ix) ^ select(j1, iy1, iy) ^ select(k1, iz1, iz));
+            auto h2  = hash(s, select(i2, ix1, ix) ^ select(j2, iy1, iy) ^ select(k2, iz1, iz));
+            auto h3  = hash(s, ix1 ^ iy1 ^ iz1);
+
+            auto corner = [](I h, F cx, F cy, F cz) {
+                auto c = max(F(0.5f) - cx * cx - cy * cy - cz * cz, F(0.f));
+                c      = c * c;
+                return c * c * grad(h, cx, cy, cz);
+            };
+            auto n = corner(h0, x0, y0, z0) + corner(h1, x1, y1, z1) + corner(h2, x2, y2, z2) + corner(h3, x3, y3, z3);
+            return scale_clamped(n, 62.f);
+        }
+
+        /* Exact in binary, coordinates below 2^16 keep the step */
+        inline constexpr float curl_step = 1.f / 64.f;
+
+        template <typename F>
+        inline void curl2(F x, F y, uint32_t seed, F& cx, F& cy) {
+            auto e  = F(curl_step);
+            auto dx = simplex2(x + e, y, seed) - simplex2(x - e, y, seed);
+            auto dy = simplex2(x, y + e, seed) - simplex2(x, y - e, seed);
+            cx      = dy * F(0.5f / curl_step);
+            cy      = F(0.f) - dx * F(0.5f / curl_step);
+        }
+
+        /* Curl of the potential made of three simplex fields with different seeds */
+        template <typename F>
+        inline void curl3(F x, F y, F z, uint32_t seed, F& cx, F& cy, F& cz) {
+            auto e = F(curl_step);
+            auto s = [seed](uint32_t idx) { return seed ^ (idx * 0x9e3779b9u); };
+
+            auto d = [&](uint32_t idx, F ex, F ey, F ez) {
+                return simplex3(x + ex, y + ey, z + ez, s(idx)) - simplex3(x - ex, y - ey, z - ez, s(idx));
+            };
+            auto zero = F(0.f);
+            auto k    = F(0.5f / curl_step);
+            cx        = (d(2, zero, e, zero) - d(1, zero, zero, e)) * k;
+            cy        = (d(0, zero, zero, e) - d(2, e, zero, zero)) * k;
+            cz        = (d(1, e, zero, zero) - d(0, zero, e, zero)) * k;
+        }
+
+        template <typename K>
+        inline void run(std::span<const float> xs, std::span<float> out, K&& kernel) {
+            size_t i = 0;
+#ifdef CORE_VEC_SSE
+            for (; i + 4 <= xs.size(); i += 4) _mm_storeu_ps(&out[i], f4(kernel(f4(_mm_loadu_ps(&xs[i])))).v);
+#endif
+            for (; i < xs.size(); ++i) out[i] = kernel(xs[i]);
+        }
+
+        template <typename K>
+        inline void run(std::span<const float> xs, std::span<const float> ys, std::span<float> out, K&& kernel) {
+            size_t i = 0;
+#ifdef CORE_VEC_SSE
+            for (; i + 4 <= xs.size(); i += 4)
+                _mm_storeu_ps(&out[i], f4(kernel(f4(_mm_loadu_ps(&xs[i])), f4(_mm_loadu_ps(&ys[i])))).v);
+#endif
+            for (; i < xs.size(); ++i) out[i] = kernel(xs[i], ys[i]);
+        }
+
+        template <typename K>
+        inline void run(std::span<const float> xs,
+                        std::span<const float> ys,
+                        std::span<const float> zs,
+                        std::span<float>       out,
+                        K&&                    kernel) {
+            size_t i = 0;
+#ifdef CORE_VEC_SSE
+            for (; i + 4 <= xs.size(); i += 4) {
+                auto r = kernel(f4(_mm_loadu_ps(&xs[i])), f4(_mm_loadu_ps(&ys[i])), f4(_mm_loadu_ps(&zs[i])));
+                _mm_storeu_ps(&out[i], f4(r).v);
+            }
+#endif
+            for (; i < xs.size(); ++i) out[i] = kernel(xs[i], ys[i], zs[i]);
+        }
+    } // namespace detail
+
+    inline float value(float x, uint32_t seed = 0) {
+        return detail::value1(x, seed);
+    }
+
+    inline float value(const vec2f& p, uint32_t seed = 0) {
+        return detail::value2(p.x(), p.y(), seed);
+    }
+
+    inline float value(const vec3f& p, uint32_t seed = 0) {
+        return detail::value3(p.x(), p.y(), p.z(), seed);
+    }
+
+    inline float perlin(float x, uint32_t seed = 0) {
+        return detail::perlin1(x, seed);
+    }
+
+    inline float perlin(const vec2f& p, uint32_t seed = 0) {
+        return detail::perlin2(p.x(), p.y(), seed);
+    }
+
+    inline float perlin(const vec3f& p, uint32_t seed = 0) {
+        return detail::perlin3(p.x(), p.y(), p.z(), seed);
+    }
+
+    inline float simplex(float x, uint32_t seed = 0) {
+        return detail::simplex1(x, seed);
+    }
+
+    inline float simplex(const vec2f& p, uint32_t seed = 0) {
+        return detail::simplex2(p.x(), p.y(), seed);
+    }
+
+    inline float simplex(const vec3f& p, uint32_t seed = 0) {
+        return detail::simplex3(p.x(), p.y(), p.z(), seed);
+    }
+
+    inline vec2f curl(const vec2f& p, uint32_t seed = 0) {
+        vec2f result;
+        detail::curl2(p.x(), p.y(), seed, result.x(), result.y());
+        return result;
+    }
+
+    inline vec3f curl(const vec3f& p, uint32_t seed = 0) {
+        vec3f result;
+        detail::curl3(p.x(), p.y(), p.z(), seed, result.x(), result.y(), result.z());
+        return result;
+    }
+
+    /* Sums octaves of a noise function of float, vec2f or vec3f, each with doubled frequency and halved amplitude */
+    template <typename F, typename P>
+    inline float fractal(F&& noise, const P& p, size_t octaves, uint32_t seed = 0) {
+        float sum       = 0.f;
+        float amplitude = 1.f;
+        float norm      = 0.f;
+        P     q         = p;
+        for (size_t i = 0; i < octaves; ++i) {
+            sum += noise(q, seed + uint32_t(i)) * amplitude;
+            norm += amplitude;
+            amplitude *= 0.5f;
+            q = q * 2.f;
+        }
+        return norm > 0.f ? sum / norm : 0.f;
+    }
+
+    /* Span variants on coordinates in separate arrays as vec2_soa keeps them, out should be at least as long */
+    inline void value(std::span<const float> xs, std::span<float> out, uint32_t seed = 0) {
+        detail::run(xs, out, [seed](auto x) { return detail::value1(x, seed); });
+    }
+
+    inline void value(std::span<const float> xs, std::span<const float> ys, std::span<float> out, uint32_t seed = 0) {
+        detail::run(xs, ys, out, [seed](auto x, auto y) { return detail::value2(x, y, seed); });
+    }
+
+    inline void value(std::span<const float> xs,
+                      std::span<const float> ys,
+                      std::span<const float> zs,
+                      std::span<float>       out,
+                      uint32_t               seed = 0) {
+        detail::run(xs, ys, zs, out, [seed](auto x, auto y, auto z) { return detail::value3(x, y, z, seed); });
+    }
+
+    inline void perlin(std::span<const float> xs, std::span<float> out, uint32_t seed = 0) {
+        detail::run(xs, out, [seed](auto x) { return detail::perlin1(x, seed); });
+    }
+
+    inline void perlin(std::span<const float> xs, std::span<const float> ys, std::span<float> out, uint32_t seed = 0) {
+        detail::run(xs, ys, out, [seed](auto x, auto y) { return detail::perlin2(x, y, seed); });
+    }
+
+    inline void perlin(std::span<const float> xs,
+                       std::span<const float> ys,
+                       std::span<const float> zs,
+                       std::span<float>       out,
+                       uint32_t               seed = 0) {
+        detail::run(xs, ys, zs, out, [seed](auto x, auto y, auto z) { return detail::perlin3(x, y, z, seed); });
+    }
+
+    inline void simplex(std::span<const float> xs, std::span<float> out, uint32_t seed = 0) {
+        detail::run(xs, out, [seed](auto x) { return detail::simplex1(x, seed); });
+    }
+
+    inline void simplex(std::span<const float> xs, std::span<const float> ys, std::span<float> out, uint32_t seed = 0) {
+        detail::run(xs, ys, out, [seed](auto x, auto y) { return detail::simplex2(x, y, seed); });
+    }
+
+    inline void simplex(std::span<const float> xs,
+                        std::span<const float> ys,
+                        std::span<const float> zs,
+                        std::span<float>       out,
+                        uint32_t               seed = 0) {
+        detail::run(xs, ys, zs, out, [seed](auto x, auto y, auto z) { return detail::simplex3(x, y, z, seed); });
+    }
+
+    inline void curl(std::span<const float> xs,
+                     std::span<const float> ys,
+                     std::span<float>       out_xs,
+                     std::span<float>       out_ys,
+                     uint32_t               seed = 0) {
+        size_t i = 0;
+#ifdef CORE_VEC_SSE
+        for (; i + 4 <= xs.size(); i += 4) {
+            detail::f4 cx = 0.f, cy = 0.f;
+            detail::curl2(detail::f4(_mm_loadu_ps(&xs[i])), detail::f4(_mm_loadu_ps(&ys[i])), seed, cx, cy);
+            _mm_storeu_ps(&out_xs[i], cx.v);
+            _mm_storeu_ps(&out_ys[i], cy.v);
+        }
+#endif
+        for (; i < xs.size(); ++i) detail::curl2(xs[i], ys[i], seed, out_xs[i], out_ys[i]);
+    }
+
+    inline void curl(std::span<const float> xs,
+                     std::span<const float> ys,
+                     std::span<const float> zs,
+                     std::span<float>       out_xs,
+                     std::span<float>       out_ys,
+                     std::span<float>       out_zs,
+                     uint32_t               seed = 0) {
+        size_t i = 0;
+#ifdef CORE_VEC_SSE
+        for (; i + 4 <= xs.size(); i += 4) {
+            detail::f4 cx = 0.f, cy = 0.f, cz = 0.f;
+            detail::curl3(detail::f4(_mm_loadu_ps(&xs[i])),
+                          detail::f4(_mm_loadu_ps(&ys[i])),
+                          detail::f4(_mm_loadu_ps(&zs[i])),
+                          seed,
+                          cx,
+                          cy,
+                          cz);
+            _mm_storeu_ps(&out_xs[i], cx.v);
+            _mm_storeu_ps(&out_ys[i], cy.v);
+            _mm_storeu_ps(&out_zs[i], cz.v);
+        }
+#endif
+        for (; i < xs.size(); ++i) detail::curl3(xs[i], ys[i], zs[i], seed, out_xs[i], out_ys[i], out_zs[i]);
+    }
+} // namespace noise
+} // namespace core
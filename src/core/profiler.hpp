@@ -0,0 +1,281 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace core
+{
+/*
+ * Scoped zones recorded during frame captures and exported as Chrome trace JSON (chrome://tracing, Perfetto)
+ *
+ * request_capture() starts recording at the next frame() and stops after the requested number of frames,
+ * frame() is called once per frame by the main loop. Outside of a capture a zone costs one relaxed atomic load
+ * Each thread writes its zones to its own ring buffer without locks, a buffer keeps the last ring_capacity zones,
+ * so longer captures lose their oldest zones. Buffers are allocated at the first zone a thread records in a capture
+ * and kept until exit, so zones of finished threads are exported too
+ * Zone names are interned once, see CORE_PROFILE_ZONE
+ */
+class profiler {
+public:
+    using zone_id_t = uint32_t;
+
+    static constexpr size_t ring_capacity = 1 << 16;
+
+    static profiler& instance() {
+        static profiler p;
+        return p;
+    }
+
+    /* Same id for the same name, thread-safe */
+    zone_id_t intern(std::string_view name) {
+        std::lock_guard lock{mtx};
+        auto [found, inserted] = zone_ids.emplace(std::string(name), zone_id_t(zone_names.size()));
+        if (inserted)
+            zone_names.push_back(&found->first);
+        return found->second;
+    }
+
+    bool capturing() const {
+        return active.load(std::memory_order_relaxed);
+    }
+
+    /* Starts at the next frame(), a capture in progress is finished first */
+    void request_capture(size_t frames_count = 1) {
+        requested.store(std::max<size_t>(frames_count, 1));
+    }
+
+    /* Frame boundary, from one thread only */
+    void frame() {
+        auto time = now();
+
+        std::lock_guard lock{mtx};
+        if (active.load(std::memory_order_relaxed)) {
+            frame_marks.push_back(time);
+            if (frame_marks.size() > capture_frames) {
+                active.store(false, std::memory_order_relaxed);
+                capture_end = time;
+                finished.store(true);
+            }
+        }
+        else if (auto frames_count = requested.exchange(0)) {
+            capture_frames = frames_count;
+            capture_begin  = time;
+            capture_end    = time;
+            frame_marks.assign(1, time);
+            finished.store(false);
+            active.store(true, std::memory_order_relaxed);
+        }
+    }
+
+    /* True once after each finished capture */
+    bool take_finished_capture() {
+        return finished.exchange(false);
+    }
+
+    uint64_t now() const {
+        return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(clock_t::now() - epoch).count());
+    }
+
+    /* Called by profile_zone */
+    void record(zone_id_t zone, uint64_t begin, uint64_t end) {
+        thread_local thread_buffer* buffer = register_thread();
+        buffer->push({zone, begin, end});
+    }
+
+    /* Zones and frames of the last finished capture, timestamps in microseconds from its beginning */
+    void write_chrome_trace(std::ostream& os) const {
+        std::lock_guard lock{mtx};
+
+        auto write_us = [&](uint64_t ns) {
+            char str[32];
+            std::snprintf(str, sizeof(str), "%.3f", double(ns) / 1000.);
+            os << str;
+        };
+
+        os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        bool first = true;
+        auto next  = [&] {
+            if (!first)
+                os << ",";
+            first = false;
+        };
+
+        for (size_t i = 0; i + 1 < frame_marks.size(); ++i) {
+            next();
+            os << "{\"name\":\"frame " << i << "\",\"ph\":\"X\",\"pid\":1,\"tid\":0,\"ts\":";
+            write_us(frame_marks[i] - capture_begin);
+            os << ",\"dur\":";
+            write_us(frame_marks[i + 1] - frame_marks[i]);
+            os << "}";
+        }
+
+        std::vector<event> events;
+        for (auto&& buffer : buffers) {
+            buffer->snapshot(events);
+            for (auto&& e : events) {
+                if (e.begin < capture_begin || e.end > capture_end || e.end < e.begin)
+                    continue;
+                next();
+                os << "{\"name\":";
+                write_string(os, *zone_names[e.zone]);
+                os << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->tid << ",\"ts\":";
+                write_us(e.begin - capture_begin);
+                os << ",\"dur\":";
+                write_us(e.end - e.begin);
+                os << "}";
+            }
+        }
+
+        os << "]}" << std::endl;
+    }
+
+    bool save_chrome_trace(const std::string& path) const {
+        std::ofstream ofs(path);
+        write_chrome_trace(ofs);
+        return bool(ofs);
+    }
+
+private:
+    using clock_t = std::chrono::steady_clock;
+
+    struct event {
+        zone_id_t zone;
+        uint64_t  begin;
+        uint64_t  end;
+    };
+
+    /*
+     * Written by its thread only while write_chrome_trace may read it, so slots are relaxed atomics:
+     * the writer fences before overwriting a slot and the reader fences before checking written again,
+     * entries of slots the writer may have reached meanwhile are dropped
+     */
+    struct thread_buffer {
+        thread_buffer(uint32_t itid): slots(std::make_unique<slot_t[]>(ring_capacity)), tid(itid) {}
+
+        void push(const event& e) {
+            auto  pos  = written.load(std::memory_order_relaxed);
+            auto& slot = slots[pos % ring_capacity];
+
+            std::atomic_thread_fence(std::memory_order_release);
+            slot.zone.store(e.zone, std::memory_order_relaxed);
+            slot.begin.store(e.begin, std::memory_order_relaxed);
+            slot.end.store(e.end, std::memory_order_relaxed);
+            written.store(pos + 1, std::memory_order_release);
+        }
+
+        void snapshot(std::vector<event>& out) const {
+            auto end   = written.load(std::memory_order_acquire);
+            auto begin = end > ring_capacity ? end - ring_capacity : 0;
+            out.clear();
+            for (auto pos = begin; pos < end; ++pos) {
+                auto& slot = slots[pos % ring_capacity];
+                out.push_back({slot.zone.load(std::memory_order_relaxed),
+                               slot.begin.load(std::memory_order_relaxed),
+                               slot.end.load(std::memory_order_relaxed)});
+            }
+
+            /* Slot of position pos is rewritten from the time written reaches pos + ring_capacity */
+            std::atomic_thread_fence(std::memory_order_acquire);
+            auto now_written = written.load(std::memory_order_relaxed);
+            if (now_written >= begin + ring_capacity)
+                out.erase(out.begin(),
+                          out.begin() + std::min<size_t>(now_written - begin - ring_capacity + 1, out.size()));
+        }
+
+        struct slot_t {
+            std::atomic<zone_id_t> zone  = 0;
+            std::atomic<uint64_t>  begin = 0;
+            std::atomic<uint64_t>  end   = 0;
+        };
+
+        std::unique_ptr<slot_t[]> slots;
+        std::atomic<uint64_t>     written = 0;
+        uint32_t                  tid;
+    };
+
+    profiler() = default;
+
+    thread_buffer* register_thread() {
+        std::lock_guard lock{mtx};
+        buffers.push_back(std::make_unique<thread_buffer>(uint32_t(buffers.size() + 1)));
+        return buffers.back().get();
+    }
+
+    static void write_string(std::ostream& os, const std::string& str) {
+        os << '"';
+        for (unsigned char c : str) {
+            if (c == '"' || c == '\\')
+                os << '\\' << c;
+            else if (c < 0x20) {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                os << escaped;
+            }
+            else
+                os << c;
+        }
+        os << '"';
+    }
+
+private:
+    mutable std::mutex                            mtx;
+    std::map<std::string, zone_id_t, std::less<>> zone_ids;
+    std::vector<const std::string*>               zone_names;
+    std::deque<std::unique_ptr<thread_buffer>>    buffers;
+    std::vector<uint64_t>                         frame_marks;
+    clock_t::time_point                           epoch          = clock_t::now();
+    uint64_t                                      capture_begin  = 0;
+    uint64_t                                      capture_end    = 0;
+    size_t                                        capture_frames = 0;
+    std::atomic<size_t>                           requested      = 0;
+    std::atomic<bool>                             active         = false;
+    std::atomic<bool>                             finished       = false;
+};
+
+/* Records the time from construction to destruction if a capture is running when constructed */
+class profile_zone {
+public:
+    profile_zone(profiler::zone_id_t izone): zone(izone) {
+        if (profiler::instance().capturing()) {
+            begin = profiler::instance().now();
+            armed = true;
+        }
+    }
+
+    profile_zone(const profile_zone&)            = delete;
+    profile_zone& operator=(const profile_zone&) = delete;
+
+    ~profile_zone() {
+        if (armed) {
+            auto& p = profiler::instance();
+            p.record(zone, begin, p.now());
+        }
+    }
+
+private:
+    profiler::zone_id_t zone;
+    uint64_t            begin = 0;
+    bool                armed = false;
+};
+} // namespace core
+
+#define CORE_PROFILE_CONCAT_IMPL(a, b) a##b
+#define CORE_PROFILE_CONCAT(a, b)      CORE_PROFILE_CONCAT_IMPL(a, b)
+
+/* Zone until the end of the enclosing scope, the name is interned on first use */
+#define CORE_PROFILE_ZONE(name)                                                                                        \
+    static const auto CORE_PROFILE_CONCAT(profile_zone_id_, __LINE__) = core::profiler::instance().intern(name);      \
+    core::profile_zone CORE_PROFILE_CONCAT(profile_zone_, __LINE__) {                                                  \
+        CORE_PROFILE_CONCAT(profile_zone_id_, __LINE__)                                                                \
+    }
@@ -0,0 +1,274 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "hash.hpp"
+#include "mapped_file.hpp"
+
+namespace core
+{
+/*
+ * Pack file layout, all values are native-endian:
+ *   header: magic "FDPK", version, entries count, string table size
+ *   index sorted by path: offset, size, content hash, path offset and size in the string table
+ *   string table
+ *   blobs, each starts at resource_pack_alignment
+ * Paths are stored as given to the packer in lexically normal generic form, lookups normalize the same way
+ */
+inline constexpr std::array<char, 4> resource_pack_magic     = {'F', 'D', 'P', 'K'};
+inline constexpr uint32_t            resource_pack_version   = 1;
+inline constexpr uint64_t            resource_pack_alignment = 64;
+
+struct resource_pack_header {
+    std::array<char, 4> magic;
+    uint32_t            version;
+    uint32_t            count;
+    uint32_t            strings_size;
+};
+
+struct resource_pack_index_entry {
+    uint64_t offset;
+    uint64_t size;
+    uint64_t hash;
+    uint32_t path_offset;
+    uint32_t path_size;
+};
+
+inline std::string normalize_resource_path(const std::string& path) {
+    return std::filesystem::path(path).lexically_normal().generic_string();
+}
+
+/*
+ * Read-only pack of resources mapped into memory, lookups return views into the mapping
+ * Immutable after open, so lookups are thread-safe
+ */
+class resource_pack {
+public:
+    struct entry_t {
+        std::string_view           path;
+        std::span<const std::byte> bytes;
+        uint64_t                   hash;
+    };
+
+    resource_pack() = default;
+
+    resource_pack(const std::string& path) {
+        open(path);
+    }
+
+    resource_pack(const resource_pack&)            = delete;
+    resource_pack& operator=(const resource_pack&) = delete;
+
+    /* Returns false if the file is missing or broken, the pack stays empty then */
+    bool open(const std::string& path) {
+        entries.clear();
+        if (!file.open(path) || !read_index()) {
+            entries.clear();
+            file.close();
+            return false;
+        }
+        return true;
+    }
+
+    bool is_open() const {
+        return file.is_open();
+    }
+
+    const entry_t* find(const std::string& path) const {
+        auto normalized = normalize_resource_path(path);
+        auto found      = std::lower_bound(
+            entries.begin(), entries.end(), normalized, [](auto&& entry, auto&& key) { return entry.path < key; });
+        if (found == entries.end() || found->path != normalized)
+            return nullptr;
+        return &*found;
+    }
+
+    /* Paths of entries inside the directory and its subdirectories */
+    std::vector<std::string> list(const std::string& dir_path) const {
+        auto prefix = normalize_resource_path(dir_path);
+        if (!prefix.empty() && prefix.back() != '/')
+            prefix += '/';
+
+        std::vector<std::string> paths;
+        for (auto&& entry : entries)
+            if (entry.path.starts_with(prefix))
+                paths.emplace_back(entry.path);
+        return paths;
+    }
+
+    const std::vector<entry_t>& get_entries() const {
+        return entries;
+    }
+
+private:
+    bool read_index() {
+        auto bytes = file.bytes();
+
+        resource_pack_header header;
+        if (bytes.size() < sizeof(header))
+            return false;
+        std::memcpy(&header, bytes.data(), sizeof(header));
+        if (header.magic != resource_pack_magic || header.version != resource_pack_version)
+            return false;
+
+        auto index_size   = uint64_t(header.count) * sizeof(resource_pack_index_entry);
+        auto strings_base = sizeof(header) + index_size;
+        if (bytes.size() < strings_base + header.strings_size)
+            return false;
+
+        entries.reserve(header.count);
+        for (uint32_t i = 0; i < header.count; ++i) {
+            resource_pack_index_entry index;
+            std::memcpy(&index, bytes.data() + sizeof(header) + i * sizeof(index), sizeof(index));
+
+            if (uint64_t(index.path_offset) + index.path_size > header.strings_size || index.offset > bytes.size() ||
+                index.size > bytes.size() - index.offset)
+                return false;
+
+            auto path = std::string_view(reinterpret_cast<const char*>(bytes.data() + strings_base + index.path_offset),
+                                         index.path_size);
+            if (!entries.empty() && entries.back().path >= path)
+                return false;
+
+            entries.push_back({path, bytes.subspan(index.offset, index.size), index.hash});
+        }
+        return true;
+    }
+
+private:
+    mapped_file          file;
+    std::vector<entry_t> entries;
+};
+
+/*
+ * Collects resources and writes a pack file
+ */
+class resource_pack_writer {
+public:
+    void add(const std::string& path, std::span<const std::byte> bytes) {
+        items.push_back({normalize_resource_path(path), {bytes.begin(), bytes.end()}});
+    }
+
+    bool add_file(const std::string& path) {
+        mapped_file source;
+        if (!source.open(path))
+            return false;
+        add(path, source.bytes());
+        return true;
+    }
+
+    /* Later additions of the same path replace earlier ones */
+    bool save(const std::string& path) {
+        std::stable_sort(items.begin(), items.end(), [](auto&& a, auto&& b) { return a.path < b.path; });
+        auto last = std::unique(items.rbegin(), items.rend(), [](auto&& a, auto&& b) { return a.path == b.path; });
+        items.erase(items.begin(), last.base());
+
+        std::string strings;
+        for (auto&& item : items) strings += item.path;
+
+        resource_pack_header header{resource_pack_magic, resource_pack_version, uint32_t(items.size()),
+                                    uint32_t(strings.size())};
+
+        auto index_size = items.size() * sizeof(resource_pack_index_entry);
+
+        std::vector<resource_pack_index_entry> index;
+        uint64_t                               offset      = align(sizeof(header) + index_size + strings.size());
+        uint32_t                               path_offset = 0;
+        for (auto&& item : items) {
+            index.push_back({offset, item.data.size(), fnv1a64(item.data), path_offset, uint32_t(item.path.size())});
+            offset = align(offset + item.data.size());
+            path_offset += uint32_t(item.path.size());
+        }
+
+        std::ofstream ofs(path, std::ios::binary);
+        ofs.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        ofs.write(reinterpret_cast<const char*>(index.data()), std::streamsize(index.size() * sizeof(index[0])));
+        ofs.write(strings.data(), std::streamsize(strings.size()));
+
+        for (size_t i = 0; i < items.size(); ++i) {
+            pad(ofs, index[i].offset);
+            ofs.write(reinterpret_cast<const char*>(items[i].data.data()), std::streamsize(items[i].data.size()));
+        }
+        return bool(ofs);
+    }
+
+    size_t size() const {
+        return items.size();
+    }
+
+private:
+    struct item_t {
+        std::string            path;
+        std::vector<std::byte> data;
+    };
+
+    static uint64_t align(uint64_t offset) {
+        return (offset + resource_pack_alignment - 1) / resource_pack_alignment * resource_pack_alignment;
+    }
+
+    static void pad(std::ofstream& ofs, uint64_t offset) {
+        static constexpr std::array<char, resource_pack_alignment> zeros{};
+        auto padding = offset - uint64_t(ofs.tellp());
+        ofs.write(zeros.data(), std::streamsize(padding));
+    }
+
+private:
+    std::vector<item_t> items;
+};
+
+/*
+ * Bytes of one resource, a view into a pack or a mapped loose file
+ */
+class resource_data {
+public:
+    /* The pack is looked up first, the loose file is the fallback, the pack may be nullptr */
+    bool open(const resource_pack* pack, const std::string& path) {
+        file.close();
+        view = {};
+        hash.reset();
+
+        if (pack) {
+            if (auto entry = pack->find(path)) {
+                view = entry->bytes;
+                hash = entry->hash;
+                return true;
+            }
+        }
+
+        if (!file.open(path))
+            return false;
+        view = file.bytes();
+        return true;
+    }
+
+    std::span<const std::byte> bytes() const {
+        return view;
+    }
+
+    const std::byte* data() const {
+        return view.data();
+    }
+
+    size_t size() const {
+        return view.size();
+    }
+
+    /* Content hash recorded by the packer, loose files have none */
+    std::optional<uint64_t> get_pack_hash() const {
+        return hash;
+    }
+
+private:
+    mapped_file                file;
+    std::span<const std::byte> view;
+    std::optional<uint64_t>    hash;
+};
+} // namespace core
@@ -0,0 +1,78 @@
+#pragma once
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace core
+{
+/*
+ * Fixed set of worker threads consuming one FIFO queue
+ * Pending tasks are finished before the pool is destroyed
+ */
+class thread_pool {
+public:
+    thread_pool(size_t threads_count = std::thread::hardware_concurrency()) {
+        threads_count = std::max<size_t>(threads_count, 1);
+        workers.reserve(threads_count);
+        for (size_t i = 0; i < threads_count; ++i) workers.emplace_back([this] { work(); });
+    }
+
+    thread_pool(const thread_pool&)            = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    ~thread_pool() {
+        {
+            std::lock_guard lock{mtx};
+            stopping = true;
+        }
+        cv.notify_all();
+    }
+
+    template <typename F>
+    auto submit(F&& task) -> std::future<std::invoke_result_t<std::decay_t<F>>> {
+        std::packaged_task<std::invoke_result_t<std::decay_t<F>>()> packaged(std::forward<F>(task));
+        auto                                                        result = packaged.get_future();
+
+        {
+            std::lock_guard lock{mtx};
+            tasks.emplace_back(std::move(packaged));
+        }
+        cv.notify_one();
+
+        return result;
+    }
+
+    size_t size() const {
+        return workers.size();
+    }
+
+private:
+    void work() {
+        while (true) {
+            std::move_only_function<void()> task;
+            {
+                std::unique_lock lock{mtx};
+                cv.wait(lock, [this] { return stopping || !tasks.empty(); });
+                if (tasks.empty())
+                    return;
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            task();
+        }
+    }
+
+private:
+    std::mutex                                  mtx;
+    std::condition_variable                     cv;
+    std::deque<std::move_only_function<void()>> tasks;
+    bool                                        stopping = false;
+    std::vector<std::jthread>                   workers;
+};
+} // namespace core
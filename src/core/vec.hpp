@@ -9,6 +9,7 @@
 #include "floating_point.hpp"
 #include "concepts.hpp"
 #include "vec_macro_gen.hpp"
+#include "vec_simd.hpp"
 
 #include <SFML/System/Vector2.hpp>
 #include <SFML/System/Vector3.hpp>
@@ -80,7 +81,9 @@ inline A vec_magnitude_2(const std::array<A, sizeof...(Idxs)>& a, std::index_seq
 
 template <typename A, size_t Size>
 inline A vec_magnitude(const std::array<A, Size>& a) {
-    if constexpr (sizeof(A) == 4)
+    if constexpr (vec_simd_float<A, Size>)
+        return vec_simd_magnitude(a);
+    else if constexpr (sizeof(A) == 4)
         return sqrtf(vec_magnitude_2(a, std::make_index_sequence<Size>()));
     else
         return sqrt(vec_magnitude_2(a, std::make_index_sequence<Size>()));
@@ -89,14 +92,26 @@ inline A vec_magnitude(const std::array<A, Size>& a) {
 template <typename A, size_t... Idxs>
 inline std::array<A, sizeof...(Idxs)>
 vec_normalize(const std::array<A, sizeof...(Idxs)>& a, std::index_sequence<Idxs...>&&) {
-    auto magnitude = vec_magnitude(a);
-    return std::array{(std::get<Idxs>(a) / magnitude)...};
+    if constexpr (vec_simd_float<A, sizeof...(Idxs)>) {
+        std::array<A, sizeof...(Idxs)> result;
+        vec_simd_normalize<sizeof...(Idxs)>(a.data(), result.data());
+        return result;
+    }
+    else {
+        auto magnitude = vec_magnitude(a);
+        return std::array{(std::get<Idxs>(a) / magnitude)...};
+    }
 }
 
 template <typename A, size_t... Idxs>
 inline void vec_fetch_normalize(std::array<A, sizeof...(Idxs)>& a, std::index_sequence<Idxs...>&&) {
-    auto magnitude = vec_magnitude(a);
-    ((std::get<Idxs>(a) /= magnitude), ...);
+    if constexpr (vec_simd_float<A, sizeof...(Idxs)>) {
+        vec_simd_normalize<sizeof...(Idxs)>(a.data(), a.data());
+    }
+    else {
+        auto magnitude = vec_magnitude(a);
+        ((std::get<Idxs>(a) /= magnitude), ...);
+    }
 }
 
 template <typename A, typename B, size_t... Idxs>
@@ -0,0 +1,327 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "aligned_allocator.hpp"
+#include "vec.hpp"
+#include "vec_batch.hpp"
+
+namespace core
+{
+/*
+ * Reference to one element of vec2_soa, reads and writes go to the x and y arrays
+ * Assignment writes the values and never rebinds, arithmetic gives plain vec2
+ */
+template <typename T>
+class vec2_soa_ref {
+public:
+    vec2_soa_ref(T& ix, T& iy): px(&ix), py(&iy) {}
+    vec2_soa_ref(const vec2_soa_ref&) = default;
+
+    vec2_soa_ref& operator=(const vec2_soa_ref& ref) {
+        return *this = ref.get();
+    }
+
+    vec2_soa_ref& operator=(const vec2<T>& value) {
+        *px = value.x();
+        *py = value.y();
+        return *this;
+    }
+
+    vec2_soa_ref& operator=(const sf::Vector2<T>& value) {
+        return *this = vec2<T>(value);
+    }
+
+    vec2<T> get() const {
+        return {*px, *py};
+    }
+
+    operator vec2<T>() const {
+        return get();
+    }
+
+    operator sf::Vector2<T>() const {
+        return {*px, *py};
+    }
+
+    T& x() const {
+        return *px;
+    }
+
+    T& y() const {
+        return *py;
+    }
+
+    void x(T value) const {
+        *px = value;
+    }
+
+    void y(T value) const {
+        *py = value;
+    }
+
+    vec2_soa_ref& operator+=(const vec2<T>& value) {
+        *px += value.x();
+        *py += value.y();
+        return *this;
+    }
+
+    vec2_soa_ref& operator-=(const vec2<T>& value) {
+        *px -= value.x();
+        *py -= value.y();
+        return *this;
+    }
+
+    vec2_soa_ref& operator*=(T scale) {
+        *px *= scale;
+        *py *= scale;
+        return *this;
+    }
+
+    vec2_soa_ref& operator/=(T scale) {
+        *px /= scale;
+        *py /= scale;
+        return *this;
+    }
+
+    vec2<T> operator-() const {
+        return -get();
+    }
+
+    vec2<T> operator+(const vec2<T>& value) const {
+        return get() + value;
+    }
+
+    vec2<T> operator-(const vec2<T>& value) const {
+        return get() - value;
+    }
+
+    vec2<T> operator*(T scale) const {
+        return get() * scale;
+    }
+
+    vec2<T> operator/(T scale) const {
+        return get() / scale;
+    }
+
+    T dot(const vec2<T>& value) const {
+        return get().dot(value);
+    }
+
+    T magnitude_2() const {
+        return get().magnitude_2();
+    }
+
+    T magnitude() const
+        requires std::floating_point<T>
+    {
+        return get().magnitude();
+    }
+
+    vec2<T> normalize() const
+        requires std::floating_point<T>
+    {
+        return get().normalize();
+    }
+
+private:
+    T* px;
+    T* py;
+};
+
+/*
+ * Array of 2D vectors with x and y in separate aligned arrays, for loops over many positions or velocities
+ * Elements are accessed by proxies, xs() and ys() give the arrays to SIMD kernels,
+ * bulk operations on float vectors run the kernels of vec_batch.hpp over both arrays
+ */
+template <typename T>
+class vec2_soa {
+public:
+    using value_type      = vec2<T>;
+    using reference       = vec2_soa_ref<T>;
+    using const_reference = vec2<T>;
+    using array_t         = std::vector<T, aligned_allocator<T>>;
+
+    template <bool Const>
+    class iterator_t {
+    public:
+        using owner_t = std::conditional_t<Const, const vec2_soa, vec2_soa>;
+
+        iterator_t(owner_t* iowner, size_t iidx): owner(iowner), idx(iidx) {}
+
+        decltype(auto) operator*() const {
+            return (*owner)[idx];
+        }
+
+        iterator_t& operator++() {
+            ++idx;
+            return *this;
+        }
+
+        iterator_t operator++(int) {
+            auto result = *this;
+            ++idx;
+            return result;
+        }
+
+        ptrdiff_t operator-(const iterator_t& iterator) const {
+            return ptrdiff_t(idx) - ptrdiff_t(iterator.idx);
+        }
+
+        bool operator==(const iterator_t& iterator) const {
+            return idx == iterator.idx;
+        }
+
+    private:
+        owner_t* owner;
+        size_t   idx;
+    };
+
+    using iterator       = iterator_t<false>;
+    using const_iterator = iterator_t<true>;
+
+    vec2_soa() = default;
+
+    explicit vec2_soa(size_t count, const vec2<T>& value = {0, 0}):
+        x_values(count, value.x()), y_values(count, value.y()) {}
+
+    vec2_soa(std::span<const vec2<T>> values) {
+        reserve(values.size());
+        for (auto&& value : values) push_back(value);
+    }
+
+    size_t size() const {
+        return x_values.size();
+    }
+
+    bool empty() const {
+        return x_values.empty();
+    }
+
+    void reserve(size_t count) {
+        x_values.reserve(count);
+        y_values.reserve(count);
+    }
+
+    void resize(size_t count, const vec2<T>& value = {0, 0}) {
+        x_values.resize(count, value.x());
+        y_values.resize(count, value.y());
+    }
+
+    void clear() {
+        x_values.clear();
+        y_values.clear();
+    }
+
+    void push_back(const vec2<T>& value) {
+        x_values.push_back(value.x());
+        y_values.push_back(value.y());
+    }
+
+    reference operator[](size_t idx) {
+        return {x_values[idx], y_values[idx]};
+    }
+
+    const_reference operator[](size_t idx) const {
+        return {x_values[idx], y_values[idx]};
+    }
+
+    iterator begin() {
+        return {this, 0};
+    }
+
+    iterator end() {
+        return {this, size()};
+    }
+
+    const_iterator begin() const {
+        return {this, 0};
+    }
+
+    const_iterator end() const {
+        return {this, size()};
+    }
+
+    std::span<T> xs() {
+        return x_values;
+    }
+
+    std::span<const T> xs() const {
+        return x_values;
+    }
+
+    std::span<T> ys() {
+        return y_values;
+    }
+
+    std::span<const T> ys() const {
+        return y_values;
+    }
+
+    void fill(const vec2<T>& value) {
+        std::fill(x_values.begin(), x_values.end(), value.x());
+        std::fill(y_values.begin(), y_values.end(), value.y());
+    }
+
+    /* Bulk operations, the other array should be at least as long */
+    vec2_soa& operator+=(const vec2_soa& other) {
+        if constexpr (std::is_same_v<T, float>) {
+            batch_add_floats(x_values.data(), other.x_values.data(), x_values.data(), size());
+            batch_add_floats(y_values.data(), other.y_values.data(), y_values.data(), size());
+        }
+        else {
+            for (size_t i = 0; i < size(); ++i) {
+                x_values[i] += other.x_values[i];
+                y_values[i] += other.y_values[i];
+            }
+        }
+        return *this;
+    }
+
+    vec2_soa& operator*=(T scale) {
+        if constexpr (std::is_same_v<T, float>) {
+            batch_scale_floats(x_values.data(), scale, x_values.data(), size());
+            batch_scale_floats(y_values.data(), scale, y_values.data(), size());
+        }
+        else {
+            for (auto&& value : x_values) value *= scale;
+            for (auto&& value : y_values) value *= scale;
+        }
+        return *this;
+    }
+
+    /* this += other * scale, moves positions by velocities or velocities by accelerations */
+    void add_scaled(const vec2_soa& other, T scale) {
+        if constexpr (std::is_same_v<T, float>) {
+            batch_add_scaled_floats(x_values.data(), other.x_values.data(), scale, x_values.data(), size());
+            batch_add_scaled_floats(y_values.data(), other.y_values.data(), scale, y_values.data(), size());
+        }
+        else {
+            for (size_t i = 0; i < size(); ++i) {
+                x_values[i] += other.x_values[i] * scale;
+                y_values[i] += other.y_values[i] * scale;
+            }
+        }
+    }
+
+    vec2<T> sum() const {
+        if constexpr (std::is_same_v<T, float>) {
+            return {batch_sum_floats(x_values.data(), size()), batch_sum_floats(y_values.data(), size())};
+        }
+        else {
+            vec2<T> result{0, 0};
+            for (size_t i = 0; i < size(); ++i) result += vec2<T>{x_values[i], y_values[i]};
+            return result;
+        }
+    }
+
+private:
+    array_t x_values;
+    array_t y_values;
+};
+
+using vec2f_soa = vec2_soa<float>;
+} // namespace core
@@ -0,0 +1,241 @@
+#pragma once
+#include <cmath>
+#include <span>
+
+#include "vec.hpp"
+
+namespace core
+{
+/*
+ * Operations over spans of float vectors, SSE on x86-64, AVX for lane-wise ones and rotation with ENABLE_AVX
+ * out.size() vectors are processed, inputs should be at least as long, out may be the same span as an input
+ * Containers are converted to spans when S is given: batch_add<2>(positions, velocities, positions)
+ * Results match the per-vector operators and core::lerp, rotation matches x * cos - y * sin, x * sin + y * cos
+ */
+template <size_t S>
+inline const float* vec_batch_floats(std::span<const vec<float, S>> vectors) {
+    static_assert(sizeof(vec<float, S>) == sizeof(float) * S);
+    return vectors.empty() ? nullptr : vectors.front().v.data();
+}
+
+template <size_t S>
+inline float* vec_batch_floats(std::span<vec<float, S>> vectors) {
+    static_assert(sizeof(vec<float, S>) == sizeof(float) * S);
+    return vectors.empty() ? nullptr : vectors.front().v.data();
+}
+
+/* Lane-wise kernels over float arrays, shared by vector spans and vec2_soa components */
+inline void batch_add_floats(const float* a, const float* b, float* out, size_t n) {
+    size_t i = 0;
+#ifdef __AVX__
+    for (; i + 8 <= n; i += 8) _mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+#endif
+#ifdef CORE_VEC_SSE
+    for (; i + 4 <= n; i += 4) _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+#endif
+    for (; i < n; ++i) out[i] = a[i] + b[i];
+}
+
+inline void batch_scale_floats(const float* a, float scale, float* out, size_t n) {
+    size_t i = 0;
+#ifdef __AVX__
+    auto scale8 = _mm256_set1_ps(scale);
+    for (; i + 8 <= n; i += 8) _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_loadu_ps(a + i), scale8));
+#endif
+#ifdef CORE_VEC_SSE
+    auto scale4 = _mm_set1_ps(scale);
+    for (; i + 4 <= n; i += 4) _mm_storeu_ps(out + i, _mm_mul_ps(_mm_loadu_ps(a + i), scale4));
+#endif
+    for (; i < n; ++i) out[i] = a[i] * scale;
+}
+
+/* a + b * scale, the step of explicit integration */
+inline void batch_add_scaled_floats(const float* a, const float* b, float scale, float* out, size_t n) {
+    size_t i = 0;
+#ifdef __AVX__
+    auto scale8 = _mm256_set1_ps(scale);
+    for (; i + 8 <= n; i += 8)
+        _mm256_storeu_ps(out + i,
+                         _mm256_add_ps(_mm256_loadu_ps(a + i), _mm256_mul_ps(_mm256_loadu_ps(b + i), scale8)));
+#endif
+#ifdef CORE_VEC_SSE
+    auto scale4 = _mm_set1_ps(scale);
+    for (; i + 4 <= n; i += 4)
+        _mm_storeu_ps(out + i, _mm_add_ps(_mm_loadu_ps(a + i), _mm_mul_ps(_mm_loadu_ps(b + i), scale4)));
+#endif
+    for (; i < n; ++i) out[i] = a[i] + b[i] * scale;
+}
+
+/* a * (1 - t) + b * t as core::lerp */
+inline void batch_lerp_floats(const float* a, const float* b, float t, float* out, size_t n) {
+    auto inv_t = 1.f - t;
+
+    size_t i = 0;
+#ifdef __AVX__
+    auto t8     = _mm256_set1_ps(t);
+    auto inv_t8 = _mm256_set1_ps(inv_t);
+    for (; i + 8 <= n; i += 8)
+        _mm256_storeu_ps(out + i,
+                         _mm256_add_ps(_mm256_mul_ps(_mm256_loadu_ps(a + i), inv_t8),
+                                       _mm256_mul_ps(_mm256_loadu_ps(b + i), t8)));
+#endif
+#ifdef CORE_VEC_SSE
+    auto t4     = _mm_set1_ps(t);
+    auto inv_t4 = _mm_set1_ps(inv_t);
+    for (; i + 4 <= n; i += 4)
+        _mm_storeu_ps(out + i,
+                      _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(a + i), inv_t4), _mm_mul_ps(_mm_loadu_ps(b + i), t4)));
+#endif
+    for (; i < n; ++i) out[i] = a[i] * inv_t + b[i] * t;
+}
+
+/* Summed in four lanes, the order differs from a sequential sum */
+inline float batch_sum_floats(const float* a, size_t n) {
+    size_t i   = 0;
+    float  sum = 0.f;
+#ifdef CORE_VEC_SSE
+    auto sum4 = _mm_setzero_ps();
+    for (; i + 4 <= n; i += 4) sum4 = _mm_add_ps(sum4, _mm_loadu_ps(a + i));
+    sum4 = _mm_add_ps(sum4, _mm_movehl_ps(sum4, sum4));
+    sum  = _mm_cvtss_f32(_mm_add_ss(sum4, _mm_shuffle_ps(sum4, sum4, _MM_SHUFFLE(1, 1, 1, 1))));
+#endif
+    for (; i < n; ++i) sum += a[i];
+    return sum;
+}
+
+template <size_t S>
+void batch_add(std::span<const vec<float, S>> a, std::span<const vec<float, S>> b, std::span<vec<float, S>> out) {
+    batch_add_floats(vec_batch_floats(a), vec_batch_floats(b), vec_batch_floats(out), out.size() * S);
+}
+
+template <size_t S>
+void batch_scale(std::span<const vec<float, S>> a, float scale, std::span<vec<float, S>> out) {
+    batch_scale_floats(vec_batch_floats(a), scale, vec_batch_floats(out), out.size() * S);
+}
+
+template <size_t S>
+void batch_lerp(std::span<const vec<float, S>> a,
+                std::span<const vec<float, S>> b,
+                float                          t,
+                std::span<vec<float, S>>       out) {
+    batch_lerp_floats(vec_batch_floats(a), vec_batch_floats(b), t, vec_batch_floats(out), out.size() * S);
+}
+
+/* 3 component vectors are not packed in whole registers, they go one by one */
+template <size_t S>
+void batch_dot(std::span<const vec<float, S>> a, std::span<const vec<float, S>> b, std::span<float> out) {
+    auto pa = vec_batch_floats(a);
+    auto pb = vec_batch_floats(b);
+    auto n  = out.size();
+
+    size_t i = 0;
+#ifdef CORE_VEC_SSE
+    if constexpr (S == 2) {
+        /* Four vectors in two registers, products of x and y are separated by shuffles and summed */
+        for (; i + 4 <= n; i += 4) {
+            auto p0 = _mm_mul_ps(_mm_loadu_ps(pa + i * 2), _mm_loadu_ps(pb + i * 2));
+            auto p1 = _mm_mul_ps(_mm_loadu_ps(pa + i * 2 + 4), _mm_loadu_ps(pb + i * 2 + 4));
+            _mm_storeu_ps(out.data() + i,
+                          _mm_add_ps(_mm_shuffle_ps(p0, p1, _MM_SHUFFLE(2, 0, 2, 0)),
+                                     _mm_shuffle_ps(p0, p1, _MM_SHUFFLE(3, 1, 3, 1))));
+        }
+    }
+    else if constexpr (S == 4) {
+        for (; i + 4 <= n; i += 4) {
+            auto p0 = _mm_mul_ps(_mm_loadu_ps(pa + i * 4), _mm_loadu_ps(pb + i * 4));
+            auto p1 = _mm_mul_ps(_mm_loadu_ps(pa + i * 4 + 4), _mm_loadu_ps(pb + i * 4 + 4));
+            auto p2 = _mm_mul_ps(_mm_loadu_ps(pa + i * 4 + 8), _mm_loadu_ps(pb + i * 4 + 8));
+            auto p3 = _mm_mul_ps(_mm_loadu_ps(pa + i * 4 + 12), _mm_loadu_ps(pb + i * 4 + 12));
+            _MM_TRANSPOSE4_PS(p0, p1, p2, p3);
+            _mm_storeu_ps(out.data() + i, _mm_add_ps(_mm_add_ps(p0, p1), _mm_add_ps(p2, p3)));
+        }
+    }
+#endif
+    for (; i < n; ++i) out[i] = a[i].dot(b[i]);
+}
+
+template <size_t S>
+void batch_normalize(std::span<const vec<float, S>> a, std::span<vec<float, S>> out) {
+    auto pa = vec_batch_floats(a);
+    auto po = vec_batch_floats(out);
+    auto n  = out.size();
+
+    size_t i = 0;
+#ifdef CORE_VEC_SSE
+    if constexpr (S == 2) {
+        /* Magnitudes of four vectors in one register, then spread back to x and y lanes */
+        for (; i + 4 <= n; i += 4) {
+            auto v0         = _mm_loadu_ps(pa + i * 2);
+            auto v1         = _mm_loadu_ps(pa + i * 2 + 4);
+            auto p0         = _mm_mul_ps(v0, v0);
+            auto p1         = _mm_mul_ps(v1, v1);
+            auto magnitudes = _mm_sqrt_ps(_mm_add_ps(_mm_shuffle_ps(p0, p1, _MM_SHUFFLE(2, 0, 2, 0)),
+                                                     _mm_shuffle_ps(p0, p1, _MM_SHUFFLE(3, 1, 3, 1))));
+            _mm_storeu_ps(po + i * 2, _mm_div_ps(v0, _mm_unpacklo_ps(magnitudes, magnitudes)));
+            _mm_storeu_ps(po + i * 2 + 4, _mm_div_ps(v1, _mm_unpackhi_ps(magnitudes, magnitudes)));
+        }
+    }
+    else if constexpr (S == 4) {
+        /* One square root for four vectors, each is divided by its broadcasted magnitude */
+        for (; i + 4 <= n; i += 4) {
+            auto v0 = _mm_loadu_ps(pa + i * 4);
+            auto v1 = _mm_loadu_ps(pa + i * 4 + 4);
+            auto v2 = _mm_loadu_ps(pa + i * 4 + 8);
+            auto v3 = _mm_loadu_ps(pa + i * 4 + 12);
+            auto p0 = _mm_mul_ps(v0, v0);
+            auto p1 = _mm_mul_ps(v1, v1);
+            auto p2 = _mm_mul_ps(v2, v2);
+            auto p3 = _mm_mul_ps(v3, v3);
+            _MM_TRANSPOSE4_PS(p0, p1, p2, p3);
+
+            auto magnitudes = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(p0, p1), _mm_add_ps(p2, p3)));
+            auto m0         = _mm_shuffle_ps(magnitudes, magnitudes, _MM_SHUFFLE(0, 0, 0, 0));
+            auto m1         = _mm_shuffle_ps(magnitudes, magnitudes, _MM_SHUFFLE(1, 1, 1, 1));
+            auto m2         = _mm_shuffle_ps(magnitudes, magnitudes, _MM_SHUFFLE(2, 2, 2, 2));
+            auto m3         = _mm_shuffle_ps(magnitudes, magnitudes, _MM_SHUFFLE(3, 3, 3, 3));
+            _mm_storeu_ps(po + i * 4, _mm_div_ps(v0, m0));
+            _mm_storeu_ps(po + i * 4 + 4, _mm_div_ps(v1, m1));
+            _mm_storeu_ps(po + i * 4 + 8, _mm_div_ps(v2, m2));
+            _mm_storeu_ps(po + i * 4 + 12, _mm_div_ps(v3, m3));
+        }
+    }
+#endif
+    for (; i < n; ++i) vec_simd_normalize<S>(pa + i * S, po + i * S);
+}
+
+/* Rotates by the angle in radians counterclockwise in math axes, clockwise on screen with y down */
+inline void batch_rotate(std::span<const vec2f> a, float angle, std::span<vec2f> out) {
+    auto pa    = vec_batch_floats(a);
+    auto po    = vec_batch_floats(out);
+    auto n     = out.size() * 2;
+    auto cos_a = std::cos(angle);
+    auto sin_a = std::sin(angle);
+
+    /* (x, y) * cos + (y, x) * (-sin, sin) */
+    size_t i = 0;
+#ifdef __AVX__
+    auto cos8 = _mm256_set1_ps(cos_a);
+    auto sin8 = _mm256_setr_ps(-sin_a, sin_a, -sin_a, sin_a, -sin_a, sin_a, -sin_a, sin_a);
+    for (; i + 8 <= n; i += 8) {
+        auto v = _mm256_loadu_ps(pa + i);
+        auto s = _mm256_permute_ps(v, _MM_SHUFFLE(2, 3, 0, 1));
+        _mm256_storeu_ps(po + i, _mm256_add_ps(_mm256_mul_ps(v, cos8), _mm256_mul_ps(s, sin8)));
+    }
+#endif
+#ifdef CORE_VEC_SSE
+    auto cos4 = _mm_set1_ps(cos_a);
+    auto sin4 = _mm_setr_ps(-sin_a, sin_a, -sin_a, sin_a);
+    for (; i + 4 <= n; i += 4) {
+        auto v = _mm_loadu_ps(pa + i);
+        auto s = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+        _mm_storeu_ps(po + i, _mm_add_ps(_mm_mul_ps(v, cos4), _mm_mul_ps(s, sin4)));
+    }
+#endif
+    for (; i < n; i += 2) {
+        auto x    = pa[i];
+        auto y    = pa[i + 1];
+        po[i]     = x * cos_a - y * sin_a;
+        po[i + 1] = x * sin_a + y * cos_a;
+    }
+}
+} // namespace core
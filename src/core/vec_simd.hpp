@@ -0,0 +1,85 @@
+#pragma once
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CORE_VEC_SSE 1
+#include <immintrin.h>
+#endif
+
+namespace core
+{
+/*
+ * SSE kernels for float vectors of 2, 3 and 4 components, used by vec and the batch operations
+ * Vectors are loaded into the low lanes of one register, unused lanes are zero
+ * Results are the same as of the scalar code except the summation order of 3 and 4 component dot products
+ */
+template <typename T, size_t S>
+inline constexpr bool vec_simd_float =
+#ifdef CORE_VEC_SSE
+    std::is_same_v<T, float> && S >= 2 && S <= 4;
+#else
+    false;
+#endif
+
+#ifdef CORE_VEC_SSE
+template <size_t S>
+inline __m128 vec_simd_load(const float* p) {
+    if constexpr (S == 2)
+        return _mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)));
+    else if constexpr (S == 3)
+        return _mm_movelh_ps(vec_simd_load<2>(p), _mm_load_ss(p + 2));
+    else
+        return _mm_loadu_ps(p);
+}
+
+template <size_t S>
+inline void vec_simd_store(float* p, __m128 value) {
+    if constexpr (S == 2) {
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm_castps_si128(value));
+    }
+    else if constexpr (S == 3) {
+        vec_simd_store<2>(p, value);
+        _mm_store_ss(p + 2, _mm_movehl_ps(value, value));
+    }
+    else {
+        _mm_storeu_ps(p, value);
+    }
+}
+
+/* Dot product of all four lanes in every lane */
+inline __m128 vec_simd_dot(__m128 a, __m128 b) {
+    auto products = _mm_mul_ps(a, b);
+    auto pairs    = _mm_add_ps(products, _mm_shuffle_ps(products, products, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_add_ps(pairs, _mm_shuffle_ps(pairs, pairs, _MM_SHUFFLE(1, 0, 3, 2)));
+}
+#endif
+
+template <size_t S>
+inline float vec_simd_magnitude(const std::array<float, S>& a) {
+#ifdef CORE_VEC_SSE
+    auto v = vec_simd_load<S>(a.data());
+    return _mm_cvtss_f32(_mm_sqrt_ss(vec_simd_dot(v, v)));
+#else
+    float sum = 0.f;
+    for (auto value : a) sum += value * value;
+    return std::sqrt(sum);
+#endif
+}
+
+/* Divides by the magnitude as the scalar code does, zero vectors become NaN the same way */
+template <size_t S>
+inline void vec_simd_normalize(const float* in, float* out) {
+#ifdef CORE_VEC_SSE
+    auto v = vec_simd_load<S>(in);
+    vec_simd_store<S>(out, _mm_div_ps(v, _mm_sqrt_ps(vec_simd_dot(v, v))));
+#else
+    float sum = 0.f;
+    for (size_t i = 0; i < S; ++i) sum += in[i] * in[i];
+    auto magnitude = std::sqrt(sum);
+    for (size_t i = 0; i < S; ++i) out[i] = in[i] / magnitude;
+#endif
+}
+} // namespace core
@@ -1,12 +1,21 @@
 #pragma once
 
+#include <algorithm>
 #include <functional>
 #include <list>
+#include <memory>
 
+#include "core/fastmath.hpp"
 #include "core/math.hpp"
+#include "core/noise.hpp"
+#include "core/profiler.hpp"
 #include "core/vec.hpp"
+#include "core/vec2_soa.hpp"
 #include "keyframe_animation.hpp"
+#include "keyframe_compression.hpp"
+#include "path_animation.hpp"
 #include "scene.hpp"
+#include "texture_mgr.hpp"
 
 namespace grx
 {
@@ -17,6 +26,19 @@ struct efx_state {
     float               time_elapsed;
     float               time_elapsed_coef;
     uint32_t            idx;
+
+    /* Set in the call made to displacement handlers before the other handlers run, see efx_displacement */
+    bool restoring = false;
+};
+
+/*
+ * Marks a handler which offsets elements from where the other handlers put them, as turbulence
+ * In each update it is called with state.restoring set before the other handlers, to take its offset back,
+ * then again after all of them, so it composes with absolute setters as position and path too
+ */
+template <typename F>
+struct efx_displacement {
+    F function;
 };
 
 class efx {
@@ -48,7 +70,26 @@ public:
             return affected_indices;
         }
 
+        /* Profiler zone of the handler updates, "efx/handler/<name>" for handlers added by name */
+        void set_zone(core::profiler::zone_id_t value) {
+            zone = value;
+        }
+
+        core::profiler::zone_id_t get_zone() const {
+            return zone;
+        }
+
+        void set_displacement(bool value = true) {
+            displacement = value;
+        }
+
+        bool is_displacement() const {
+            return displacement;
+        }
+
         void operator()(auto& drawables, efx_state state) {
+            core::profile_zone profile{zone};
+
             if (affects_all) {
                 for (size_t idx = 0; idx < drawables.size(); ++idx) {
                     state.idx = idx;
@@ -63,31 +104,52 @@ public:
             }
         }
 
+    private:
+        static core::profiler::zone_id_t default_zone() {
+            static auto zone = core::profiler::instance().intern("efx/handler");
+            return zone;
+        }
+
     private:
         std::vector<index_t>                               affected_indices;
         std::function<void(drawable_t&, const efx_state&)> handler;
-        bool                                               affects_all = true;
+        core::profiler::zone_id_t                          zone         = default_zone();
+        bool                                               displacement = false;
+        bool                                               affects_all  = true;
     };
 
     template <typename F>
     handler_t& add_handler(const std::string& name, F&& function) {
-        return handlers
-            .insert_or_assign(name,
-                              [f = std::forward<F>(function)](drawable_t& drawable, const efx_state& state) mutable {
-                                  downcast(drawable, std::forward<F>(f), state);
-                              })
-            .first->second;
+        auto [found, _] = handlers.insert_or_assign(
+            name, [f = std::forward<F>(function)](drawable_t& drawable, const efx_state& state) mutable {
+                downcast(drawable, std::forward<F>(f), state);
+            });
+        found->second.set_zone(core::profiler::instance().intern("efx/handler/" + name));
+        aliases.erase(name);
+        return found->second;
+    }
+
+    template <typename F>
+    handler_t& add_handler(const std::string& name, efx_displacement<F> displacement) {
+        auto& handler = add_handler(name, std::move(displacement.function));
+        handler.set_displacement();
+        return handler;
+    }
+
+    /* Another name get_handler finds the handler by, for one handler made of several animations */
+    void add_alias(const std::string& alias, const std::string& name) {
+        aliases.insert_or_assign(alias, name);
     }
 
     handler_t* get_handler(const std::string& name) {
-        auto bucket = handlers.find(name);
+        auto bucket = handlers.find(resolve(name));
         if (bucket == handlers.end())
             return nullptr;
         return &bucket->second;
     }
 
     const handler_t* get_handler(const std::string& name) const {
-        auto bucket = handlers.find(name);
+        auto bucket = handlers.find(resolve(name));
         if (bucket == handlers.end())
             return nullptr;
         return &bucket->second;
@@ -120,10 +182,23 @@ public:
         return elements.back();
     }
 
+    /* Keeps the texture used by elements resident while the prototype exists */
+    void hold_texture(texture_handle handle) {
+        textures.push_back(std::move(handle));
+    }
+
+private:
+    const std::string& resolve(const std::string& name) const {
+        auto alias = aliases.find(name);
+        return alias == aliases.end() ? name : alias->second;
+    }
+
 private:
-    std::vector<drawable_t>          elements;
-    std::map<std::string, handler_t> handlers;
-    float                            duration;
+    std::vector<drawable_t>            elements;
+    std::map<std::string, handler_t>   handlers;
+    std::map<std::string, std::string> aliases;
+    float                              duration;
+    std::vector<texture_handle>        textures;
 };
 
 static inline constexpr float duration_endless = std::numeric_limits<float>::infinity();
@@ -134,6 +209,12 @@ public:
         e(&iefx), batch(scene.create_batch(layer, e->get_elements())), duration(e->get_duration()) {
         batch.delete_later();
         for (auto&& [_, handler] : e->handlers) handlers.push_back(handler);
+        std::stable_partition(handlers.begin(), handlers.end(), [](auto&& h) { return !h.is_displacement(); });
+    }
+
+    /* Keeps the prototype alive until the instance is finished, even if it was replaced in efx_mgr */
+    efx_instance(scene& scene, scene::layer_t layer, std::shared_ptr<efx> iefx): efx_instance(scene, layer, *iefx) {
+        prototype = std::move(iefx);
     }
 
     void set_batch(const scene::batch_ref& ibatch) {
@@ -144,16 +225,23 @@ public:
         duration = value;
     }
 
+    /* Displacement handlers are sorted last, they take their offsets back before the others run */
     void update(float timestep) {
+        efx_state state{
+            .batch             = batch.get_pointer(),
+            .timestep          = timestep,
+            .timestep_coef     = timestep / duration,
+            .time_elapsed      = time_elapsed,
+            .time_elapsed_coef = time_elapsed / duration,
+            .idx               = 0,
+            .restoring         = true,
+        };
         for (auto&& handler : handlers)
-            handler(batch->get_elements(),
-                    {
-                        .batch             = batch.get_pointer(),
-                        .timestep          = timestep,
-                        .timestep_coef     = timestep / duration,
-                        .time_elapsed      = time_elapsed,
-                        .time_elapsed_coef = time_elapsed / duration,
-                    });
+            if (handler.is_displacement())
+                handler(batch->get_elements(), state);
+
+        state.restoring = false;
+        for (auto&& handler : handlers) handler(batch->get_elements(), state);
         time_elapsed += timestep;
     }
 
@@ -180,6 +268,7 @@ public:
 private:
     std::vector<efx::handler_t> handlers;
     efx*                        e;
+    std::shared_ptr<efx>        prototype;
     scene::batch_ref            batch;
     float                       duration;
     float                       time_elapsed = 0.f;
@@ -189,8 +278,14 @@ class efx_mgr {
 public:
     efx_mgr(scene& iscene): s(&iscene) {}
 
+    /* Replaces the prototype with the same name, running instances finish on the old one */
     void add_effect(const std::string& name, efx effect) {
-        effects.insert_or_assign(name, std::move(effect));
+        effects.insert_or_assign(name, std::make_shared<efx>(std::move(effect)));
+    }
+
+    efx* get_effect(const std::string& name) {
+        auto found = effects.find(name);
+        return found != effects.end() ? found->second.get() : nullptr;
     }
 
     bool play(const std::string& name,
@@ -210,6 +305,7 @@ public:
     }
 
     void update(float timestep) {
+        CORE_PROFILE_ZONE("efx_mgr::update");
         for (auto i = running_effects.begin(); i != running_effects.end();) {
             if (i->timeout())
                 running_effects.erase(i++);
@@ -218,34 +314,94 @@ public:
         }
     }
 
+    size_t get_instances_count() const {
+        return running_effects.size();
+    }
+
 private:
-    scene*                     s;
-    std::map<std::string, efx> effects;
-    std::list<efx_instance>    running_effects;
+    scene*                                      s;
+    std::map<std::string, std::shared_ptr<efx>> effects;
+    std::list<efx_instance>                     running_effects;
 };
 
+/* Handlers with heavy math per element take it, fast uses core::fastmath within its documented error */
+enum class efx_math { exact = 0, fast };
+
 namespace efx_handlers
 {
-    inline auto position(const anim_key_sequence<core::vec2f>& keys) {
+    inline auto position(const anim_keys_of<core::vec2f> auto& keys) {
         return [keys = keys](sf::Transformable& obj, const efx_state& state) {
             obj.setPosition(keys.lookup(state.time_elapsed_coef));
         };
     }
 
-    inline auto scale(const anim_key_sequence<core::vec2f>& keys) {
+    inline auto scale(const anim_keys_of<core::vec2f> auto& keys) {
         return [keys = keys](sf::Transformable& obj, const efx_state& state) {
             obj.setScale(keys.lookup(state.time_elapsed_coef));
         };
     }
 
-    inline auto rotation(const anim_key_sequence<float>& keys) {
+    inline auto rotation(const anim_keys_of<float> auto& keys) {
         return [keys = keys](sf::Transformable& obj, const efx_state& state) {
             obj.setRotation(keys.lookup(state.time_elapsed_coef));
         };
     }
 
-    inline auto gravity(const std::vector<float>& masses = {}, const std::vector<core::vec2f>& velocities = {}) {
-        return [masses = masses, velocities = velocities](sf::Transformable& obj, const efx_state& state) mutable {
+    /* Looks the track up once per frame, the sample is shared by all affected elements */
+    inline auto transform(const anim_transform_track& track) {
+        return [track = track, time = std::numeric_limits<float>::quiet_NaN(), sample = anim_transform{}](
+                   sf::Transformable& obj, const efx_state& state) mutable {
+            if (state.time_elapsed_coef != time) {
+                time   = state.time_elapsed_coef;
+                sample = track.lookup(time);
+            }
+
+            if (sample.position)
+                obj.setPosition(*sample.position);
+            if (sample.scale)
+                obj.setScale(*sample.scale);
+            if (sample.rotation)
+                obj.setRotation(*sample.rotation);
+        };
+    }
+
+    /*
+     * Moves elements along the path with constant speed over the effect duration, orient turns them along the
+     * tangent with rotation_offset degrees added. The path is looked up once per frame as in transform
+     */
+    inline auto path(const anim_path& path, bool orient = false, float rotation_offset = 0.f) {
+        return [path = path,
+                orient,
+                rotation_offset,
+                time   = std::numeric_limits<float>::quiet_NaN(),
+                sample = anim_path_sample{}](sf::Transformable& obj, const efx_state& state) mutable {
+            if (state.time_elapsed_coef != time) {
+                time = state.time_elapsed_coef;
+                if (orient)
+                    sample = path.lookup(time);
+                else
+                    sample.position = path.position(time);
+            }
+
+            obj.setPosition(sample.position);
+            if (orient)
+                obj.setRotation(sample.rotation + rotation_offset);
+        };
+    }
+
+    /*
+     * Bodies attract each other with their masses, positions are gathered once per update,
+     * so every body sees the others where they were at its start whatever the handler order is
+     */
+    inline auto gravity(const std::vector<float>&       masses     = {},
+                        const std::vector<core::vec2f>& velocities = {},
+                        efx_math                        math       = efx_math::exact) {
+        return [math,
+                masses     = masses,
+                velocities = core::vec2f_soa(velocities),
+                positions  = core::vec2f_soa(),
+                time       = std::numeric_limits<float>::quiet_NaN()](sf::Transformable& obj,
+                                                                      const efx_state&   state) mutable {
             auto  idx    = state.idx;
             auto& bodies = state.batch->get_elements();
 
@@ -254,21 +410,104 @@ namespace efx_handlers
             if (bodies.size() > velocities.size())
                 velocities.resize(bodies.size(), {0, 0});
 
+            if (state.time_elapsed != time) {
+                time = state.time_elapsed;
+                positions.resize(bodies.size());
+                for (size_t i = 0; i < bodies.size(); ++i)
+                    positions[i] = std::visit([](auto&& body) { return body.getPosition(); }, bodies[i]);
+            }
+
+            auto xs  = positions.xs();
+            auto ys  = positions.ys();
+            auto pos = positions[idx];
+
             core::vec2f accel{0, 0};
 
-            for (size_t i = 0; i < bodies.size(); ++i) {
-                if (i == idx)
-                    continue;
-                auto mass = masses[i];
-                auto pos  = std::visit([](auto&& obj) { return obj.getPosition(); }, bodies[i]);
-                auto dir  = core::vec2f(pos - obj.getPosition()).normalize();
-                accel += dir * mass;
+            /* Two loops around the body itself, so both have no branches */
+            auto attract = [&](size_t begin, size_t end, auto fast) {
+                float ax = 0.f;
+                float ay = 0.f;
+                for (size_t i = begin; i < end; ++i) {
+                    auto dx = xs[i] - pos.x();
+                    auto dy = ys[i] - pos.y();
+                    if constexpr (decltype(fast)::value) {
+                        auto scale = core::fastmath::rsqrt(dx * dx + dy * dy) * masses[i];
+                        ax += dx * scale;
+                        ay += dy * scale;
+                    }
+                    else {
+                        auto length = std::sqrt(dx * dx + dy * dy);
+                        ax += dx / length * masses[i];
+                        ay += dy / length * masses[i];
+                    }
+                }
+                accel += core::vec2f{ax, ay};
+            };
+            if (math == efx_math::fast) {
+                attract(0, idx, std::true_type{});
+                attract(idx + 1, bodies.size(), std::true_type{});
+            }
+            else {
+                attract(0, idx, std::false_type{});
+                attract(idx + 1, bodies.size(), std::false_type{});
+            }
+
+            velocities[idx] += accel * state.timestep;
+            obj.move(velocities[idx].get() * state.timestep);
+        };
+    }
+
+    /*
+     * Displaces elements by a 3D simplex noise field of their positions and time, for turbulence and wobble,
+     * frequency 0 gives all elements the same offset for screen shake. Each offset component is within amplitude
+     * A displacement handler, its offset is added to the position the other handlers give, whatever their names,
+     * offsets of all elements are evaluated at once per update by the SSE span functions
+     */
+    inline auto turbulence(float amplitude, float frequency = 0.01f, float speed = 1.f, uint32_t seed = 0) {
+        auto displace = [amplitude,
+                         frequency,
+                         speed,
+                         seed,
+                         xs      = std::vector<float>(),
+                         ys      = std::vector<float>(),
+                         zs      = std::vector<float>(),
+                         offsets = core::vec2f_soa(),
+                         applied = core::vec2f_soa(),
+                         time    = std::numeric_limits<float>::quiet_NaN()](sf::Transformable& obj,
+                                                                            const efx_state&   state) mutable {
+            auto  idx    = state.idx;
+            auto& bodies = state.batch->get_elements();
+
+            if (state.restoring) {
+                if (idx < applied.size()) {
+                    obj.move(-applied[idx].get());
+                    applied[idx] = core::vec2f{0.f, 0.f};
+                }
+                return;
+            }
+
+            if (state.time_elapsed != time) {
+                time = state.time_elapsed;
+                applied.resize(bodies.size());
+                offsets.resize(bodies.size());
+                xs.resize(bodies.size());
+                ys.resize(bodies.size());
+                zs.assign(bodies.size(), time * speed);
+                for (size_t i = 0; i < bodies.size(); ++i) {
+                    auto pos = core::vec2f(std::visit([](auto&& body) { return body.getPosition(); }, bodies[i]));
+                    xs[i]    = pos.x() * frequency;
+                    ys[i]    = pos.y() * frequency;
+                }
+                core::noise::simplex(xs, ys, zs, offsets.xs(), seed);
+                core::noise::simplex(xs, ys, zs, offsets.ys(), seed + 1);
+                offsets *= amplitude;
             }
 
-            auto& velocity = velocities[idx];
-            velocity += accel * state.timestep;
-            obj.move(velocity * state.timestep);
+            auto offset = offsets[idx].get();
+            obj.move(offset);
+            applied[idx] = offset;
         };
+        return efx_displacement{std::move(displace)};
     }
 }; // namespace efx_handlers
 } // namespace grx
@@ -0,0 +1,336 @@
+#pragma once
+
+#include <cstring>
+#include <fstream>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "core/mapped_file.hpp"
+#include "efx_desc.hpp"
+
+namespace grx::efx_editor
+{
+/*
+ * Compiled effect layout, all values are native-endian:
+ *   header: magic "FDFX", version, total size
+ *   name, duration
+ *   animations: name, type, apply_to_all, max_error flag and value, affected indices, raw anim_key array,
+ *               path points, closed, orient
+ *   textures: name, path, smooth, srgb, repeated, mipmap, variants
+ *   templates: name, type, mask of present fields, present fields in efx_template_field order
+ *   primitives: template names
+ * Strings and arrays are prefixed by uint32 length. Bump efx_binary_version on any layout change.
+ */
+inline constexpr std::array<char, 4> efx_binary_magic   = {'F', 'D', 'F', 'X'};
+inline constexpr uint32_t            efx_binary_version = 3;
+
+enum efx_template_field : uint16_t {
+    efx_template_field_texture     = 1 << 0,
+    efx_template_field_color       = 1 << 1,
+    efx_template_field_fill_color  = 1 << 2,
+    efx_template_field_source_rect = 1 << 3,
+    efx_template_field_position    = 1 << 4,
+    efx_template_field_size        = 1 << 5,
+    efx_template_field_origin      = 1 << 6,
+    efx_template_field_radius      = 1 << 7,
+    efx_template_field_rotation    = 1 << 8,
+    efx_template_field_point_count = 1 << 9,
+};
+
+class efx_binary_writer {
+public:
+    template <typename T>
+        requires std::is_trivially_copyable_v<T>
+    void put(const T& value) {
+        auto p = reinterpret_cast<const std::byte*>(&value);
+        data.insert(data.end(), p, p + sizeof(T));
+    }
+
+    template <typename T>
+        requires std::is_trivially_copyable_v<T>
+    void put_array(std::span<const T> values) {
+        put(uint32_t(values.size()));
+        auto p = reinterpret_cast<const std::byte*>(values.data());
+        data.insert(data.end(), p, p + values.size_bytes());
+    }
+
+    void put_string(const std::string& str) {
+        put_array(std::span<const char>(str));
+    }
+
+    template <typename T>
+    void put_optional(const std::optional<T>& value) {
+        if (value)
+            put(*value);
+    }
+
+    void write(const efx_desc& desc) {
+        put(efx_binary_magic);
+        put(efx_binary_version);
+        auto size_offset = data.size();
+        put(uint32_t(0));
+
+        put_string(desc.name);
+        put(desc.duration);
+
+        put(uint32_t(desc.animations.size()));
+        for (auto&& anim : desc.animations) {
+            put_string(anim.name);
+            put(anim.type);
+            put(uint8_t(anim.apply_to_all));
+            put(uint8_t(anim.max_error.has_value()));
+            put(anim.max_error.value_or(0.f));
+            put_array(std::span<const efx::handler_t::index_t>(anim.affected_indices));
+            std::visit([&](auto&& keys) { put_array(std::span(keys.get_keys())); }, anim.keys);
+            put_array(std::span<const vec2f>(anim.points));
+            put(uint8_t(anim.closed));
+            put(uint8_t(anim.orient));
+        }
+
+        put(uint32_t(desc.textures.size()));
+        for (auto&& texture : desc.textures) {
+            put_string(texture.name);
+            put_string(texture.def.path);
+            put(uint8_t(texture.def.smooth));
+            put(uint8_t(texture.def.srgb));
+            put(uint8_t(texture.def.repeated));
+            put(uint8_t(texture.def.mipmap));
+            put(texture.def.variants);
+        }
+
+        put(uint32_t(desc.templates.size()));
+        for (auto&& tmpl : desc.templates) {
+            put_string(tmpl.name);
+            put(tmpl.type);
+            put(template_fields(tmpl));
+            if (tmpl.texture)
+                put_string(*tmpl.texture);
+            put_optional(tmpl.color);
+            put_optional(tmpl.fill_color);
+            put_optional(tmpl.source_rect);
+            put_optional(tmpl.position);
+            put_optional(tmpl.size);
+            put_optional(tmpl.origin);
+            put_optional(tmpl.radius);
+            put_optional(tmpl.rotation);
+            put_optional(tmpl.point_count);
+        }
+
+        put(uint32_t(desc.primitives.size()));
+        for (auto&& primitive : desc.primitives) put_string(primitive);
+
+        auto size = uint32_t(data.size());
+        std::memcpy(data.data() + size_offset, &size, sizeof(size));
+    }
+
+    const std::vector<std::byte>& get_data() const {
+        return data;
+    }
+
+    bool save(const std::string& path) const {
+        std::ofstream ofs(path, std::ios::binary);
+        ofs.write(reinterpret_cast<const char*>(data.data()), std::streamsize(data.size()));
+        return bool(ofs);
+    }
+
+private:
+    static uint16_t template_fields(const efx_template_desc& tmpl) {
+        uint16_t fields = 0;
+        fields |= tmpl.texture ? efx_template_field_texture : 0;
+        fields |= tmpl.color ? efx_template_field_color : 0;
+        fields |= tmpl.fill_color ? efx_template_field_fill_color : 0;
+        fields |= tmpl.source_rect ? efx_template_field_source_rect : 0;
+        fields |= tmpl.position ? efx_template_field_position : 0;
+        fields |= tmpl.size ? efx_template_field_size : 0;
+        fields |= tmpl.origin ? efx_template_field_origin : 0;
+        fields |= tmpl.radius ? efx_template_field_radius : 0;
+        fields |= tmpl.rotation ? efx_template_field_rotation : 0;
+        fields |= tmpl.point_count ? efx_template_field_point_count : 0;
+        return fields;
+    }
+
+private:
+    std::vector<std::byte> data;
+};
+
+class efx_binary_reader {
+public:
+    efx_binary_reader(std::span<const std::byte> idata): data(idata) {}
+
+    template <typename T>
+        requires std::is_trivially_copyable_v<T>
+    T get() {
+        T value;
+        std::memcpy(&value, take(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    template <typename T>
+    std::span<const std::byte> get_array_bytes() {
+        auto count = get<uint32_t>();
+        return {take(size_t(count) * sizeof(T)), size_t(count) * sizeof(T)};
+    }
+
+    std::string get_string() {
+        auto bytes = get_array_bytes<char>();
+        return {reinterpret_cast<const char*>(bytes.data()), bytes.size()};
+    }
+
+    template <typename T>
+    void get_optional(std::optional<T>& value, uint16_t fields, uint16_t field) {
+        if (fields & field)
+            value = get<T>();
+    }
+
+    /* Enums are range-checked, a corrupted value must not select keys of the wrong type or a missing branch */
+    template <typename T>
+        requires std::is_enum_v<T>
+    T get_enum(T last, const char* name) {
+        auto value = get<T>();
+        check_enum(value, last, name);
+        return value;
+    }
+
+    template <typename T>
+    static void check_enum(T value, T last, const char* name) {
+        auto raw = std::to_underlying(value);
+        if (std::cmp_less(raw, 0) || std::cmp_greater(raw, std::to_underlying(last)))
+            throw efx_builder_error("Invalid " + std::string(name) + " " + std::to_string(raw) + " in binary effect");
+    }
+
+    efx_desc read() {
+        auto magic = get<std::array<char, 4>>();
+        if (magic != efx_binary_magic)
+            throw efx_builder_error("Invalid binary effect magic");
+
+        auto version = get<uint32_t>();
+        if (version != efx_binary_version)
+            throw efx_builder_error("Unsupported binary effect version " + std::to_string(version));
+
+        auto size = get<uint32_t>();
+        if (size > data.size())
+            throw efx_builder_error("Truncated binary effect");
+        data = data.first(size);
+
+        efx_desc desc;
+        desc.name     = get_string();
+        desc.duration = get<float>();
+
+        desc.animations.resize(get<uint32_t>());
+        for (auto&& anim : desc.animations) {
+            anim.name         = get_string();
+            anim.type         = get_enum(efx_anim_type::path, "animation type");
+            anim.apply_to_all = get<uint8_t>();
+
+            auto has_max_error = get<uint8_t>();
+            auto max_error     = get<float>();
+            if (has_max_error)
+                anim.max_error = max_error;
+
+            auto indices = get_array_bytes<efx::handler_t::index_t>();
+            anim.affected_indices.resize(indices.size() / sizeof(efx::handler_t::index_t));
+            std::memcpy(anim.affected_indices.data(), indices.data(), indices.size());
+
+            if (anim.type == efx_anim_type::rotation)
+                anim.keys = read_keys<float>();
+            else
+                anim.keys = read_keys<vec2f>();
+
+            auto points = get_array_bytes<vec2f>();
+            anim.points.resize(points.size() / sizeof(vec2f));
+            std::memcpy(anim.points.data(), points.data(), points.size());
+            anim.closed = get<uint8_t>();
+            anim.orient = get<uint8_t>();
+        }
+
+        desc.textures.resize(get<uint32_t>());
+        for (auto&& texture : desc.textures) {
+            texture.name         = get_string();
+            texture.def.path     = get_string();
+            texture.def.smooth   = get<uint8_t>();
+            texture.def.srgb     = get<uint8_t>();
+            texture.def.repeated = get<uint8_t>();
+            texture.def.mipmap   = get<uint8_t>();
+            texture.def.variants = get<uint32_t>();
+        }
+
+        desc.templates.resize(get<uint32_t>());
+        for (auto&& tmpl : desc.templates) {
+            tmpl.name   = get_string();
+            tmpl.type   = get_enum(efx_template_type::rect, "template type");
+            auto fields = get<uint16_t>();
+            if (fields & efx_template_field_texture)
+                tmpl.texture = get_string();
+            get_optional(tmpl.color, fields, efx_template_field_color);
+            get_optional(tmpl.fill_color, fields, efx_template_field_fill_color);
+            get_optional(tmpl.source_rect, fields, efx_template_field_source_rect);
+            get_optional(tmpl.position, fields, efx_template_field_position);
+            get_optional(tmpl.size, fields, efx_template_field_size);
+            get_optional(tmpl.origin, fields, efx_template_field_origin);
+            get_optional(tmpl.radius, fields, efx_template_field_radius);
+            get_optional(tmpl.rotation, fields, efx_template_field_rotation);
+            get_optional(tmpl.point_count, fields, efx_template_field_point_count);
+        }
+
+        desc.primitives.resize(get<uint32_t>());
+        for (auto&& primitive : desc.primitives) primitive = get_string();
+
+        return desc;
+    }
+
+private:
+    const std::byte* take(size_t size) {
+        if (size > data.size() - pos)
+            throw efx_builder_error("Truncated binary effect");
+        auto p = data.data() + pos;
+        pos += size;
+        return p;
+    }
+
+    template <typename T>
+    anim_key_sequence<T> read_keys() {
+        static_assert(std::is_trivially_copyable_v<anim_key<T>>);
+
+        auto                 bytes = get_array_bytes<anim_key<T>>();
+        anim_key_sequence<T> keys;
+        for (size_t offset = 0; offset < bytes.size(); offset += sizeof(anim_key<T>)) {
+            anim_key<T> key;
+            std::memcpy(&key, bytes.data() + offset, sizeof(key));
+            check_enum(key.interpolation, interpolation_t::bezier, "interpolation");
+            keys.push(key);
+        }
+        return keys;
+    }
+
+private:
+    std::span<const std::byte> data;
+    size_t                     pos = 0;
+};
+
+/*
+ * Loads a compiled effect from memory-mapped file or pack, same interface as efx_builder
+ */
+class efx_binary_loader {
+public:
+    using build_result_t = efx_build_result;
+
+    efx_binary_loader(texture_mgr&               texture_manager,
+                      const std::string&         effect_path,
+                      const core::resource_pack* pack = nullptr):
+        tx_mgr(&texture_manager), file(open_effect_file(effect_path, pack)) {}
+
+    build_result_t build() const {
+        return efx_assembler(*tx_mgr).assemble(describe());
+    }
+
+    efx_desc describe() const {
+        return efx_binary_reader(file.bytes()).read();
+    }
+
+private:
+    texture_mgr*        tx_mgr;
+    core::resource_data file;
+};
+} // namespace grx::efx_editor
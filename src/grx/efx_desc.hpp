@@ -0,0 +1,338 @@
+#pragma once
+
+#include <algorithm>
+#include <optional>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "efx.hpp"
+#include "keyframe_animation.hpp"
+#include "keyframe_compression.hpp"
+#include "path_animation.hpp"
+#include "core/resource_pack.hpp"
+#include "texture_mgr.hpp"
+#include "types.hpp"
+
+namespace grx::efx_editor
+{
+class efx_builder_error : public std::runtime_error {
+public:
+    efx_builder_error(std::string msg): std::runtime_error(std::move(msg)) {}
+};
+
+/* Effect file from the pack if it has one, from disk otherwise */
+inline core::resource_data open_effect_file(const std::string& effect_path, const core::resource_pack* pack) {
+    core::resource_data file;
+    if (!file.open(pack, effect_path))
+        throw efx_builder_error("Cannot open effect file '" + effect_path + "'");
+    return file;
+}
+
+/*
+ * Plain data form of an effect file, shared by the JSON, SAX and binary loaders
+ */
+enum class efx_anim_type : uint8_t { position = 0, scale, rotation, path };
+
+struct efx_anim_desc {
+    using keys_t = std::variant<anim_key_sequence<vec2f>, anim_key_sequence<float>>;
+
+    std::string                          name;
+    efx_anim_type                        type = efx_anim_type::position;
+    keys_t                               keys;
+    std::vector<efx::handler_t::index_t> affected_indices;
+    bool                                 apply_to_all = true;
+    std::optional<float>                 max_error;
+
+    /* Path animations have control points instead of keys */
+    std::vector<vec2f> points;
+    bool               closed = false;
+    bool               orient = false;
+};
+
+struct efx_texture_desc {
+    std::string name;
+    texture_def def;
+};
+
+enum class efx_template_type : uint8_t { sprite = 0, circle, rect };
+
+struct efx_template_desc {
+    std::string                       name;
+    efx_template_type                 type = efx_template_type::sprite;
+    std::optional<std::string>        texture;
+    std::optional<rgba_t>             color;
+    std::optional<rgba_t>             fill_color;
+    std::optional<std::array<int, 4>> source_rect;
+    std::optional<vec2f>              position;
+    std::optional<vec2f>              size;
+    std::optional<vec2f>              origin;
+    std::optional<float>              radius;
+    std::optional<float>              rotation;
+    std::optional<unsigned>           point_count;
+};
+
+struct efx_desc {
+    std::string                    name;
+    float                          duration = 0.f;
+    std::vector<efx_anim_desc>     animations;
+    std::vector<efx_texture_desc>  textures;
+    std::vector<efx_template_desc> templates;
+    std::vector<std::string>       primitives;
+};
+
+struct efx_build_result {
+    std::string name;
+    efx         effect;
+};
+
+/*
+ * Makes an efx prototype from the description, textures are loaded through texture_mgr
+ */
+class efx_assembler {
+public:
+    efx_assembler(texture_mgr& texture_manager): tx_mgr(&texture_manager) {}
+
+    efx_build_result assemble(const efx_desc& desc) const {
+        efx_build_result result;
+
+        result.name = desc.name;
+        result.effect.set_duration(desc.duration);
+
+        /*
+         * Position, scale and rotation channels applied to the same elements are merged into one transform track
+         * if no other animation name sorts between theirs, so handlers keep their order
+         */
+        std::set<std::string> names;
+        for (auto&& anim : desc.animations) names.insert(anim.name);
+
+        std::vector<transform_track_result_t> transform_tracks;
+        for (auto&& anim : desc.animations) {
+            auto compact = anim.max_error.has_value();
+
+            if (anim.type == efx_anim_type::position && compact) {
+                add_keys_handler(result.effect, anim, std::get<anim_key_sequence<vec2f>>(anim.keys), [](auto&& keys) {
+                    return efx_handlers::position(keys);
+                });
+            }
+            else if (anim.type == efx_anim_type::position) {
+                find_transform_track(transform_tracks, names, anim, &anim_transform_track::has_position)
+                    .set_position(std::get<anim_key_sequence<vec2f>>(anim.keys));
+            }
+            else if (anim.type == efx_anim_type::scale && compact) {
+                add_keys_handler(result.effect, anim, std::get<anim_key_sequence<vec2f>>(anim.keys), [](auto&& keys) {
+                    return efx_handlers::scale(keys);
+                });
+            }
+            else if (anim.type == efx_anim_type::scale) {
+                find_transform_track(transform_tracks, names, anim, &anim_transform_track::has_scale)
+                    .set_scale(std::get<anim_key_sequence<vec2f>>(anim.keys));
+            }
+            else if (anim.type == efx_anim_type::rotation && compact) {
+                add_keys_handler(result.effect, anim, std::get<anim_key_sequence<float>>(anim.keys), [](auto&& keys) {
+                    return efx_handlers::rotation(keys);
+                });
+            }
+            else if (anim.type == efx_anim_type::rotation) {
+                find_transform_track(transform_tracks, names, anim, &anim_transform_track::has_rotation)
+                    .set_rotation(std::get<anim_key_sequence<float>>(anim.keys));
+            }
+            else if (anim.type == efx_anim_type::path) {
+                auto path = anim_path(anim.points, anim.closed);
+                set_affected(result.effect.add_handler(anim.name, efx_handlers::path(path, anim.orient)), anim);
+            }
+            else
+                throw efx_builder_error("Invalid animation type for '" + anim.name + "'");
+        }
+
+        /* The handler takes the first of the merged names, the others are its aliases */
+        for (auto&& transform : transform_tracks) {
+            auto& name    = *std::min_element(transform.names.begin(), transform.names.end());
+            auto& handler = result.effect.add_handler(name, efx_handlers::transform(transform.track));
+            if (transform.apply_to_all)
+                handler.set_affects_all(true);
+            else
+                handler.set_affected_indices(transform.affected_indices);
+
+            for (auto&& alias : transform.names)
+                if (alias != name)
+                    result.effect.add_alias(alias, name);
+        }
+
+        /*
+         * Load textures
+         */
+        std::map<std::string, texture_region> textures;
+        for (auto&& texture : desc.textures) {
+            auto& region = textures.emplace(texture.name, tx_mgr->load_region(texture.def)).first->second;
+            if (region.get_handle())
+                result.effect.hold_texture(region.get_handle());
+        }
+
+        /*
+         * Make templates
+         */
+        std::map<std::string, drawable_t> templates;
+        for (auto&& template_desc : desc.templates)
+            templates.emplace(template_desc.name, make_template(template_desc, textures));
+
+        /*
+         * Make primitives
+         */
+        for (auto&& template_name : desc.primitives) {
+            auto template_p = templates.find(template_name);
+            if (template_p == templates.end())
+                throw efx_builder_error("Cannot find template '" + template_name + "'");
+
+            result.effect.push_element(template_p->second);
+        }
+
+        return result;
+    }
+
+private:
+    struct transform_track_result_t {
+        std::vector<std::string>             names;
+        anim_transform_track                 track;
+        std::vector<efx::handler_t::index_t> affected_indices;
+        bool                                 apply_to_all = true;
+    };
+
+    /*
+     * Finds a track for the same elements with a free channel whose names and the animation name are adjacent
+     * in names, the sorted names of all animations
+     */
+    static anim_transform_track& find_transform_track(std::vector<transform_track_result_t>& tracks,
+                                                      const std::set<std::string>&           names,
+                                                      const efx_anim_desc&                   anim,
+                                                      bool (anim_transform_track::*has_channel)() const) {
+        auto adjacent = [&](const std::vector<std::string>& track_names) {
+            auto [first, last] = std::minmax_element(track_names.begin(), track_names.end());
+            auto begin         = names.find(std::min(*first, anim.name));
+            auto end           = std::next(names.find(std::max(*last, anim.name)));
+            return size_t(std::distance(begin, end)) == track_names.size() + 1;
+        };
+
+        auto found = std::find_if(tracks.begin(), tracks.end(), [&](const transform_track_result_t& transform) {
+            return transform.apply_to_all == anim.apply_to_all &&
+                   (transform.apply_to_all || transform.affected_indices == anim.affected_indices) &&
+                   !(transform.track.*has_channel)() && adjacent(transform.names);
+        });
+
+        if (found == tracks.end()) {
+            tracks.push_back({{anim.name}, {}, anim.affected_indices, anim.apply_to_all});
+            return tracks.back().track;
+        }
+
+        found->names.push_back(anim.name);
+        return found->track;
+    }
+
+    /* Compact keys drop linear keys closer than max_error to the reduced curve */
+    template <typename T>
+    static void
+    add_keys_handler(efx& effect, const efx_anim_desc& anim, const anim_key_sequence<T>& keys, auto&& make_handler) {
+        auto& handler =
+            effect.add_handler(anim.name, make_handler(compact_anim_key_sequence<T>(keys, *anim.max_error)));
+        set_affected(handler, anim);
+    }
+
+    static void set_affected(efx::handler_t& handler, const efx_anim_desc& anim) {
+        if (anim.apply_to_all)
+            handler.set_affects_all(true);
+        else
+            handler.set_affected_indices(anim.affected_indices);
+    }
+
+    /* Source rect is relative to the texture image, it is mapped to the atlas page if the texture is packed */
+    static void set_texture(const efx_template_desc&                     desc,
+                            auto&                                        drawable,
+                            const std::map<std::string, texture_region>& textures) {
+        if (!desc.texture) {
+            set_source_rect(desc, drawable);
+            return;
+        }
+
+        auto texture_p = textures.find(*desc.texture);
+        if (texture_p == textures.end())
+            throw efx_builder_error("Cannot find texture '" + *desc.texture + "'");
+
+        auto& region = texture_p->second;
+        if constexpr (std::is_same_v<std::decay_t<decltype(drawable)>, sf::Sprite>)
+            drawable.setTexture(region.get_texture());
+        else
+            drawable.setTexture(&region.get_texture());
+
+        if (desc.source_rect) {
+            auto& rect = *desc.source_rect;
+            drawable.setTextureRect(region.map_rect({rect[0], rect[1], rect[2], rect[3]}));
+        }
+        else {
+            drawable.setTextureRect(region.get_rect());
+        }
+    }
+
+#define DEF_SET(what, sfml_method, cast)                                                                               \
+    static void set_##what(const efx_template_desc& desc, auto& drawable) {                                            \
+        if (desc.what)                                                                                                 \
+            drawable.sfml_method(cast);                                                                                \
+    }
+
+    DEF_SET(color, setColor, *desc.color)
+    DEF_SET(fill_color, setFillColor, *desc.fill_color)
+    DEF_SET(source_rect,
+            setTextureRect,
+            sf::IntRect((*desc.source_rect)[0], (*desc.source_rect)[1], (*desc.source_rect)[2], (*desc.source_rect)[3]))
+    DEF_SET(position, setPosition, *desc.position)
+    DEF_SET(size, setSize, *desc.size)
+    DEF_SET(origin, setOrigin, *desc.origin)
+    DEF_SET(radius, setRadius, *desc.radius)
+    DEF_SET(rotation, setRotation, *desc.rotation)
+    DEF_SET(point_count, setPointCount, *desc.point_count)
+
+#undef DEF_SET
+
+    static drawable_t make_template(const efx_template_desc&                     desc,
+                                    const std::map<std::string, texture_region>& textures) {
+        switch (desc.type) {
+        case efx_template_type::sprite: {
+            sf::Sprite drawable;
+            set_texture(desc, drawable, textures);
+            set_color(desc, drawable);
+            set_position(desc, drawable);
+            set_origin(desc, drawable);
+            set_rotation(desc, drawable);
+            return drawable;
+        }
+        case efx_template_type::circle: {
+            sf::CircleShape drawable;
+            set_texture(desc, drawable, textures);
+            set_fill_color(desc, drawable);
+            set_position(desc, drawable);
+            set_origin(desc, drawable);
+            set_radius(desc, drawable);
+            set_rotation(desc, drawable);
+            set_point_count(desc, drawable);
+            return drawable;
+        }
+        case efx_template_type::rect: {
+            sf::RectangleShape drawable;
+            set_texture(desc, drawable, textures);
+            set_fill_color(desc, drawable);
+            set_position(desc, drawable);
+            set_size(desc, drawable);
+            set_origin(desc, drawable);
+            set_rotation(desc, drawable);
+            return drawable;
+        }
+        }
+
+        throw efx_builder_error("Invalid template type for '" + desc.name + "'");
+    }
+
+private:
+    texture_mgr* tx_mgr;
+};
+} // namespace grx::efx_editor
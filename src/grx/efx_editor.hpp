@@ -2,7 +2,11 @@
 #include <fstream>
 #include <iostream>
 
+#include "core/disk_cache.hpp"
+#include "core/resource_pack.hpp"
 #include "efx.hpp"
+#include "efx_binary.hpp"
+#include "efx_desc.hpp"
 #include "json.hpp"
 #include "keyframe_animation.hpp"
 #include "texture_mgr.hpp"
@@ -13,33 +17,62 @@ namespace grx::efx_editor
 {
 namespace json = nlohmann;
 
-class efx_builder_error : public std::runtime_error {
-public:
-    efx_builder_error(std::string msg): std::runtime_error(std::move(msg)) {}
-};
-
 class efx_builder {
 public:
     using object_t = json::json::object_t;
     using array_t = json::json::array_t;
+    using build_result_t = efx_build_result;
+
+    /* The file is read from the pack if it is there, from disk otherwise */
+    efx_builder(texture_mgr&               texture_manager,
+                const std::string&         effect_path,
+                const core::resource_pack* pack = nullptr):
+        tx_mgr(&texture_manager) {
+        auto file = open_effect_file(effect_path, pack);
+        auto data = reinterpret_cast<const char*>(file.data());
+        efx_json  = json::json::parse(data, data + file.size());
+    }
 
-    efx_builder(texture_mgr& texture_manager, const std::string& effect_path): tx_mgr(&texture_manager) {
-        std::ifstream ifs(effect_path);
-        if (!ifs.is_open())
-            throw efx_builder_error("Cannot open effect file '" + effect_path + "'");
+    /*
+     * The description is taken from the cache by the file content hash, parsing and validation are skipped on hit
+     * On miss the file is parsed and the description is stored in the binary effect format
+     */
+    efx_builder(texture_mgr&               texture_manager,
+                const std::string&         effect_path,
+                core::disk_cache&          cache,
+                const core::resource_pack* pack = nullptr):
+        tx_mgr(&texture_manager) {
+        auto file = open_effect_file(effect_path, pack);
+        auto hash = file.get_pack_hash() ? *file.get_pack_hash() : core::fnv1a64(file.bytes());
+        auto key  = core::disk_cache::make_key("efx" + std::to_string(efx_binary_version), hash);
+
+        if (core::mapped_file cached; cache.load(key, cached)) {
+            try {
+                cached_desc = efx_binary_reader(cached.bytes()).read();
+                return;
+            }
+            catch (const efx_builder_error&) {
+                /* Broken entry, rebuilt below */
+            }
+        }
 
-        auto b   = std::istreambuf_iterator<char>(ifs);
-        auto e   = std::istreambuf_iterator<char>();
-        efx_json = json::json::parse(b, e);
-    }
+        auto data = reinterpret_cast<const char*>(file.data());
+        efx_json  = json::json::parse(data, data + file.size());
 
-    struct build_result_t {
-        std::string name;
-        efx effect;
-    };
+        efx_binary_writer writer;
+        writer.write(describe());
+        cache.store(key, writer.get_data());
+    }
 
     build_result_t build() const {
-        return build(efx_json);
+        CORE_PROFILE_ZONE("efx_builder::build");
+        return efx_assembler(*tx_mgr).assemble(describe());
+    }
+
+    efx_desc describe() const {
+        if (cached_desc)
+            return *cached_desc;
+        return describe(efx_json.get_ref<const object_t&>());
     }
 
 private:
@@ -65,7 +98,7 @@ private:
         auto in_p = obj.find("in");
         auto out_p = obj.find("out");
 
-        vec2f in, out;
+        vec2f in{0, 0}, out{1, 1};
 
         if (in_p != obj.end()) {
             if (type == interpolation_not_set)
@@ -85,223 +118,171 @@ private:
         return anim_key<T>{value_j.get<T>(), time, type, in, out};
     }
 
-    template <typename T>
-    struct keys_result_t {
-        anim_key_sequence<T> keys;
-        std::vector<efx::handler_t::index_t> affected_indices;
-        bool apply_to_all = true;
-    };
+    void parse_keys(const object_t& obj, efx_anim_desc& anim) const {
+        auto& keys_j = obj.at("keys").get_ref<const array_t&>();
+        std::visit(
+            [&]<typename T>(anim_key_sequence<T>& keys) {
+                for (auto&& key : keys_j) keys.push(parse_key<T>(key.get_ref<const object_t&>()));
+            },
+            anim.keys);
 
-    template <typename T>
-    keys_result_t<T> parse_keys(const object_t& obj) const {
-        keys_result_t<T> result;
+        parse_apply_to(obj, anim);
 
-        for (auto&& key : obj.at("keys").get<array_t>())
-            result.keys.push(parse_key<T>(key));
+        if (auto max_error_p = obj.find("max_error"); max_error_p != obj.end())
+            anim.max_error = max_error_p->second.get<float>();
+    }
+
+    void parse_path(const object_t& obj, efx_anim_desc& anim) const {
+        anim.points = obj.at("points").get<std::vector<vec2f>>();
+
+        if (auto closed_p = obj.find("closed"); closed_p != obj.end())
+            anim.closed = closed_p->second.get<bool>();
+        if (auto orient_p = obj.find("orient"); orient_p != obj.end())
+            anim.orient = orient_p->second.get<bool>();
 
+        parse_apply_to(obj, anim);
+    }
+
+    void parse_apply_to(const object_t& obj, efx_anim_desc& anim) const {
         if (auto apply_to_p = obj.find("apply_to"); apply_to_p != obj.end()) {
             if (apply_to_p->second.is_string() && apply_to_p->second.get<std::string>() == "all")
-                result.apply_to_all = true;
+                anim.apply_to_all = true;
             else if (apply_to_p->second.is_array()) {
-                result.affected_indices = apply_to_p->second.get<std::vector<efx::handler_t::index_t>>();
-                result.apply_to_all = false;
+                anim.affected_indices = apply_to_p->second.get<std::vector<efx::handler_t::index_t>>();
+                anim.apply_to_all = false;
             }
         }
-
-        return result;
-    }
-
-    bool parse_set_source_rect(const object_t& obj, auto& drawable) const {
-        if (auto value = obj.find("source_rect"); value != obj.end()) {
-            auto rect = value->second.get<std::array<int, 4>>();
-            drawable.setTextureRect({rect[0], rect[1], rect[2], rect[3]});
-            return true;
-        }
-        return false;
     }
 
-    bool
-    parse_set_texture(const object_t& obj, auto& drawable, const std::map<std::string, sf::Texture*>& textures) const {
-        if (auto value = obj.find("texture"); value != obj.end()) {
-            auto name      = value->second.get<std::string>();
-            auto texture_p = textures.find(name);
-
-            if (texture_p == textures.end())
-                throw efx_builder_error("Cannot find texture '" + name + "'");
-
-            if constexpr (std::is_same_v<std::decay_t<decltype(drawable)>, sf::Sprite>)
-                drawable.setTexture(*texture_p->second);
-            else
-                drawable.setTexture(texture_p->second);
+    efx_anim_desc parse_animation(const object_t& obj) const {
+        efx_anim_desc anim;
+        anim.name = obj.at("name").get<std::string>();
 
-            return true;
+        auto type = obj.at("type").get<std::string>();
+        if (type == "position") {
+            anim.type = efx_anim_type::position;
+            anim.keys = anim_key_sequence<vec2f>{};
+        }
+        else if (type == "scale") {
+            anim.type = efx_anim_type::scale;
+            anim.keys = anim_key_sequence<vec2f>{};
+        }
+        else if (type == "rotation") {
+            anim.type = efx_anim_type::rotation;
+            anim.keys = anim_key_sequence<float>{};
+        }
+        else if (type == "path") {
+            anim.type = efx_anim_type::path;
+            parse_path(obj, anim);
+            return anim;
         }
-        return false;
+        else {
+            throw efx_builder_error("Invalid animation type '" + type + "'");
+        }
+
+        parse_keys(obj, anim);
+        return anim;
     }
 
-#define DEF_PARSE_SET(what, sfml_method, cast)                                                                         \
-    bool parse_set_##what(const object_t& obj, auto& drawable) const {                                                 \
-        if (auto value = obj.find(#what); value != obj.end()) {                                                        \
-            drawable.sfml_method(cast);                                                                                \
-            return true;                                                                                               \
-        }                                                                                                              \
-        return false;                                                                                                  \
+#define DEF_PARSE(what, cast)                                                                                          \
+    void parse_##what(const object_t& obj, efx_template_desc& desc) const {                                            \
+        if (auto value = obj.find(#what); value != obj.end())                                                          \
+            desc.what = cast;                                                                                          \
     }
 
-    DEF_PARSE_SET(color, setColor, rgba_t::from_str(value->second.get<std::string>()))
-    DEF_PARSE_SET(fill_color, setFillColor, rgba_t::from_str(value->second.get<std::string>()))
-    DEF_PARSE_SET(position, setPosition, value->second.get<vec2f>())
-    DEF_PARSE_SET(size, setSize, value->second.get<vec2f>())
-    DEF_PARSE_SET(origin, setOrigin, value->second.get<vec2f>())
-    DEF_PARSE_SET(radius, setRadius, value->second.get<float>())
-    DEF_PARSE_SET(rotation, setRotation, value->second.get<float>())
-    DEF_PARSE_SET(point_count, setPointCount, value->second.get<unsigned>())
+    DEF_PARSE(texture, value->second.get<std::string>())
+    DEF_PARSE(color, rgba_t::from_str(value->second.get<std::string>()))
+    DEF_PARSE(fill_color, rgba_t::from_str(value->second.get<std::string>()))
+    DEF_PARSE(source_rect, (value->second.get<std::array<int, 4>>()))
+    DEF_PARSE(position, value->second.get<vec2f>())
+    DEF_PARSE(size, value->second.get<vec2f>())
+    DEF_PARSE(origin, value->second.get<vec2f>())
+    DEF_PARSE(radius, value->second.get<float>())
+    DEF_PARSE(rotation, value->second.get<float>())
+    DEF_PARSE(point_count, value->second.get<unsigned>())
 
-#undef DEF_PARSE_SET
+#undef DEF_PARSE
 
-    drawable_t parse_template(const object_t& obj, const std::map<std::string, sf::Texture*>& textures) const {
-        auto e = obj.end();
+    efx_template_desc parse_template(const std::string& name, const object_t& obj) const {
+        efx_template_desc desc;
+        desc.name = name;
 
         auto type = obj.at("type").get<std::string>();
-
-        if (type == "sprite") {
-            sf::Sprite drawable;
-            parse_set_texture(obj, drawable, textures);
-            parse_set_color(obj, drawable);
-            parse_set_source_rect(obj, drawable);
-            parse_set_position(obj, drawable);
-            parse_set_origin(obj, drawable);
-            parse_set_rotation(obj, drawable);
-            return drawable;
-        }
-        else if (type == "circle") {
-            sf::CircleShape drawable;
-            parse_set_texture(obj, drawable, textures);
-            parse_set_fill_color(obj, drawable);
-            parse_set_position(obj, drawable);
-            parse_set_origin(obj, drawable);
-            parse_set_radius(obj, drawable);
-            parse_set_rotation(obj, drawable);
-            parse_set_point_count(obj, drawable);
-            return drawable;
-        }
-        else if (type == "rect") {
-            sf::RectangleShape drawable;
-            parse_set_texture(obj, drawable, textures);
-            parse_set_fill_color(obj, drawable);
-            parse_set_position(obj, drawable);
-            parse_set_size(obj, drawable);
-            parse_set_origin(obj, drawable);
-            parse_set_rotation(obj, drawable);
-            return drawable;
-        }
-        else {
+        if (type == "sprite")
+            desc.type = efx_template_type::sprite;
+        else if (type == "circle")
+            desc.type = efx_template_type::circle;
+        else if (type == "rect")
+            desc.type = efx_template_type::rect;
+        else
             throw efx_builder_error("Invalid template type: '" + type + "'");
-        }
-    }
 
-    std::map<std::string, sf::Texture*> parse_textures(const object_t& obj) const {
-        std::map<std::string, sf::Texture*> textures;
-
-        if (obj.contains("textures")) {
-            for (auto&& [texture_name, texture_j] : obj.at("textures").get<object_t>()) {
-                auto tx_obj     = texture_j.get<object_t>();
-                auto path       = tx_obj.at("path").get<std::string>();
-                auto smooth_p   = tx_obj.find("smooth");
-                auto srgb_p     = tx_obj.find("srgb");
-                auto repeated_p = tx_obj.find("repeated");
-
-                bool smooth   = true;
-                bool srgb     = false;
-                bool repeated = false;
-
-                if (smooth_p != tx_obj.end())
-                    smooth = smooth_p->second.get<bool>();
-                if (srgb_p != tx_obj.end())
-                    srgb = srgb_p->second.get<bool>();
-                if (repeated_p != tx_obj.end())
-                    repeated = repeated_p->second.get<bool>();
-
-                textures.emplace(texture_name, &tx_mgr->load(path, smooth, srgb, repeated));
-            }
-        }
+        parse_texture(obj, desc);
+        parse_color(obj, desc);
+        parse_fill_color(obj, desc);
+        parse_source_rect(obj, desc);
+        parse_position(obj, desc);
+        parse_size(obj, desc);
+        parse_origin(obj, desc);
+        parse_radius(obj, desc);
+        parse_rotation(obj, desc);
+        parse_point_count(obj, desc);
+
+        return desc;
+    }
 
-        return textures;
+    efx_texture_desc parse_texture_def(const std::string& name, const object_t& tx_obj) const {
+        efx_texture_desc texture{name, {tx_obj.at("path").get<std::string>()}};
+
+        if (auto smooth_p = tx_obj.find("smooth"); smooth_p != tx_obj.end())
+            texture.def.smooth = smooth_p->second.get<bool>();
+        if (auto srgb_p = tx_obj.find("srgb"); srgb_p != tx_obj.end())
+            texture.def.srgb = srgb_p->second.get<bool>();
+        if (auto repeated_p = tx_obj.find("repeated"); repeated_p != tx_obj.end())
+            texture.def.repeated = repeated_p->second.get<bool>();
+        if (auto mipmap_p = tx_obj.find("mipmap"); mipmap_p != tx_obj.end())
+            texture.def.mipmap = mipmap_p->second.get<bool>();
+        if (auto variants_p = tx_obj.find("variants"); variants_p != tx_obj.end())
+            texture.def.variants = variants_p->second.get<uint32_t>();
+
+        return texture;
     }
 
-    build_result_t build(const object_t& obj) const {
-        build_result_t result;
+    efx_desc describe(const object_t& obj) const {
+        efx_desc desc;
 
-        result.name = obj.at("name").get<std::string>();
-        result.effect.set_duration(obj.at("duration").get<float>());
+        desc.name     = obj.at("name").get<std::string>();
+        desc.duration = obj.at("duration").get<float>();
 
         /*
          * Parse animations
          */
-        for (auto&& anim_j : obj.at("animations").get<array_t>()) {
-            auto anim_obj = anim_j.get<object_t>();
-            auto name = anim_obj.at("name").get<std::string>();
-            auto type = anim_obj.at("type").get<std::string>();
-
-            /* TODO: refactor */
-            if (type == "position") {
-                auto keys_result = parse_keys<vec2f>(anim_obj);
-                auto& handler = result.effect.add_handler(name, efx_handlers::position(keys_result.keys));
-                if (keys_result.apply_to_all)
-                    handler.set_affects_all(true);
-                else
-                    handler.set_affected_indices(keys_result.affected_indices);
-            }
-            else if (type == "scale") {
-                auto keys_result = parse_keys<vec2f>(anim_obj);
-                auto& handler = result.effect.add_handler(name, efx_handlers::scale(keys_result.keys));
-                if (keys_result.apply_to_all)
-                    handler.set_affects_all(true);
-                else
-                    handler.set_affected_indices(keys_result.affected_indices);
-            }
-            else if (type == "rotation") {
-                auto keys_result = parse_keys<float>(anim_obj);
-                auto& handler = result.effect.add_handler(name, efx_handlers::rotation(keys_result.keys));
-                if (keys_result.apply_to_all)
-                    handler.set_affects_all(true);
-                else
-                    handler.set_affected_indices(keys_result.affected_indices);
-            }
-            else {
-                throw efx_builder_error("Invalid animation type '" + type + "'");
-            }
-        }
+        for (auto&& anim_j : obj.at("animations").get_ref<const array_t&>())
+            desc.animations.push_back(parse_animation(anim_j.get_ref<const object_t&>()));
 
         /*
          * Parse textures
          */
-        auto textures = parse_textures(obj);
+        if (auto textures_p = obj.find("textures"); textures_p != obj.end())
+            for (auto&& [texture_name, texture_j] : textures_p->second.get_ref<const object_t&>())
+                desc.textures.push_back(parse_texture_def(texture_name, texture_j.get_ref<const object_t&>()));
 
         /*
          * Parse templates
          */
-        std::map<std::string, drawable_t> templates;
-        for (auto&& [template_name, template_j] : obj.at("templates").get<object_t>())
-            templates.emplace(template_name, parse_template(template_j.get<object_t>(), textures));
+        for (auto&& [template_name, template_j] : obj.at("templates").get_ref<const object_t&>())
+            desc.templates.push_back(parse_template(template_name, template_j.get_ref<const object_t&>()));
 
         /* Parse primitives */
-        for (auto&& prim_j : obj.at("primitives").get<array_t>()) {
-            auto prim_obj = prim_j.get<object_t>();
-
-            auto template_name = prim_obj.at("template").get<std::string>();
-            auto template_p = templates.find(template_name);
-            if (template_p == templates.end())
-                throw efx_builder_error("Cannot find template '" + template_name + "'");
-
-            result.effect.push_element(template_p->second);
-        }
+        for (auto&& prim_j : obj.at("primitives").get_ref<const array_t&>())
+            desc.primitives.push_back(prim_j.get_ref<const object_t&>().at("template").get<std::string>());
 
-        return result;
+        return desc;
     }
 
 private:
-    texture_mgr* tx_mgr;
-    json::json efx_json;
+    texture_mgr*            tx_mgr;
+    json::json              efx_json;
+    std::optional<efx_desc> cached_desc;
 };
 } // namespace grx::efx_editor
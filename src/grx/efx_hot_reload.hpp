@@ -0,0 +1,94 @@
+#pragma once
+#include <map>
+
+#include "core/file_watcher.hpp"
+#include "efx_editor.hpp"
+
+namespace grx::efx_editor
+{
+/*
+ * Rebuilds watched effect files when they change on disk and replaces their prototypes in efx_mgr
+ * A failed build keeps the previous prototype, so a half-saved file does not break the running game
+ * Textures are reloaded in place only when their own files change, one failing to reload keeps its previous image
+ * Failures of both are returned in update_result::errors
+ */
+class efx_hot_reloader {
+public:
+    struct update_result {
+        std::vector<std::string> effects;
+        std::vector<std::string> textures;
+        std::vector<std::string> errors;
+    };
+
+    efx_hot_reloader(texture_mgr& texture_manager, efx_mgr& effect_manager):
+        tx_mgr(&texture_manager), e_mgr(&effect_manager) {}
+
+    /* Builds and registers the effect, then watches it, returns the effect name */
+    std::string watch(const std::string& effect_path) {
+        effect_entry_t entry{effect_path, {}};
+        rebuild(entry);
+
+        if (!watcher.watch_file(effect_path))
+            throw efx_builder_error("Cannot watch effect file '" + effect_path + "'");
+
+        effects.insert_or_assign(core::file_watcher::normalize(effect_path).string(), entry);
+        return entry.name;
+    }
+
+    /* Non-blocking, meant to be called once per frame */
+    update_result update() {
+        update_result result;
+
+        for (auto&& changed : watcher.poll()) {
+            if (auto texture = textures.find(changed); texture != textures.end()) {
+                try {
+                    if (tx_mgr->reload(texture->second))
+                        result.textures.push_back(texture->second);
+                }
+                catch (const std::exception& e) {
+                    result.errors.push_back(texture->second + ": " + e.what());
+                }
+            }
+
+            if (auto effect = effects.find(changed); effect != effects.end()) {
+                try {
+                    rebuild(effect->second);
+                    result.effects.push_back(effect->second.name);
+                }
+                catch (const std::exception& e) {
+                    result.errors.push_back(effect->second.path + ": " + e.what());
+                }
+            }
+        }
+
+        return result;
+    }
+
+private:
+    struct effect_entry_t {
+        std::string path;
+        std::string name;
+    };
+
+    void rebuild(effect_entry_t& entry) {
+        auto desc   = efx_builder(*tx_mgr, entry.path).describe();
+        auto result = efx_assembler(*tx_mgr).assemble(desc);
+
+        for (auto&& texture : desc.textures) {
+            auto texture_key = core::file_watcher::normalize(texture.def.path).string();
+            if (textures.emplace(texture_key, texture.def.path).second)
+                watcher.watch_file(texture.def.path);
+        }
+
+        entry.name = result.name;
+        e_mgr->add_effect(result.name, std::move(result.effect));
+    }
+
+private:
+    texture_mgr*                          tx_mgr;
+    efx_mgr*                              e_mgr;
+    core::file_watcher                    watcher;
+    std::map<std::string, effect_entry_t> effects;
+    std::map<std::string, std::string>    textures;
+};
+} // namespace grx::efx_editor
@@ -0,0 +1,132 @@
+#pragma once
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+
+#include "core/resource_pack.hpp"
+#include "core/thread_pool.hpp"
+#include "efx_binary.hpp"
+#include "efx_desc.hpp"
+#include "efx_sax_builder.hpp"
+#include "json.hpp"
+
+namespace grx::efx_editor
+{
+/*
+ * Builds many effects on a thread pool
+ * Effects are returned and registered in the order of the paths, whatever the order of completion
+ * Files with ".efxb" extension are loaded as compiled effects, all others as JSON
+ * With a resource pack files are read from it, the ones missing in the pack are read from disk
+ */
+class efx_library_loader {
+public:
+    efx_library_loader(texture_mgr& texture_manager, size_t threads_count = std::thread::hardware_concurrency()):
+        tx_mgr(&texture_manager), pool(threads_count) {}
+
+    /* All .json and .efxb files in the directory, sorted by path, the pack entries are included */
+    static std::vector<std::string> list_directory(const std::string&         dir_path,
+                                                   const core::resource_pack* pack = nullptr) {
+        namespace fs = std::filesystem;
+
+        auto is_effect = [](const fs::path& path) {
+            return path.extension() == ".json" || path.extension() == ".efxb";
+        };
+
+        std::vector<std::string> paths;
+        if (pack) {
+            /* Only direct children, as with the directory */
+            auto dir = fs::path(core::normalize_resource_path(dir_path));
+            for (auto&& path : pack->list(dir_path))
+                if (fs::path(path).parent_path() == dir && is_effect(path))
+                    paths.push_back(path);
+        }
+
+        std::error_code ec;
+        auto            dir = fs::directory_iterator(dir_path, ec);
+        if (ec && paths.empty())
+            throw efx_builder_error("Cannot open effect directory '" + dir_path + "'");
+
+        if (!ec) {
+            for (auto&& entry : dir) {
+                auto path = core::normalize_resource_path(entry.path().string());
+                if (entry.is_regular_file() && is_effect(path))
+                    paths.push_back(path);
+            }
+        }
+
+        std::sort(paths.begin(), paths.end());
+        paths.erase(std::unique(paths.begin(), paths.end()), paths.end());
+        return paths;
+    }
+
+    /*
+     * Manifest is a json object { "effects": [ "path", ... ] }
+     * Relative paths are resolved against the manifest directory
+     */
+    static std::vector<std::string> read_manifest(const std::string&         manifest_path,
+                                                  const core::resource_pack* pack = nullptr) {
+        namespace fs = std::filesystem;
+
+        core::resource_data file;
+        if (!file.open(pack, manifest_path))
+            throw efx_builder_error("Cannot open effect manifest '" + manifest_path + "'");
+
+        auto data     = reinterpret_cast<const char*>(file.data());
+        auto manifest = nlohmann::json::parse(data, data + file.size());
+        auto base     = fs::path(manifest_path).parent_path();
+
+        std::vector<std::string> paths;
+        for (auto&& path_j : manifest.at("effects")) {
+            auto path = fs::path(path_j.get<std::string>());
+            paths.push_back((path.is_absolute() ? path : base / path).string());
+        }
+        return paths;
+    }
+
+    /* Rethrows the error of the first failed effect in the paths order */
+    std::vector<efx_build_result> build(const std::vector<std::string>& paths) {
+        std::vector<std::future<efx_build_result>> futures;
+        futures.reserve(paths.size());
+        for (auto&& path : paths) futures.push_back(pool.submit([this, &path] { return build_one(path); }));
+
+        /* All futures are waited before rethrow, tasks reference the paths */
+        for (auto&& future : futures) future.wait();
+
+        std::vector<efx_build_result> results;
+        results.reserve(paths.size());
+        for (auto&& future : futures) results.push_back(future.get());
+        return results;
+    }
+
+    /* Should be set before building */
+    void set_pack(const core::resource_pack* value) {
+        pack = value;
+    }
+
+    void load(efx_mgr& manager, const std::vector<std::string>& paths) {
+        for (auto&& [name, effect] : build(paths)) manager.add_effect(name, std::move(effect));
+    }
+
+    size_t get_threads_count() const {
+        return pool.size();
+    }
+
+private:
+    efx_build_result build_one(const std::string& path) const {
+        try {
+            if (std::filesystem::path(path).extension() == ".efxb")
+                return efx_binary_loader(*tx_mgr, path, pack).build();
+            else
+                return efx_sax_builder(*tx_mgr, path, pack).build();
+        }
+        catch (const std::exception& e) {
+            throw efx_builder_error("Cannot load effect '" + path + "': " + e.what());
+        }
+    }
+
+private:
+    texture_mgr*               tx_mgr;
+    const core::resource_pack* pack = nullptr;
+    core::thread_pool          pool;
+};
+} // namespace grx::efx_editor
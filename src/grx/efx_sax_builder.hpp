@@ -0,0 +1,665 @@
+#pragma once
+
+#include "efx_desc.hpp"
+#include "json.hpp"
+
+namespace grx::efx_editor
+{
+/*
+ * Fills efx_desc straight from nlohmann's SAX events, no DOM is created
+ *
+ * Only the description itself and the keys of the current animation (its type may follow the keys) are kept.
+ * efx_builder_error messages are the same as in efx_builder,
+ * missing fields and type mismatches are reported with json out_of_range 403 and type_error 302 exceptions
+ */
+class efx_sax_handler {
+public:
+    using json_t            = nlohmann::json;
+    using number_integer_t  = json_t::number_integer_t;
+    using number_unsigned_t = json_t::number_unsigned_t;
+    using number_float_t    = json_t::number_float_t;
+    using string_t          = json_t::string_t;
+    using binary_t          = json_t::binary_t;
+
+    bool null() {
+        return on_scalar(value_kind::null);
+    }
+
+    bool boolean(bool value) {
+        boolean_value = value;
+        return on_scalar(value_kind::boolean);
+    }
+
+    bool number_integer(number_integer_t value) {
+        number_value = double(value);
+        return on_scalar(value_kind::number);
+    }
+
+    bool number_unsigned(number_unsigned_t value) {
+        number_value = double(value);
+        return on_scalar(value_kind::number);
+    }
+
+    bool number_float(number_float_t value, const string_t&) {
+        number_value = double(value);
+        return on_scalar(value_kind::number);
+    }
+
+    bool string(string_t& value) {
+        string_value = value;
+        return on_scalar(value_kind::string);
+    }
+
+    bool binary(binary_t&) {
+        return on_scalar(value_kind::binary);
+    }
+
+    bool start_object(size_t) {
+        return on_open(value_kind::object);
+    }
+
+    bool start_array(size_t) {
+        return on_open(value_kind::array);
+    }
+
+    bool key(string_t& value) {
+        current_key = value;
+        return true;
+    }
+
+    bool end_object() {
+        return on_close();
+    }
+
+    bool end_array() {
+        return on_close();
+    }
+
+    bool parse_error(size_t, const std::string&, const nlohmann::detail::exception& e) {
+        if (auto error = dynamic_cast<const json_t::parse_error*>(&e))
+            throw *error;
+        throw e;
+    }
+
+    efx_desc& get_desc() {
+        return desc;
+    }
+
+private:
+    enum class value_kind : uint8_t { null = 0, boolean, number, string, binary, array, object };
+
+    enum class context_t : uint8_t {
+        root = 0,
+        animations,
+        animation,
+        keys,
+        key,
+        numbers,
+        points,
+        textures,
+        texture,
+        templates,
+        templ,
+        primitives,
+        primitive,
+        skip,
+    };
+
+    struct frame_t {
+        context_t   context;
+        std::string key;
+        uint32_t    seen  = 0;
+        uint32_t    depth = 0;
+    };
+
+    /* Keys are kept untyped until the animation type is known */
+    struct raw_key_t {
+        std::array<float, 2> value{};
+        size_t               value_size     = 0;
+        bool                 value_is_array = false;
+        float                time           = 0.f;
+        interpolation_t      type           = interpolation_not_set;
+        vec2f                in{0, 0};
+        vec2f                out{1, 1};
+        bool                 has_in  = false;
+        bool                 has_out = false;
+    };
+
+    /* Required fields, listed in the order efx_builder checks them */
+    enum seen_t : uint32_t {
+        seen_name       = 1 << 0,
+        seen_duration   = 1 << 1,
+        seen_animations = 1 << 2,
+        seen_templates  = 1 << 3,
+        seen_primitives = 1 << 4,
+        seen_type       = 1 << 5,
+        seen_keys       = 1 << 6,
+        seen_time       = 1 << 7,
+        seen_value      = 1 << 8,
+        seen_path       = 1 << 9,
+        seen_template   = 1 << 10,
+        seen_points     = 1 << 11,
+    };
+
+    static const char* kind_name(value_kind kind) {
+        switch (kind) {
+        case value_kind::null: return "null";
+        case value_kind::boolean: return "boolean";
+        case value_kind::number: return "number";
+        case value_kind::string: return "string";
+        case value_kind::binary: return "binary";
+        case value_kind::array: return "array";
+        case value_kind::object: return "object";
+        }
+        return "unknown";
+    }
+
+    [[noreturn]] static void throw_type_error(value_kind expected, value_kind actual) {
+        throw json_t::type_error::create(
+            302, std::string("type must be ") + kind_name(expected) + ", but is " + kind_name(actual), nullptr);
+    }
+
+    [[noreturn]] static void throw_missing_key(const char* key) {
+        throw json_t::out_of_range::create(403, std::string("key '") + key + "' not found", nullptr);
+    }
+
+    static void expect(value_kind expected, value_kind actual) {
+        if (expected != actual)
+            throw_type_error(expected, actual);
+    }
+
+    static void require(const frame_t& frame, uint32_t seen, const char* key) {
+        if (!(frame.seen & seen))
+            throw_missing_key(key);
+    }
+
+    float number_at(size_t idx) const {
+        if (idx >= numbers.size())
+            throw json_t::out_of_range::create(401, "array index " + std::to_string(idx) + " is out of range", nullptr);
+        return float(numbers[idx]);
+    }
+
+    vec2f numbers_vec2() const {
+        return {number_at(0), number_at(1)};
+    }
+
+    static interpolation_t parse_interpolation(const std::string& type_str) {
+        if (type_str == "bezier")
+            return interpolation_t::bezier;
+        else if (type_str == "hold")
+            return interpolation_t::hold;
+        else if (type_str == "linear")
+            return interpolation_t::linear;
+        else
+            throw efx_builder_error("Invalid interpolation type '" + type_str + "'");
+    }
+
+    static efx_template_type parse_template_type(const std::string& type) {
+        if (type == "sprite")
+            return efx_template_type::sprite;
+        else if (type == "circle")
+            return efx_template_type::circle;
+        else if (type == "rect")
+            return efx_template_type::rect;
+        else
+            throw efx_builder_error("Invalid template type: '" + type + "'");
+    }
+
+    void set_animation_type(efx_anim_desc& anim, const std::string& type) {
+        if (type == "position") {
+            anim.type = efx_anim_type::position;
+            anim.keys = anim_key_sequence<vec2f>{};
+        }
+        else if (type == "scale") {
+            anim.type = efx_anim_type::scale;
+            anim.keys = anim_key_sequence<vec2f>{};
+        }
+        else if (type == "rotation") {
+            anim.type = efx_anim_type::rotation;
+            anim.keys = anim_key_sequence<float>{};
+        }
+        else if (type == "path") {
+            anim.type = efx_anim_type::path;
+        }
+        else {
+            throw efx_builder_error("Invalid animation type '" + type + "'");
+        }
+    }
+
+    template <typename T>
+    static anim_key<T> make_key(const raw_key_t& raw) {
+        auto type = raw.type;
+        if (type == interpolation_not_set && (raw.has_in || raw.has_out))
+            type = interpolation_t::bezier;
+        if (type == interpolation_not_set)
+            type = interpolation_t::linear;
+
+        T value;
+        if constexpr (std::is_same_v<T, float>) {
+            if (raw.value_is_array)
+                throw_type_error(value_kind::number, value_kind::array);
+            value = raw.value[0];
+        }
+        else {
+            if (!raw.value_is_array)
+                throw_type_error(value_kind::array, value_kind::number);
+            if (raw.value_size < 2)
+                throw json_t::out_of_range::create(
+                    401, "array index " + std::to_string(raw.value_size) + " is out of range", nullptr);
+            value = T{raw.value[0], raw.value[1]};
+        }
+
+        return anim_key<T>{value, raw.time, type, raw.in, raw.out};
+    }
+
+    void finish_animation() {
+        auto& anim = desc.animations.back();
+        std::visit(
+            [&]<typename T>(anim_key_sequence<T>& keys) {
+                for (auto&& raw : raw_keys) keys.push(make_key<T>(raw));
+            },
+            anim.keys);
+        raw_keys.clear();
+    }
+
+    bool on_open(value_kind kind) {
+        if (stack.empty()) {
+            expect(value_kind::object, kind);
+            stack.push_back({context_t::root, {}});
+            return true;
+        }
+
+        auto& top = stack.back();
+        if (top.context == context_t::skip) {
+            ++top.depth;
+            return true;
+        }
+
+        auto  next = context_t::skip;
+        auto& key  = current_key;
+
+        switch (top.context) {
+        case context_t::root:
+            if (key == "animations") {
+                expect(value_kind::array, kind);
+                top.seen |= seen_animations;
+                next = context_t::animations;
+            }
+            else if (key == "textures") {
+                expect(value_kind::object, kind);
+                next = context_t::textures;
+            }
+            else if (key == "templates") {
+                expect(value_kind::object, kind);
+                top.seen |= seen_templates;
+                next = context_t::templates;
+            }
+            else if (key == "primitives") {
+                expect(value_kind::array, kind);
+                top.seen |= seen_primitives;
+                next = context_t::primitives;
+            }
+            else if (key == "name" || key == "duration") {
+                throw_type_error(key == "name" ? value_kind::string : value_kind::number, kind);
+            }
+            break;
+        case context_t::animations:
+            expect(value_kind::object, kind);
+            desc.animations.emplace_back();
+            next = context_t::animation;
+            break;
+        case context_t::animation:
+            if (key == "keys") {
+                expect(value_kind::array, kind);
+                top.seen |= seen_keys;
+                next = context_t::keys;
+            }
+            else if (key == "points") {
+                expect(value_kind::array, kind);
+                top.seen |= seen_points;
+                next = context_t::points;
+            }
+            else if (key == "apply_to" && kind == value_kind::array) {
+                next = context_t::numbers;
+            }
+            else if (key == "name" || key == "type") {
+                throw_type_error(value_kind::string, kind);
+            }
+            else if (key == "max_error") {
+                throw_type_error(value_kind::number, kind);
+            }
+            else if (key == "closed" || key == "orient") {
+                throw_type_error(value_kind::boolean, kind);
+            }
+            break;
+        case context_t::keys:
+            expect(value_kind::object, kind);
+            raw_keys.emplace_back();
+            next = context_t::key;
+            break;
+        case context_t::key:
+            if (key == "value" || key == "in" || key == "out") {
+                expect(value_kind::array, kind);
+                next = context_t::numbers;
+            }
+            else if (key == "time") {
+                throw_type_error(value_kind::number, kind);
+            }
+            else if (key == "type") {
+                throw_type_error(value_kind::string, kind);
+            }
+            break;
+        case context_t::numbers: throw_type_error(value_kind::number, kind);
+        case context_t::points:
+            expect(value_kind::array, kind);
+            next = context_t::numbers;
+            break;
+        case context_t::textures:
+            expect(value_kind::object, kind);
+            desc.textures.push_back({key, {}});
+            next = context_t::texture;
+            break;
+        case context_t::templates:
+            expect(value_kind::object, kind);
+            desc.templates.emplace_back().name = key;
+            next = context_t::templ;
+            break;
+        case context_t::templ:
+            if (key == "source_rect" || key == "position" || key == "size" || key == "origin") {
+                expect(value_kind::array, kind);
+                next = context_t::numbers;
+            }
+            break;
+        case context_t::primitives:
+            expect(value_kind::object, kind);
+            next = context_t::primitive;
+            break;
+        default: break;
+        }
+
+        if (next == context_t::numbers)
+            numbers.clear();
+
+        stack.push_back({next, key});
+        return true;
+    }
+
+    bool on_close() {
+        auto& top = stack.back();
+        if (top.context == context_t::skip && top.depth > 0) {
+            --top.depth;
+            return true;
+        }
+
+        auto frame = std::move(stack.back());
+        stack.pop_back();
+
+        switch (frame.context) {
+        case context_t::root:
+            require(frame, seen_name, "name");
+            require(frame, seen_duration, "duration");
+            require(frame, seen_animations, "animations");
+            require(frame, seen_templates, "templates");
+            require(frame, seen_primitives, "primitives");
+            break;
+        case context_t::animation:
+            require(frame, seen_name, "name");
+            require(frame, seen_type, "type");
+            if (desc.animations.back().type == efx_anim_type::path)
+                require(frame, seen_points, "points");
+            else
+                require(frame, seen_keys, "keys");
+            finish_animation();
+            break;
+        case context_t::key:
+            require(frame, seen_time, "time");
+            require(frame, seen_value, "value");
+            break;
+        case context_t::texture: require(frame, seen_path, "path"); break;
+        case context_t::templ: require(frame, seen_type, "type"); break;
+        case context_t::primitive: require(frame, seen_template, "template"); break;
+        case context_t::numbers: on_numbers(frame.key); break;
+        default: break;
+        }
+
+        return true;
+    }
+
+    void on_numbers(const std::string& key) {
+        auto& parent = stack.back();
+
+        switch (parent.context) {
+        case context_t::animation: {
+            auto& anim = desc.animations.back();
+            anim.affected_indices.clear();
+            for (auto number : numbers) anim.affected_indices.push_back(efx::handler_t::index_t(number));
+            anim.apply_to_all = false;
+            break;
+        }
+        case context_t::points: desc.animations.back().points.push_back(numbers_vec2()); break;
+        case context_t::key: {
+            auto& raw = raw_keys.back();
+            if (key == "value") {
+                parent.seen |= seen_value;
+                raw.value_is_array = true;
+                raw.value_size     = numbers.size();
+                for (size_t i = 0; i < std::min(numbers.size(), raw.value.size()); ++i)
+                    raw.value[i] = float(numbers[i]);
+            }
+            else if (key == "in") {
+                raw.in     = numbers_vec2();
+                raw.has_in = true;
+            }
+            else if (key == "out") {
+                raw.out     = numbers_vec2();
+                raw.has_out = true;
+            }
+            break;
+        }
+        case context_t::templ: {
+            auto& tmpl = desc.templates.back();
+            if (key == "source_rect")
+                tmpl.source_rect = {int(number_at(0)), int(number_at(1)), int(number_at(2)), int(number_at(3))};
+            else if (key == "position")
+                tmpl.position = numbers_vec2();
+            else if (key == "size")
+                tmpl.size = numbers_vec2();
+            else if (key == "origin")
+                tmpl.origin = numbers_vec2();
+            break;
+        }
+        default: break;
+        }
+    }
+
+    bool on_scalar(value_kind kind) {
+        if (stack.empty())
+            throw_type_error(value_kind::object, kind);
+
+        auto& top = stack.back();
+        auto& key = current_key;
+
+        switch (top.context) {
+        case context_t::root:
+            if (key == "name") {
+                expect(value_kind::string, kind);
+                desc.name = string_value;
+                top.seen |= seen_name;
+            }
+            else if (key == "duration") {
+                expect(value_kind::number, kind);
+                desc.duration = float(number_value);
+                top.seen |= seen_duration;
+            }
+            else if (key == "animations" || key == "primitives") {
+                throw_type_error(value_kind::array, kind);
+            }
+            else if (key == "textures" || key == "templates") {
+                throw_type_error(value_kind::object, kind);
+            }
+            break;
+        case context_t::points: throw_type_error(value_kind::array, kind);
+        case context_t::animations:
+        case context_t::keys:
+        case context_t::textures:
+        case context_t::templates:
+        case context_t::primitives: throw_type_error(value_kind::object, kind);
+        case context_t::animation: {
+            auto& anim = desc.animations.back();
+            if (key == "name") {
+                expect(value_kind::string, kind);
+                anim.name = string_value;
+                top.seen |= seen_name;
+            }
+            else if (key == "type") {
+                expect(value_kind::string, kind);
+                set_animation_type(anim, string_value);
+                top.seen |= seen_type;
+            }
+            else if (key == "apply_to") {
+                if (kind == value_kind::string && string_value == "all")
+                    anim.apply_to_all = true;
+            }
+            else if (key == "max_error") {
+                expect(value_kind::number, kind);
+                anim.max_error = float(number_value);
+            }
+            else if (key == "closed" || key == "orient") {
+                expect(value_kind::boolean, kind);
+                (key == "closed" ? anim.closed : anim.orient) = boolean_value;
+            }
+            else if (key == "keys" || key == "points") {
+                throw_type_error(value_kind::array, kind);
+            }
+            break;
+        }
+        case context_t::key: {
+            auto& raw = raw_keys.back();
+            if (key == "time") {
+                expect(value_kind::number, kind);
+                raw.time = float(number_value);
+                top.seen |= seen_time;
+            }
+            else if (key == "value") {
+                expect(value_kind::number, kind);
+                raw.value[0] = float(number_value);
+                top.seen |= seen_value;
+            }
+            else if (key == "type") {
+                expect(value_kind::string, kind);
+                raw.type = parse_interpolation(string_value);
+            }
+            else if (key == "in" || key == "out") {
+                throw_type_error(value_kind::array, kind);
+            }
+            break;
+        }
+        case context_t::numbers:
+            expect(value_kind::number, kind);
+            numbers.push_back(number_value);
+            break;
+        case context_t::texture: {
+            auto& def = desc.textures.back().def;
+            if (key == "path") {
+                expect(value_kind::string, kind);
+                def.path = string_value;
+                top.seen |= seen_path;
+            }
+            else if (key == "smooth" || key == "srgb" || key == "repeated") {
+                expect(value_kind::boolean, kind);
+                (key == "smooth" ? def.smooth : key == "srgb" ? def.srgb : def.repeated) = boolean_value;
+            }
+            else if (key == "mipmap") {
+                expect(value_kind::boolean, kind);
+                def.mipmap = boolean_value;
+            }
+            else if (key == "variants") {
+                expect(value_kind::number, kind);
+                def.variants = uint32_t(number_value);
+            }
+            break;
+        }
+        case context_t::templ: {
+            auto& tmpl = desc.templates.back();
+            if (key == "type") {
+                expect(value_kind::string, kind);
+                tmpl.type = parse_template_type(string_value);
+                top.seen |= seen_type;
+            }
+            else if (key == "texture") {
+                expect(value_kind::string, kind);
+                tmpl.texture = string_value;
+            }
+            else if (key == "color" || key == "fill_color") {
+                expect(value_kind::string, kind);
+                (key == "color" ? tmpl.color : tmpl.fill_color) = rgba_t::from_str(string_value);
+            }
+            else if (key == "radius" || key == "rotation") {
+                expect(value_kind::number, kind);
+                (key == "radius" ? tmpl.radius : tmpl.rotation) = float(number_value);
+            }
+            else if (key == "point_count") {
+                expect(value_kind::number, kind);
+                tmpl.point_count = unsigned(number_value);
+            }
+            else if (key == "source_rect" || key == "position" || key == "size" || key == "origin") {
+                throw_type_error(value_kind::array, kind);
+            }
+            break;
+        }
+        case context_t::primitive:
+            if (key == "template") {
+                expect(value_kind::string, kind);
+                desc.primitives.push_back(string_value);
+                top.seen |= seen_template;
+            }
+            break;
+        default: break;
+        }
+
+        return true;
+    }
+
+private:
+    efx_desc               desc;
+    std::vector<frame_t>   stack;
+    std::vector<raw_key_t> raw_keys;
+    std::vector<double>    numbers;
+    std::string            current_key;
+    std::string            string_value;
+    double                 number_value  = 0.0;
+    bool                   boolean_value = false;
+};
+
+/*
+ * Same interface as efx_builder, the file is parsed in the constructor without keeping the json document
+ */
+class efx_sax_builder {
+public:
+    using build_result_t = efx_build_result;
+
+    efx_sax_builder(texture_mgr&               texture_manager,
+                    const std::string&         effect_path,
+                    const core::resource_pack* pack = nullptr):
+        tx_mgr(&texture_manager) {
+        auto file = open_effect_file(effect_path, pack);
+        auto data = reinterpret_cast<const char*>(file.data());
+
+        efx_sax_handler handler;
+        nlohmann::json::sax_parse(data, data + file.size(), &handler);
+        desc = std::move(handler.get_desc());
+    }
+
+    build_result_t build() const {
+        return efx_assembler(*tx_mgr).assemble(desc);
+    }
+
+    const efx_desc& describe() const {
+        return desc;
+    }
+
+private:
+    texture_mgr* tx_mgr;
+    efx_desc     desc;
+};
+} // namespace grx::efx_editor
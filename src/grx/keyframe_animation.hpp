@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+#include <optional>
 #include <vector>
 
 #include "core/math.hpp"
@@ -66,20 +68,30 @@ public:
         while (i != keys.end() && i->time < time)
             ++i;
 
-        auto k2 = i;
-        if (k2 == keys.end())
+        return lookup_segment(size_t(i - keys.begin()), time);
+    }
+
+    /* Evaluates the segment which ends at the key idx, idx == keys.size() stands for the time after the last key */
+    T lookup_segment(size_t idx, float time) const {
+        if (keys.empty())
+            return {};
+
+        if (keys.size() == 1 || idx >= keys.size())
             return keys.back().value;
 
         anim_key<T> k1;
-        if (k2 == keys.begin())
+        if (idx == 0)
             k1 = anim_key<T>{{}, 0, interpolation_t::linear};
         else
-            k1 = *(k2 - 1);
+            k1 = keys[idx - 1];
 
-        return interpolate(k1, *k2, time);
+        return interpolate(k1, keys[idx], time);
+    }
+
+    const auto& get_keys() const {
+        return keys;
     }
 
-private:
     static T interpolate(const anim_key<T>& k1, const anim_key<T>& k2, float time) {
         if (k2.interpolation == interpolation_t::hold)
             return k1.value;
@@ -106,4 +118,101 @@ private:
 private:
     std::vector<anim_key<T>> keys;
 };
+
+struct anim_transform {
+    std::optional<core::vec2f> position;
+    std::optional<core::vec2f> scale;
+    std::optional<float>       rotation;
+};
+
+/*
+ * Position, scale and rotation channels sharing one timeline
+ *
+ * The timeline holds the union of all channel key times and, for every timeline segment,
+ * the segment index of each channel, so a single search resolves all three channels
+ */
+class anim_transform_track {
+public:
+    void set_position(anim_key_sequence<core::vec2f> keys) {
+        position = std::move(keys);
+        build_timeline();
+    }
+
+    void set_scale(anim_key_sequence<core::vec2f> keys) {
+        scale = std::move(keys);
+        build_timeline();
+    }
+
+    void set_rotation(anim_key_sequence<float> keys) {
+        rotation = std::move(keys);
+        build_timeline();
+    }
+
+    bool has_position() const {
+        return position.has_value();
+    }
+
+    bool has_scale() const {
+        return scale.has_value();
+    }
+
+    bool has_rotation() const {
+        return rotation.has_value();
+    }
+
+    anim_transform lookup(float time) const {
+        auto  segment = size_t(std::lower_bound(times.begin(), times.end(), time) - times.begin());
+        auto& idxs    = segments[segment];
+
+        anim_transform result;
+        if (position)
+            result.position = position->lookup_segment(idxs[0], time);
+        if (scale)
+            result.scale = scale->lookup_segment(idxs[1], time);
+        if (rotation)
+            result.rotation = rotation->lookup_segment(idxs[2], time);
+        return result;
+    }
+
+private:
+    static void append_times(std::vector<float>& result, const auto& channel) {
+        if (channel)
+            for (auto&& key : channel->get_keys()) result.push_back(key.time);
+    }
+
+    static uint32_t channel_segment(const auto& channel, float time) {
+        if (!channel)
+            return 0;
+        auto& keys = channel->get_keys();
+        return uint32_t(std::find_if(keys.begin(), keys.end(), [time](auto&& key) { return key.time >= time; }) -
+                        keys.begin());
+    }
+
+    static uint32_t channel_size(const auto& channel) {
+        return channel ? uint32_t(channel->get_keys().size()) : 0;
+    }
+
+    void build_timeline() {
+        times.clear();
+        append_times(times, position);
+        append_times(times, scale);
+        append_times(times, rotation);
+        std::sort(times.begin(), times.end());
+        times.erase(std::unique(times.begin(), times.end()), times.end());
+
+        /* One extra segment for the time after the last key */
+        segments.clear();
+        for (auto time : times)
+            segments.push_back(
+                {channel_segment(position, time), channel_segment(scale, time), channel_segment(rotation, time)});
+        segments.push_back({channel_size(position), channel_size(scale), channel_size(rotation)});
+    }
+
+private:
+    std::optional<anim_key_sequence<core::vec2f>> position;
+    std::optional<anim_key_sequence<core::vec2f>> scale;
+    std::optional<anim_key_sequence<float>>       rotation;
+    std::vector<float>                            times;
+    std::vector<std::array<uint32_t, 3>>          segments = {{0, 0, 0}};
+};
 }; // namespace grx
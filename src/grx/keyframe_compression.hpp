@@ -0,0 +1,288 @@
+#pragma once
+
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "keyframe_animation.hpp"
+
+namespace grx
+{
+template <typename T>
+struct anim_value_components {
+    static constexpr size_t count = T::size();
+
+    static float get(const T& value, size_t i) {
+        return float(value.v[i]);
+    }
+
+    static void set(T& value, size_t i, float component) {
+        value.v[i] = typename T::value_type(component);
+    }
+};
+
+template <std::floating_point T>
+struct anim_value_components<T> {
+    static constexpr size_t count = 1;
+
+    static float get(const T& value, size_t) {
+        return float(value);
+    }
+
+    static void set(T& value, size_t, float component) {
+        value = T(component);
+    }
+};
+
+/*
+ * Read-only compact form of anim_key_sequence
+ *
+ * Times, values and bezier tangents are quantized to 16 bits against per-track ranges,
+ * interpolation types are packed by 2 bits per key and tangents are stored only for bezier keys.
+ * With max_error > 0 linear keys that can be dropped without exceeding the error are removed before encoding.
+ */
+template <typename T>
+class compact_anim_key_sequence {
+public:
+    using components = anim_value_components<T>;
+
+    static inline constexpr size_t components_count = components::count;
+    static inline constexpr size_t keys_per_word    = 16;
+
+    compact_anim_key_sequence() = default;
+
+    explicit compact_anim_key_sequence(const anim_key_sequence<T>& sequence, float max_error = 0.f) {
+        if (max_error > 0.f)
+            encode(reduce_keys(sequence.get_keys(), max_error));
+        else
+            encode(sequence.get_keys());
+    }
+
+    T lookup(float time) const {
+        if (times.empty())
+            return {};
+
+        if (times.size() == 1)
+            return decode_value(0);
+
+        /* First key with time >= requested time, same as anim_key_sequence::lookup */
+        size_t first = 0;
+        size_t last  = times.size();
+        while (first < last) {
+            auto middle = first + (last - first) / 2;
+            if (decode_time(middle) < time)
+                first = middle + 1;
+            else
+                last = middle;
+        }
+
+        if (first == times.size())
+            return decode_value(times.size() - 1);
+
+        anim_key<T> k1;
+        if (first == 0)
+            k1 = anim_key<T>{{}, 0, interpolation_t::linear};
+        else
+            k1 = decode_key(first - 1);
+
+        return anim_key_sequence<T>::interpolate(k1, decode_key(first), time);
+    }
+
+    anim_key<T> decode_key(size_t idx) const {
+        anim_key<T> key{decode_value(idx), decode_time(idx), decode_interpolation(idx)};
+        if (key.interpolation == interpolation_t::bezier) {
+            auto tangent = tangents.data() + tangent_index(idx) * 4;
+            key.in       = core::vec2f{tangent_range.decode(tangent[0]), tangent_range.decode(tangent[1])};
+            key.out      = core::vec2f{tangent_range.decode(tangent[2]), tangent_range.decode(tangent[3])};
+        }
+        return key;
+    }
+
+    size_t size() const {
+        return times.size();
+    }
+
+    size_t memory_usage() const {
+        return sizeof(*this) + times.capacity() * sizeof(uint16_t) + values.capacity() * sizeof(uint16_t) +
+               tangents.capacity() * sizeof(uint16_t) + interpolations.capacity() * sizeof(uint32_t) +
+               bezier_ranks.capacity() * sizeof(uint32_t);
+    }
+
+private:
+    struct quantization_range {
+        float min   = 0.f;
+        float scale = 0.f;
+
+        static constexpr auto quant_max = float(std::numeric_limits<uint16_t>::max());
+
+        static quantization_range from_bounds(float min, float max) {
+            return {min, (max - min) / quant_max};
+        }
+
+        uint16_t encode(float value) const {
+            if (scale == 0.f)
+                return 0;
+            return uint16_t(core::clamp(std::round((value - min) / scale), 0.f, quant_max));
+        }
+
+        float decode(uint16_t value) const {
+            return min + float(value) * scale;
+        }
+    };
+
+    static quantization_range bounds_of(auto&& begin, auto&& end, auto&& get) {
+        if (begin == end)
+            return {};
+
+        auto min = std::numeric_limits<float>::max();
+        auto max = std::numeric_limits<float>::lowest();
+        for (auto i = begin; i != end; ++i) {
+            auto v = get(*i);
+            min    = std::min(min, v);
+            max    = std::max(max, v);
+        }
+        return quantization_range::from_bounds(min, max);
+    }
+
+    static uint32_t interpolation_code(interpolation_t interpolation) {
+        switch (interpolation) {
+        case interpolation_t::hold: return 0;
+        case interpolation_t::bezier: return 2;
+        default: return 1;
+        }
+    }
+
+    void encode(const std::vector<anim_key<T>>& keys) {
+        auto b = keys.begin();
+        auto e = keys.end();
+
+        time_range = bounds_of(b, e, [](auto&& key) { return key.time; });
+        for (size_t c = 0; c < components_count; ++c)
+            value_ranges[c] = bounds_of(b, e, [c](auto&& key) { return components::get(key.value, c); });
+
+        auto tangent_min = std::numeric_limits<float>::max();
+        auto tangent_max = std::numeric_limits<float>::lowest();
+        for (auto&& key : keys) {
+            if (key.interpolation != interpolation_t::bezier)
+                continue;
+            for (auto v : {key.in.x(), key.in.y(), key.out.x(), key.out.y()}) {
+                tangent_min = std::min(tangent_min, v);
+                tangent_max = std::max(tangent_max, v);
+            }
+        }
+        if (tangent_min <= tangent_max)
+            tangent_range = quantization_range::from_bounds(tangent_min, tangent_max);
+
+        times.reserve(keys.size());
+        values.reserve(keys.size() * components_count);
+        interpolations.resize((keys.size() + keys_per_word - 1) / keys_per_word, 0);
+        bezier_ranks.resize(interpolations.size(), 0);
+
+        uint32_t bezier_count = 0;
+        for (size_t idx = 0; idx < keys.size(); ++idx) {
+            auto& key = keys[idx];
+
+            if (idx % keys_per_word == 0)
+                bezier_ranks[idx / keys_per_word] = bezier_count;
+
+            times.push_back(time_range.encode(key.time));
+            for (size_t c = 0; c < components_count; ++c)
+                values.push_back(value_ranges[c].encode(components::get(key.value, c)));
+
+            auto code = interpolation_code(key.interpolation);
+            interpolations[idx / keys_per_word] |= code << ((idx % keys_per_word) * 2);
+
+            if (code == 2) {
+                for (auto v : {key.in.x(), key.in.y(), key.out.x(), key.out.y()})
+                    tangents.push_back(tangent_range.encode(v));
+                ++bezier_count;
+            }
+        }
+    }
+
+    float decode_time(size_t idx) const {
+        return time_range.decode(times[idx]);
+    }
+
+    T decode_value(size_t idx) const {
+        T value{};
+        for (size_t c = 0; c < components_count; ++c)
+            components::set(value, c, value_ranges[c].decode(values[idx * components_count + c]));
+        return value;
+    }
+
+    interpolation_t decode_interpolation(size_t idx) const {
+        return interpolation_t((interpolations[idx / keys_per_word] >> ((idx % keys_per_word) * 2)) & 0b11);
+    }
+
+    size_t tangent_index(size_t idx) const {
+        auto word    = interpolations[idx / keys_per_word];
+        auto bezier  = (word >> 1) & ~word & 0x55555555u;
+        auto below   = bezier & ((1u << ((idx % keys_per_word) * 2)) - 1u);
+        return bezier_ranks[idx / keys_per_word] + size_t(std::popcount(below));
+    }
+
+    static float max_component_error(const T& a, const T& b) {
+        float error = 0.f;
+        for (size_t c = 0; c < components_count; ++c)
+            error = std::max(error, std::fabs(components::get(a, c) - components::get(b, c)));
+        return error;
+    }
+
+    /* Checks that keys between first and last can be replaced by a single linear segment */
+    static bool is_reducible(const std::vector<anim_key<T>>& keys, size_t first, size_t last, float max_error) {
+        auto& k1 = keys[first];
+        auto& k2 = keys[last];
+
+        if (k1.interpolation == interpolation_t::bezier || k1.time == k2.time)
+            return false;
+
+        for (size_t i = first + 1; i <= last; ++i)
+            if (keys[i].interpolation != interpolation_t::linear)
+                return false;
+
+        /* Both curves are piecewise linear, so the max error is reached at one of the removed keys */
+        for (size_t i = first + 1; i < last; ++i) {
+            auto approx = core::lerp(k1.value, k2.value, core::inverse_lerp(k1.time, k2.time, keys[i].time));
+            if (max_component_error(approx, keys[i].value) > max_error)
+                return false;
+        }
+
+        return true;
+    }
+
+    static std::vector<anim_key<T>> reduce_keys(const std::vector<anim_key<T>>& keys, float max_error) {
+        if (keys.size() < 3)
+            return keys;
+
+        std::vector<anim_key<T>> result{keys.front()};
+
+        size_t last_kept = 0;
+        for (size_t i = 1; i + 1 < keys.size(); ++i) {
+            if (!is_reducible(keys, last_kept, i + 1, max_error)) {
+                result.push_back(keys[i]);
+                last_kept = i;
+            }
+        }
+        result.push_back(keys.back());
+
+        return result;
+    }
+
+private:
+    std::vector<uint16_t>                             times;
+    std::vector<uint16_t>                             values;
+    std::vector<uint16_t>                             tangents;
+    std::vector<uint32_t>                             interpolations;
+    std::vector<uint32_t>                             bezier_ranks;
+    quantization_range                                time_range;
+    std::array<quantization_range, components_count> value_ranges;
+    quantization_range                                tangent_range;
+};
+
+/* Key sequences of values of type T efx handlers look up, full or compact */
+template <typename K, typename T>
+concept anim_keys_of = std::same_as<K, anim_key_sequence<T>> || std::same_as<K, compact_anim_key_sequence<T>>;
+} // namespace grx
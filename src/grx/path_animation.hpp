@@ -0,0 +1,234 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <numbers>
+#include <utility>
+#include <vector>
+
+#include "core/fastmath.hpp"
+#include "core/vec.hpp"
+
+namespace grx
+{
+struct anim_path_sample {
+    core::vec2f position;
+    float       rotation; /* Degrees of the tangent as sf::Transformable takes them */
+};
+
+/*
+ * Centripetal Catmull-Rom spline through control points, which does not overshoot or loop on uneven spacing
+ *
+ * The arc length lookup table holds spline parameters and their derivatives by distance at evenly spaced
+ * distances along the path, the parameter between them is a cubic Hermite interpolation. So lookup moves with
+ * constant speed and costs one table read and two cubic evaluations whatever the number of points is.
+ * The table has samples_per_segment entries per segment, sharp turns between sparse points slow down within
+ * an entry and need more of them, smooth paths keep the speed within a fraction of a percent with the default.
+ * Open paths extend their ends by mirrored points, closed paths connect the last point to the first one
+ */
+class anim_path {
+public:
+    static constexpr size_t default_samples_per_segment = 32;
+
+    anim_path() = default;
+
+    anim_path(const std::vector<core::vec2f>& points,
+              bool                            iclosed             = false,
+              size_t                          samples_per_segment = default_samples_per_segment):
+        closed(iclosed) {
+        build_segments(points);
+        build_lut(std::max<size_t>(samples_per_segment, 1));
+    }
+
+    /* Coefficients of p(t) = ((a * t + b) * t + c) * t + d for t in [0, 1] */
+    struct segment_t {
+        core::vec2f a, b, c, d;
+    };
+
+    /*
+     * Position and tangent at the fraction of the path length, clamped to [0, 1] for open paths and wrapped for
+     * closed ones. The tangent of an empty or single point path is zero
+     */
+    anim_path_sample lookup(float fraction) const {
+        if (segments.empty())
+            return {single_point, 0.f};
+
+        auto [s, t]   = locate(param_at(fraction));
+        auto tangent  = (s.a * (3.f * t) + s.b * 2.f) * t + s.c;
+        auto rotation = core::fastmath::atan2(tangent.y(), tangent.x()) * float(180. / std::numbers::pi);
+        return {((s.a * t + s.b) * t + s.c) * t + s.d, rotation};
+    }
+
+    /* Position only, without the atan2 of lookup */
+    core::vec2f position(float fraction) const {
+        return segments.empty() ? single_point : evaluate(param_at(fraction));
+    }
+
+    float length() const {
+        return total_length;
+    }
+
+    bool is_closed() const {
+        return closed;
+    }
+
+    const auto& get_segments() const {
+        return segments;
+    }
+
+private:
+    void build_segments(std::vector<core::vec2f> points) {
+        /* Coincident neighbours give zero knot intervals */
+        auto coincident = [](auto&& a, auto&& b) { return (a - b).magnitude_2() == 0.f; };
+        points.erase(std::unique(points.begin(), points.end(), coincident), points.end());
+        if (closed && points.size() > 1 && coincident(points.front(), points.back()))
+            points.pop_back();
+
+        if (points.size() < 2) {
+            single_point = points.empty() ? core::vec2f{0, 0} : points.front();
+            closed       = false;
+            return;
+        }
+
+        auto count = points.size();
+        auto at    = [&](ptrdiff_t i) {
+            if (closed)
+                return points[size_t((i + ptrdiff_t(count)) % ptrdiff_t(count))];
+            if (i < 0)
+                return points[0] * 2.f - points[1];
+            if (i >= ptrdiff_t(count))
+                return points[count - 1] * 2.f - points[count - 2];
+            return points[size_t(i)];
+        };
+
+        auto segments_count = closed ? count : count - 1;
+        for (size_t i = 0; i < segments_count; ++i) {
+            auto p0 = at(ptrdiff_t(i) - 1);
+            auto p1 = at(ptrdiff_t(i));
+            auto p2 = at(ptrdiff_t(i) + 1);
+            auto p3 = at(ptrdiff_t(i) + 2);
+
+            /* Knot intervals are square roots of the chord lengths */
+            auto dt0 = std::sqrt((p1 - p0).magnitude());
+            auto dt1 = std::sqrt((p2 - p1).magnitude());
+            auto dt2 = std::sqrt((p3 - p2).magnitude());
+
+            /* Hermite tangents of the non-uniform spline scaled to the [0, 1] segment parameter */
+            auto m1 = ((p1 - p0) / dt0 - (p2 - p0) / (dt0 + dt1) + (p2 - p1) / dt1) * dt1;
+            auto m2 = ((p2 - p1) / dt1 - (p3 - p1) / (dt1 + dt2) + (p3 - p2) / dt2) * dt1;
+
+            segments.push_back({p1 * 2.f - p2 * 2.f + m1 + m2, p2 * 3.f - p1 * 3.f - m1 * 2.f - m2, m1, p1});
+        }
+    }
+
+    float param_at(float fraction) const {
+        fraction = closed ? fraction - std::floor(fraction) : std::clamp(fraction, 0.f, 1.f);
+
+        auto pos = fraction * float(lut.size() - 1);
+        auto idx = std::min(size_t(pos), lut.size() - 2);
+        auto t   = pos - float(idx);
+        auto t2  = t * t;
+        auto t3  = t2 * t;
+
+        auto& e0 = lut[idx];
+        auto& e1 = lut[idx + 1];
+        return e0.param * (2 * t3 - 3 * t2 + 1) + e0.slope * (t3 - 2 * t2 + t) + e1.param * (3 * t2 - 2 * t3) +
+               e1.slope * (t3 - t2);
+    }
+
+    /* Segment and its local parameter for the spline parameter, whose integer part is the segment index */
+    std::pair<const segment_t&, float> locate(float param) const {
+        auto idx = std::min(size_t(param), segments.size() - 1);
+        return {segments[idx], param - float(idx)};
+    }
+
+    core::vec2f evaluate(float param) const {
+        auto [s, t] = locate(param);
+        return ((s.a * t + s.b) * t + s.c) * t + s.d;
+    }
+
+    double speed(double param) const {
+        auto [s, t] = locate(float(param));
+        return ((s.a * (3.f * t) + s.b * 2.f) * t + s.c).magnitude();
+    }
+
+    /* Arc length between the parameters by 5 point Gauss-Legendre quadrature */
+    double arc_length(double from, double to) const {
+        constexpr std::array<double, 5> nodes   = {0., -0.5384693101056831, 0.5384693101056831, -0.9061798459386640,
+                                                   0.9061798459386640};
+        constexpr std::array<double, 5> weights = {0.5688888888888889, 0.4786286704993665, 0.4786286704993665,
+                                                   0.2369268850561891, 0.2369268850561891};
+
+        auto half = (to - from) / 2;
+        auto mid  = (to + from) / 2;
+        auto sum  = 0.;
+        for (size_t i = 0; i < nodes.size(); ++i) sum += weights[i] * speed(mid + half * nodes[i]);
+        return sum * half;
+    }
+
+    /*
+     * Arc lengths are integrated over samples_per_segment steps of every segment, the table has as many entries,
+     * their parameters are refined by Newton steps on the integrated length
+     */
+    void build_lut(size_t samples_per_segment) {
+        if (segments.empty())
+            return;
+
+        auto count = segments.size() * samples_per_segment;
+        auto step  = 1. / double(samples_per_segment);
+
+        std::vector<double> distances(count + 1, 0.);
+        for (size_t i = 1; i <= count; ++i)
+            distances[i] = distances[i - 1] + arc_length(double(i - 1) * step, double(i) * step);
+        total_length = float(distances.back());
+
+        lut.resize(count + 1);
+        auto   spacing = distances.back() / double(count);
+        size_t j       = 0;
+        for (size_t i = 0; i <= count; ++i) {
+            auto distance = spacing * double(i);
+            while (j + 1 < count && distances[j + 1] < distance) ++j;
+
+            auto from  = double(j) * step;
+            auto span  = distances[j + 1] - distances[j];
+            auto param = from + (span > 0. ? std::clamp((distance - distances[j]) / span, 0., 1.) * step : 0.);
+            for (int iteration = 0; iteration < 2; ++iteration) {
+                auto error = distances[j] + arc_length(from, param) - distance;
+                auto v     = speed(param);
+                if (v <= 0.)
+                    break;
+                param = std::clamp(param - error / v, from, from + step);
+            }
+
+            auto v = speed(param);
+            lut[i] = {float(param), v > 0. ? float(spacing / v) : 0.f};
+        }
+
+        /* Slopes limited as Fritsch-Carlson do keep the parameter monotonic near stationary points */
+        for (size_t i = 0; i <= count; ++i) {
+            auto limit = std::numeric_limits<float>::infinity();
+            if (i > 0)
+                limit = std::min(limit, 3 * (lut[i].param - lut[i - 1].param));
+            if (i < count)
+                limit = std::min(limit, 3 * (lut[i + 1].param - lut[i].param));
+            if (lut[i].slope == 0.f || lut[i].slope > limit)
+                lut[i].slope = limit;
+        }
+    }
+
+private:
+    /* Spline parameter and its derivative by lookup table position */
+    struct lut_entry_t {
+        float param;
+        float slope;
+    };
+
+    std::vector<segment_t>   segments;
+    std::vector<lut_entry_t> lut;
+    core::vec2f            single_point = {0, 0};
+    float                  total_length = 0.f;
+    bool                   closed       = false;
+};
+} // namespace grx
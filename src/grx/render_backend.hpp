@@ -0,0 +1,204 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <variant>
+#include <vector>
+
+#include <SFML/Graphics/RenderTarget.hpp>
+#include <SFML/Graphics/Vertex.hpp>
+#include <SFML/Graphics/View.hpp>
+
+#include "core/affine2.hpp"
+#include "sfml_types.hpp"
+
+namespace grx
+{
+/*
+ * What scene draws to: elements and vertex arrays with render states, plus the view for texture variant selection
+ * sfml_backend draws to a sf::RenderTarget, recording_backend only records the commands and needs no GL context
+ */
+class render_backend {
+public:
+    virtual ~render_backend() = default;
+
+    virtual void draw(const drawable_t& element, const sf::RenderStates& states) = 0;
+
+    virtual void
+    draw(const sf::Vertex* vertices, size_t count, sf::PrimitiveType type, const sf::RenderStates& states) = 0;
+
+    virtual const sf::View& get_view() const = 0;
+
+    virtual sf::IntRect get_viewport(const sf::View& view) const = 0;
+};
+
+class sfml_backend : public render_backend {
+public:
+    sfml_backend(sf::RenderTarget& itarget): target(&itarget) {}
+
+    void draw(const drawable_t& element, const sf::RenderStates& states) override {
+        downcast(element, [&](const sf::Drawable& drawable) { target->draw(drawable, states); });
+    }
+
+    void draw(const sf::Vertex* vertices, size_t count, sf::PrimitiveType type, const sf::RenderStates& states)
+        override {
+        target->draw(vertices, count, type, states);
+    }
+
+    const sf::View& get_view() const override {
+        return target->getView();
+    }
+
+    sf::IntRect get_viewport(const sf::View& view) const override {
+        return target->getViewport(view);
+    }
+
+private:
+    sf::RenderTarget* target;
+};
+
+struct render_command {
+    enum class source_t : uint8_t { element = 0, vertices };
+
+    source_t           source;
+    size_t             element_type; /* Index of the drawable_t alternative, elements only */
+    sf::PrimitiveType  primitive;
+    size_t             first_vertex; /* In recording_backend::get_vertices(), vertex arrays only */
+    size_t             vertex_count;
+    const sf::Texture* texture;
+    const sf::Shader*  shader;
+    sf::BlendMode      blend_mode;
+    core::affine2f     transform; /* Render states transform combined with the element transform */
+};
+
+/*
+ * Records draw commands instead of drawing, for benchmarks and tests on machines without GPU
+ *
+ * Each command is one draw call SFML would issue, with its primitive and vertex count: sprites a strip of 4,
+ * shapes a fan of their points and, if outlined, an untextured outline strip as a second command,
+ * text triangles of 6 vertices per visible character. Vertex arrays are copied if keep_vertices is set
+ * The view is the default one of a target of the given size until set_view
+ */
+class recording_backend : public render_backend {
+public:
+    recording_backend(sf::Vector2u isize = {1920, 1080}, bool ikeep_vertices = true):
+        view(sf::FloatRect(0.f, 0.f, float(isize.x), float(isize.y))), size(isize), keep_vertices(ikeep_vertices) {}
+
+    void draw(const drawable_t& element, const sf::RenderStates& states) override {
+        auto info      = std::visit([](auto&& obj) { return describe(obj); }, element);
+        auto transform = std::visit([](auto&& obj) { return core::affine2f(obj.getTransform()); }, element);
+
+        for (size_t i = 0; i < info.parts_count; ++i) {
+            auto& part = info.parts[i];
+            commands.push_back({
+                .source       = render_command::source_t::element,
+                .element_type = element.index(),
+                .primitive    = part.primitive,
+                .first_vertex = 0,
+                .vertex_count = part.vertex_count,
+                .texture      = part.texture,
+                .shader       = states.shader,
+                .blend_mode   = states.blendMode,
+                .transform    = core::affine2f(states.transform) * transform,
+            });
+            vertex_count += part.vertex_count;
+        }
+    }
+
+    void draw(const sf::Vertex* ivertices, size_t count, sf::PrimitiveType type, const sf::RenderStates& states)
+        override {
+        commands.push_back({
+            .source       = render_command::source_t::vertices,
+            .element_type = 0,
+            .primitive    = type,
+            .first_vertex = vertices.size(),
+            .vertex_count = count,
+            .texture      = states.texture,
+            .shader       = states.shader,
+            .blend_mode   = states.blendMode,
+            .transform    = core::affine2f(states.transform),
+        });
+        vertex_count += count;
+
+        if (keep_vertices)
+            vertices.insert(vertices.end(), ivertices, ivertices + count);
+    }
+
+    const sf::View& get_view() const override {
+        return view;
+    }
+
+    /* Same rounding as sf::RenderTarget::getViewport */
+    sf::IntRect get_viewport(const sf::View& iview) const override {
+        auto& rect = iview.getViewport();
+        return {int(0.5f + float(size.x) * rect.left),
+                int(0.5f + float(size.y) * rect.top),
+                int(0.5f + float(size.x) * rect.width),
+                int(0.5f + float(size.y) * rect.height)};
+    }
+
+    void set_view(const sf::View& value) {
+        view = value;
+    }
+
+    const auto& get_commands() const {
+        return commands;
+    }
+
+    const auto& get_vertices() const {
+        return vertices;
+    }
+
+    size_t get_vertex_count() const {
+        return vertex_count;
+    }
+
+    /* Drops recorded commands and vertices, the memory is kept for the next frame */
+    void clear() {
+        commands.clear();
+        vertices.clear();
+        vertex_count = 0;
+    }
+
+private:
+    struct element_part {
+        sf::PrimitiveType  primitive;
+        size_t             vertex_count;
+        const sf::Texture* texture;
+    };
+
+    /* Draw calls SFML makes for the element, as sf::Sprite, sf::Shape and sf::Text draw */
+    struct element_info {
+        std::array<element_part, 2> parts;
+        size_t                      parts_count;
+    };
+
+    static element_info describe(const sf::Sprite& sprite) {
+        return {{{{sf::TriangleStrip, 4, sprite.getTexture()}}}, 1};
+    }
+
+    static element_info describe(const sf::Shape& shape) {
+        auto         points = shape.getPointCount();
+        element_info info{{{{sf::TriangleFan, points + 2, shape.getTexture()}}}, 1};
+        if (shape.getOutlineThickness() != 0.f)
+            info.parts[info.parts_count++] = {sf::TriangleStrip, (points + 1) * 2, nullptr};
+        return info;
+    }
+
+    static element_info describe(const sf::Text& text) {
+        size_t count = 0;
+        for (auto c : text.getString())
+            if (c != ' ' && c != '\t' && c != '\n')
+                count += 6;
+        return {{{{sf::Triangles, count, nullptr}}}, 1};
+    }
+
+private:
+    std::vector<render_command> commands;
+    std::vector<sf::Vertex>     vertices;
+    sf::View                    view;
+    sf::Vector2u                size;
+    size_t                      vertex_count  = 0;
+    bool                        keep_vertices = true;
+};
+} // namespace grx
@@ -2,14 +2,21 @@
 
 #include <iostream>
 
+#include <array>
+#include <cmath>
 #include <cstdint>
 #include <map>
 #include <vector>
 
 #include <SFML/Graphics/RenderTarget.hpp>
+#include <SFML/Graphics/Vertex.hpp>
 
+#include "core/affine2.hpp"
+#include "core/profiler.hpp"
 #include "core/vec.hpp"
+#include "render_backend.hpp"
 #include "sfml_types.hpp"
+#include "texture_variants.hpp"
 
 namespace grx
 {
@@ -21,6 +28,132 @@ public:
 
     static inline constexpr auto empty_id = std::numeric_limits<id_t>::max();
 
+    /*
+     * Issues draw calls for elements in order
+     * With vertices buffer consecutive sprites using the same texture are merged into one call,
+     * their quads are transformed on CPU with affine2f
+     * With texture variants sprites are drawn with the downscaled texture nearest to their size on screen
+     */
+    class draw_context {
+    public:
+        draw_context(render_backend&          itarget,
+                     const sf::RenderStates&  irender_states,
+                     std::vector<sf::Vertex>* ivertices = nullptr,
+                     const texture_variants*  ivariants = nullptr):
+            target(&itarget), render_states(irender_states), vertices(ivertices), variants(ivariants) {
+            if (variants) {
+                auto& view       = target->get_view();
+                view_scale       = float(target->get_viewport(view).width) / view.getSize().x;
+                states_transform = core::affine2f(render_states.transform);
+            }
+        }
+
+        void draw(const drawable_t& element, const core::affine2f& transform) {
+            if (vertices || variants) {
+                if (auto sprite = std::get_if<sf::Sprite>(&element)) {
+                    add_sprite(*sprite, transform);
+                    return;
+                }
+            }
+
+            flush();
+
+            auto element_states = render_states;
+            element_states.transform.combine(transform);
+            target->draw(element, element_states);
+            ++draw_calls;
+        }
+
+        void flush() {
+            if (!vertices || vertices->empty())
+                return;
+
+            auto batch_states    = render_states;
+            batch_states.texture = texture;
+            target->draw(vertices->data(), vertices->size(), sf::Triangles, batch_states);
+            vertices->clear();
+            ++draw_calls;
+        }
+
+        size_t get_draw_calls() const {
+            return draw_calls;
+        }
+
+    private:
+        /* Without vertices buffer the sprite is drawn at once */
+        void add_sprite(const sf::Sprite& sprite, const core::affine2f& transform) {
+            auto sprite_texture = sprite.getTexture();
+            if (!sprite_texture)
+                return;
+
+            auto matrix   = transform * core::affine2f(sprite.getTransform());
+            auto selected = select_texture(sprite_texture, matrix);
+            auto quad     = make_quad(sprite, matrix, selected.texcoord_scale);
+
+            if (!vertices) {
+                auto sprite_states    = render_states;
+                sprite_states.texture = selected.texture;
+                target->draw(quad.data(), quad.size(), sf::Triangles, sprite_states);
+                ++draw_calls;
+                return;
+            }
+
+            if (selected.texture != texture) {
+                flush();
+                texture = selected.texture;
+            }
+            vertices->insert(vertices->end(), quad.begin(), quad.end());
+        }
+
+        /* Texels per screen pixel decide the variant, the larger axis scale is taken */
+        texture_variants::selection_t select_texture(const sf::Texture* sprite_texture, const core::affine2f& matrix) {
+            if (!variants)
+                return {sprite_texture, {1.f, 1.f}};
+
+            auto screen = states_transform * matrix;
+            auto scale  = std::max(screen.get_x_axis().magnitude(), screen.get_y_axis().magnitude()) * view_scale;
+            return variants->select(sprite_texture, scale);
+        }
+
+        /* Same quad as sf::Sprite makes, as two triangles */
+        static std::array<sf::Vertex, 6>
+        make_quad(const sf::Sprite& sprite, const core::affine2f& matrix, const sf::Vector2f& texcoord_scale) {
+            auto bounds = sprite.getLocalBounds();
+            auto rect   = sprite.getTextureRect();
+            auto color  = sprite.getColor();
+
+            std::array<core::vec2f, 4> corners = {
+                core::vec2f{0.f, 0.f},
+                core::vec2f{0.f, bounds.height},
+                core::vec2f{bounds.width, 0.f},
+                core::vec2f{bounds.width, bounds.height},
+            };
+            matrix.transform_points(corners);
+
+            auto left   = float(rect.left) * texcoord_scale.x;
+            auto top    = float(rect.top) * texcoord_scale.y;
+            auto right  = float(rect.left + rect.width) * texcoord_scale.x;
+            auto bottom = float(rect.top + rect.height) * texcoord_scale.y;
+
+            sf::Vertex left_top{corners[0], color, {left, top}};
+            sf::Vertex left_bottom{corners[1], color, {left, bottom}};
+            sf::Vertex right_top{corners[2], color, {right, top}};
+            sf::Vertex right_bottom{corners[3], color, {right, bottom}};
+
+            return {left_top, left_bottom, right_top, right_top, left_bottom, right_bottom};
+        }
+
+    private:
+        render_backend*          target;
+        sf::RenderStates         render_states;
+        std::vector<sf::Vertex>* vertices;
+        const texture_variants*  variants;
+        core::affine2f           states_transform;
+        float                    view_scale = 1.f;
+        const sf::Texture*       texture    = nullptr;
+        size_t                   draw_calls = 0;
+    };
+
     class batch {
     public:
         friend scene;
@@ -55,13 +188,17 @@ public:
         void draw(const scene*      scene,
                   sf::RenderTarget& target,
                   sf::RenderStates  render_states = sf::RenderStates::Default) const {
+            sfml_backend backend{target};
+            draw_context context{backend, render_states};
+            draw(scene, context);
+        }
+
+        void draw(const scene* scene, draw_context& context) const {
             if (elements.empty())
                 return;
 
             auto final_transform = calc_final_transform(scene);
-            render_states.transform.combine(final_transform);
-            for (auto element : elements)
-                downcast(element, [&](const sf::Drawable& drawable) { target.draw(drawable, render_states); });
+            for (auto&& element : elements) context.draw(element, final_transform);
         }
 
         auto get_users() const {
@@ -69,20 +206,18 @@ public:
         }
 
         void move(const core::vec2f& movement) {
-            transform.translate(movement);
+            transform *= core::affine2f::translation(movement);
         }
 
         void scale(const core::vec2f& scale) {
             /* TODO: optimize for 0 0 scale */
-            transform.scale(scale, calc_center());
+            transform *= core::affine2f::scaling(scale, calc_center());
         }
 
         core::vec2f calc_center() {
-            core::vec2f center{0, 0};
-            for (auto&& element : elements)
-                center +=
-                    std::visit([](auto&& obj) { return obj.getPosition(); }, element) * (1.f / float(elements.size()));
-            return center;
+            core::vec2f sum{0, 0};
+            for (auto&& element : elements) sum += std::visit([](auto&& obj) { return obj.getPosition(); }, element);
+            return elements.empty() ? sum : sum / float(elements.size());
         }
 
     private:
@@ -94,7 +229,7 @@ public:
             --users;
         }
 
-        sf::Transform calc_final_transform(const scene* scene) const {
+        core::affine2f calc_final_transform(const scene* scene) const {
             if (parent_id != empty_id) {
                 auto parent = scene->get_batch_pointer(parent_id);
                 if (parent)
@@ -106,7 +241,7 @@ public:
     private:
         layer_t                 layer;
         std::vector<drawable_t> elements;
-        sf::Transform           transform    = sf::Transform::Identity;
+        core::affine2f          transform;
         id_t                    parent_id    = empty_id;
         uint32_t                users        = 0;
         bool                    delete_later = false;
@@ -288,10 +423,37 @@ public:
     };
 
     void draw(sf::RenderTarget& target, const sf::RenderStates& render_states = sf::RenderStates::Default) const {
+        sfml_backend backend{target};
+        draw(backend, render_states);
+    }
+
+    /* Same as drawing to a sf::RenderTarget, recording_backend draws without GL context */
+    void draw(render_backend& target, const sf::RenderStates& render_states = sf::RenderStates::Default) const {
+        CORE_PROFILE_ZONE("scene::draw");
+        draw_context context{target, render_states, sprite_batching ? &batch_vertices : nullptr, variants};
+
         for (auto [layer, _] : layers_usage)
             for (auto&& [_, batch] : batches)
                 if (layer == batch.layer)
-                    batch.draw(this, target, render_states);
+                    batch.draw(this, context);
+
+        context.flush();
+        draw_calls = context.get_draw_calls();
+    }
+
+    /* Sprites sharing a texture (e.g. an atlas page) are drawn in one call, see draw_context */
+    void set_sprite_batching(bool value = true) {
+        sprite_batching = value;
+    }
+
+    /* Usually texture_mgr::get_variants(), sprites with variants are drawn with the one nearest to screen size */
+    void set_texture_variants(const texture_variants* value) {
+        variants = value;
+    }
+
+    /* Number of draw calls issued by the last draw */
+    size_t get_draw_calls() const {
+        return draw_calls;
     }
 
     template <typename T, typename... Args>
@@ -371,9 +533,13 @@ private:
     }
 
 private:
-    std::map<id_t, batch>       batches;
-    std::map<layer_t, uint64_t> layers_usage;
-    id_t                        id_counter = 0;
+    std::map<id_t, batch>           batches;
+    std::map<layer_t, uint64_t>     layers_usage;
+    id_t                            id_counter      = 0;
+    bool                            sprite_batching = false;
+    const texture_variants*         variants        = nullptr;
+    mutable std::vector<sf::Vertex> batch_vertices;
+    mutable size_t                  draw_calls      = 0;
 };
 
 inline scene::batch_ref scene::item_ref::get_parent() {
@@ -0,0 +1,314 @@
+#pragma once
+
+#include <memory>
+#include <numbers>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "efx.hpp"
+#include "keyframe_animation.hpp"
+
+namespace grx
+{
+class skeleton_error : public std::runtime_error {
+public:
+    skeleton_error(std::string msg): std::runtime_error(std::move(msg)) {}
+};
+
+/*
+ * Row-major 2x3 affine matrix
+ * x' = a * x + b * y + tx
+ * y' = c * x + d * y + ty
+ */
+struct bone_matrix {
+    float a = 1.f, b = 0.f, tx = 0.f;
+    float c = 0.f, d = 1.f, ty = 0.f;
+
+    /* Same convention as sf::Transformable: scale, then rotate clockwise (in degrees), then translate */
+    static bone_matrix from_components(float x, float y, float rotation, float scale_x, float scale_y) {
+        auto angle = rotation * std::numbers::pi_v<float> / 180.f;
+        auto cos   = std::cos(angle);
+        auto sin   = std::sin(angle);
+        return {scale_x * cos, -scale_y * sin, x, scale_x * sin, scale_y * cos, y};
+    }
+
+    bone_matrix operator*(const bone_matrix& m) const {
+        return {
+            a * m.a + b * m.c,
+            a * m.b + b * m.d,
+            a * m.tx + b * m.ty + tx,
+            c * m.a + d * m.c,
+            c * m.b + d * m.d,
+            c * m.tx + d * m.ty + ty,
+        };
+    }
+
+    core::vec2f position() const {
+        return {tx, ty};
+    }
+
+    float rotation() const {
+        return std::atan2(c, a) * 180.f / std::numbers::pi_v<float>;
+    }
+
+    /* Shear is not representable by sf::Transformable and gets lost here */
+    core::vec2f scale() const {
+        auto scale_x = std::sqrt(a * a + c * c);
+        return {scale_x, scale_x != 0.f ? (a * d - b * c) / scale_x : 0.f};
+    }
+};
+
+using skeleton_palette = std::vector<bone_matrix>;
+
+/*
+ * Local bone transforms in structure-of-arrays layout
+ */
+struct skeleton_pose {
+    void resize(size_t bones_count) {
+        position_x.resize(bones_count);
+        position_y.resize(bones_count);
+        scale_x.resize(bones_count);
+        scale_y.resize(bones_count);
+        rotation.resize(bones_count);
+    }
+
+    size_t size() const {
+        return rotation.size();
+    }
+
+    std::vector<float> position_x;
+    std::vector<float> position_y;
+    std::vector<float> scale_x;
+    std::vector<float> scale_y;
+    std::vector<float> rotation;
+};
+
+/*
+ * Bone hierarchy, every bone is added after its parent so poses can be resolved in one pass
+ */
+class skeleton {
+public:
+    using index_t = uint32_t;
+
+    static inline constexpr index_t no_parent = std::numeric_limits<index_t>::max();
+
+    index_t add_bone(const std::string& name,
+                     index_t            parent,
+                     const core::vec2f& position = {0, 0},
+                     float              rotation = 0.f,
+                     const core::vec2f& scale    = {1.f, 1.f}) {
+        auto idx = index_t(parents.size());
+        if (parent != no_parent && parent >= idx)
+            throw skeleton_error("Invalid parent for bone '" + name + "'");
+        if (find_bone(name) != no_parent)
+            throw skeleton_error("Bone '" + name + "' already exists");
+
+        names.push_back(name);
+        parents.push_back(parent);
+
+        bind_pose.position_x.push_back(position.x());
+        bind_pose.position_y.push_back(position.y());
+        bind_pose.scale_x.push_back(scale.x());
+        bind_pose.scale_y.push_back(scale.y());
+        bind_pose.rotation.push_back(rotation);
+
+        return idx;
+    }
+
+    index_t find_bone(const std::string& name) const {
+        for (index_t i = 0; i < names.size(); ++i)
+            if (names[i] == name)
+                return i;
+        return no_parent;
+    }
+
+    size_t size() const {
+        return parents.size();
+    }
+
+    const auto& get_parents() const {
+        return parents;
+    }
+
+    const auto& get_names() const {
+        return names;
+    }
+
+    const skeleton_pose& get_bind_pose() const {
+        return bind_pose;
+    }
+
+    /* Flattens local pose to world matrices, palette[i] belongs to bone i */
+    void calc_palette(const skeleton_pose& pose, skeleton_palette& palette, const bone_matrix& root = {}) const {
+        palette.resize(size());
+        for (size_t i = 0; i < size(); ++i) {
+            auto local = bone_matrix::from_components(
+                pose.position_x[i], pose.position_y[i], pose.rotation[i], pose.scale_x[i], pose.scale_y[i]);
+            palette[i] = (parents[i] == no_parent ? root : palette[parents[i]]) * local;
+        }
+    }
+
+private:
+    std::vector<std::string> names;
+    std::vector<index_t>     parents;
+    skeleton_pose            bind_pose;
+};
+
+/*
+ * Per-bone transform tracks, key times are in seconds
+ */
+class skeleton_clip {
+public:
+    skeleton_clip(size_t bones_count, float iduration, bool ilooped = true):
+        tracks(bones_count), duration(iduration), looped(ilooped) {}
+
+    anim_transform_track& get_track(skeleton::index_t bone) {
+        return tracks.at(bone);
+    }
+
+    const anim_transform_track& get_track(skeleton::index_t bone) const {
+        return tracks.at(bone);
+    }
+
+    float get_duration() const {
+        return duration;
+    }
+
+    bool is_looped() const {
+        return looped;
+    }
+
+    /* Channels without keys keep the bind pose values */
+    void sample(const skeleton& skel, float time, skeleton_pose& pose) const {
+        if (looped && duration > 0.f)
+            time = std::fmod(time, duration);
+
+        auto& bind = skel.get_bind_pose();
+        pose.resize(skel.size());
+
+        for (size_t i = 0; i < skel.size(); ++i) {
+            auto sample = tracks[i].lookup(time);
+
+            auto position = sample.position.value_or(core::vec2f{bind.position_x[i], bind.position_y[i]});
+            auto scale    = sample.scale.value_or(core::vec2f{bind.scale_x[i], bind.scale_y[i]});
+
+            pose.position_x[i] = position.x();
+            pose.position_y[i] = position.y();
+            pose.scale_x[i]    = scale.x();
+            pose.scale_y[i]    = scale.y();
+            pose.rotation[i]   = sample.rotation.value_or(bind.rotation[i]);
+        }
+    }
+
+private:
+    std::vector<anim_transform_track> tracks;
+    float                             duration;
+    bool                              looped;
+};
+
+/* Shortest signed difference between two angles in degrees */
+inline float angle_delta(float from, float to) {
+    auto delta = to - from;
+    return delta - 360.f * std::round(delta / 360.f);
+}
+
+/*
+ * result = lerp(a, b, weight), rotations are blended along the shortest arc
+ * Throws skeleton_error if the poses have different bone counts
+ */
+inline void blend_poses(const skeleton_pose& a, const skeleton_pose& b, float weight, skeleton_pose& result) {
+    if (a.size() != b.size())
+        throw skeleton_error("Poses bone count mismatch");
+
+    auto size = a.size();
+    result.resize(size);
+
+    for (size_t i = 0; i < size; ++i) result.position_x[i] = core::lerp(a.position_x[i], b.position_x[i], weight);
+    for (size_t i = 0; i < size; ++i) result.position_y[i] = core::lerp(a.position_y[i], b.position_y[i], weight);
+    for (size_t i = 0; i < size; ++i) result.scale_x[i] = core::lerp(a.scale_x[i], b.scale_x[i], weight);
+    for (size_t i = 0; i < size; ++i) result.scale_y[i] = core::lerp(a.scale_y[i], b.scale_y[i], weight);
+    for (size_t i = 0; i < size; ++i)
+        result.rotation[i] = a.rotation[i] + angle_delta(a.rotation[i], b.rotation[i]) * weight;
+}
+
+/*
+ * Weighted sum of N poses, weights are normalized, if they sum to zero the result is the first pose
+ * Rotations are accumulated as offsets from the first pose to stay on the shortest arcs
+ * Throws skeleton_error if the counts of poses and weights or the bone counts of the poses differ
+ */
+inline void blend_poses(std::span<const skeleton_pose* const> poses,
+                        std::span<const float>                weights,
+                        skeleton_pose&                        result) {
+    if (poses.empty() || poses.size() != weights.size())
+        throw skeleton_error("Poses and weights count mismatch");
+
+    auto& first = *poses.front();
+    auto  size  = first.size();
+    for (auto pose : poses)
+        if (pose->size() != size)
+            throw skeleton_error("Poses bone count mismatch");
+
+    float total = 0.f;
+    for (auto w : weights) total += w;
+    if (total == 0.f) {
+        result = first;
+        return;
+    }
+
+    auto inv_total = 1.f / total;
+    auto w0        = weights.front() * inv_total;
+
+    result.resize(size);
+    for (size_t i = 0; i < size; ++i) result.position_x[i] = first.position_x[i] * w0;
+    for (size_t i = 0; i < size; ++i) result.position_y[i] = first.position_y[i] * w0;
+    for (size_t i = 0; i < size; ++i) result.scale_x[i] = first.scale_x[i] * w0;
+    for (size_t i = 0; i < size; ++i) result.scale_y[i] = first.scale_y[i] * w0;
+    for (size_t i = 0; i < size; ++i) result.rotation[i] = first.rotation[i];
+
+    for (size_t p = 1; p < poses.size(); ++p) {
+        auto& pose = *poses[p];
+        auto  w    = weights[p] * inv_total;
+
+        for (size_t i = 0; i < size; ++i) result.position_x[i] += pose.position_x[i] * w;
+        for (size_t i = 0; i < size; ++i) result.position_y[i] += pose.position_y[i] * w;
+        for (size_t i = 0; i < size; ++i) result.scale_x[i] += pose.scale_x[i] * w;
+        for (size_t i = 0; i < size; ++i) result.scale_y[i] += pose.scale_y[i] * w;
+        for (size_t i = 0; i < size; ++i) result.rotation[i] += angle_delta(first.rotation[i], pose.rotation[i]) * w;
+    }
+}
+
+inline void apply_bone_matrix(sf::Transformable& obj, const bone_matrix& matrix) {
+    obj.setPosition(matrix.position());
+    obj.setRotation(matrix.rotation());
+    obj.setScale(matrix.scale());
+}
+
+namespace efx_handlers
+{
+    /*
+     * Plays the clip on the skeleton and places element i at the bone element_bones[i]
+     * Pose and palette are computed once per frame for the whole batch
+     */
+    inline auto skeleton_animation(std::shared_ptr<const skeleton>      skel,
+                                   std::shared_ptr<const skeleton_clip> clip,
+                                   std::vector<skeleton::index_t>       element_bones) {
+        return [skel = std::move(skel),
+                clip = std::move(clip),
+                element_bones = std::move(element_bones),
+                time = std::numeric_limits<float>::quiet_NaN(),
+                pose = skeleton_pose{},
+                palette = skeleton_palette{}](sf::Transformable& obj, const efx_state& state) mutable {
+            if (state.time_elapsed != time) {
+                time = state.time_elapsed;
+                clip->sample(*skel, time, pose);
+                skel->calc_palette(pose, palette);
+            }
+
+            if (state.idx < element_bones.size() && element_bones[state.idx] < palette.size())
+                apply_bone_matrix(obj, palette[element_bones[state.idx]]);
+        };
+    }
+} // namespace efx_handlers
+} // namespace grx
@@ -0,0 +1,338 @@
+#pragma once
+#include <algorithm>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <vector>
+
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/Graphics/Texture.hpp>
+
+#include "types.hpp"
+
+namespace grx
+{
+/*
+ * Skyline bottom-left rectangle packer
+ * The skyline is a list of horizontal segments, a rect is placed on the segment giving the lowest top edge
+ */
+class skyline_packer {
+public:
+    skyline_packer(uint32_t iwidth, uint32_t iheight): width(iwidth), height(iheight) {
+        clear();
+    }
+
+    void clear() {
+        skyline.assign(1, {0, 0, width});
+        used_area = 0;
+    }
+
+    std::optional<vec2u> insert(uint32_t rect_width, uint32_t rect_height) {
+        auto best_idx   = skyline.size();
+        auto best_top   = std::numeric_limits<uint32_t>::max();
+        auto best_width = std::numeric_limits<uint32_t>::max();
+        auto best_y     = uint32_t(0);
+
+        for (size_t i = 0; i < skyline.size(); ++i) {
+            auto y = fit(i, rect_width, rect_height);
+            if (!y)
+                continue;
+
+            auto top = *y + rect_height;
+            if (top < best_top || (top == best_top && skyline[i].width < best_width)) {
+                best_idx   = i;
+                best_top   = top;
+                best_width = skyline[i].width;
+                best_y     = *y;
+            }
+        }
+
+        if (best_idx == skyline.size())
+            return {};
+
+        auto x = skyline[best_idx].x;
+        add_level(best_idx, x, best_y + rect_height, rect_width);
+        used_area += uint64_t(rect_width) * rect_height;
+
+        return vec2u{x, best_y};
+    }
+
+    uint64_t get_used_area() const {
+        return used_area;
+    }
+
+    uint64_t get_area() const {
+        return uint64_t(width) * height;
+    }
+
+private:
+    struct node_t {
+        uint32_t x;
+        uint32_t y;
+        uint32_t width;
+    };
+
+    /* Lowest y where the rect starting at node idx fits, the rect spans the following nodes */
+    std::optional<uint32_t> fit(size_t idx, uint32_t rect_width, uint32_t rect_height) const {
+        auto x = skyline[idx].x;
+        if (x + rect_width > width)
+            return {};
+
+        uint32_t y         = 0;
+        int64_t  remaining = rect_width;
+        for (auto i = idx; remaining > 0; ++i) {
+            if (i == skyline.size())
+                return {};
+            y = std::max(y, skyline[i].y);
+            if (y + rect_height > height)
+                return {};
+            remaining -= skyline[i].width;
+        }
+        return y;
+    }
+
+    void add_level(size_t idx, uint32_t x, uint32_t y, uint32_t level_width) {
+        skyline.insert(skyline.begin() + ptrdiff_t(idx), {x, y, level_width});
+
+        /* Shrink or remove the nodes covered by the new one */
+        for (auto i = idx + 1; i < skyline.size();) {
+            auto& prev = skyline[i - 1];
+            auto& node = skyline[i];
+            if (node.x >= prev.x + prev.width)
+                break;
+
+            auto shrink = prev.x + prev.width - node.x;
+            if (shrink < node.width) {
+                node.x += shrink;
+                node.width -= shrink;
+                break;
+            }
+            skyline.erase(skyline.begin() + ptrdiff_t(i));
+        }
+
+        /* Merge neighbours of the same height */
+        for (size_t i = 0; i + 1 < skyline.size();) {
+            if (skyline[i].y == skyline[i + 1].y) {
+                skyline[i].width += skyline[i + 1].width;
+                skyline.erase(skyline.begin() + ptrdiff_t(i + 1));
+            }
+            else {
+                ++i;
+            }
+        }
+    }
+
+private:
+    uint32_t            width;
+    uint32_t            height;
+    std::vector<node_t> skyline;
+    uint64_t            used_area = 0;
+};
+
+struct texture_atlas_settings {
+    uint32_t page_size     = 2048;
+    uint32_t max_item_size = 256;
+    uint32_t padding       = 2;
+
+    /* Page is repacked by texture_atlas::repack when released area takes this part of its allocated area */
+    float repack_threshold = 0.5f;
+};
+
+/* Place of an image inside an atlas page, moves when the page is repacked */
+struct atlas_region {
+    const sf::Texture* texture = nullptr;
+    sf::IntRect        rect;
+    uint32_t           page = 0;
+};
+
+/*
+ * Packs small images into shared pages so sprites using them can be drawn in one call
+ * Released space is reused only after repack(), which is never done implicitly: it moves live regions, so sprites
+ * which copied rects before it must take them again. Regions keep their addresses, repacking updates their rects
+ * and increments the generation
+ * Thread-safe
+ */
+class texture_atlas {
+public:
+    texture_atlas(const texture_atlas_settings& isettings, bool ismooth, bool isrgb):
+        settings(isettings), smooth(ismooth), srgb(isrgb) {}
+
+    /* Returns nullptr if the image is too large for the atlas */
+    const atlas_region* insert(const sf::Image& image) {
+        auto size = image.getSize();
+        if (size.x == 0 || size.y == 0 || size.x > settings.max_item_size || size.y > settings.max_item_size)
+            return nullptr;
+
+        std::lock_guard lock{mtx};
+
+        auto& region = regions.emplace_back();
+        for (uint32_t i = 0; i < pages.size() && !region.texture; ++i) place(region, i, image);
+        if (!region.texture) {
+            add_page();
+            place(region, uint32_t(pages.size() - 1), image);
+        }
+        return &region;
+    }
+
+    void release(const atlas_region* region) {
+        std::lock_guard lock{mtx};
+
+        auto found = std::find_if(regions.begin(), regions.end(), [&](auto&& r) { return &r == region; });
+        if (found == regions.end())
+            return;
+
+        pages[found->page].released_area += padded_area(found->rect);
+        regions.erase(found);
+    }
+
+    /*
+     * Replaces the pixels of a live region, an image of the same size is written in place
+     * An image of another size is placed again as on repack: the region keeps its address, its rect changes
+     * and the generation is incremented. Returns false if the image is too large, the region is kept then
+     */
+    bool update(const atlas_region* region, const sf::Image& image) {
+        auto size = image.getSize();
+        if (size.x == 0 || size.y == 0 || size.x > settings.max_item_size || size.y > settings.max_item_size)
+            return false;
+
+        std::lock_guard lock{mtx};
+
+        auto found = std::find_if(regions.begin(), regions.end(), [&](auto&& r) { return &r == region; });
+        if (found == regions.end())
+            return false;
+
+        if (found->rect.width == int(size.x) && found->rect.height == int(size.y)) {
+            pages[found->page].texture.update(image, found->rect.left, found->rect.top);
+            return true;
+        }
+
+        pages[found->page].released_area += padded_area(found->rect);
+        found->texture = nullptr;
+        for (uint32_t i = 0; i < pages.size() && !found->texture; ++i) place(*found, i, image);
+        if (!found->texture) {
+            add_page();
+            place(*found, uint32_t(pages.size() - 1), image);
+        }
+        ++generation;
+        return true;
+    }
+
+    /*
+     * Repacks pages whose released area is over the threshold, returns their number
+     * Only safe when every sprite set up from regions of this atlas is set up again afterwards
+     */
+    size_t repack() {
+        std::lock_guard lock{mtx};
+
+        size_t repacked = 0;
+        for (uint32_t i = 0; i < pages.size(); ++i) {
+            auto& page = pages[i];
+            if (page.released_area &&
+                float(page.released_area) > settings.repack_threshold * float(page.packer.get_used_area())) {
+                repack(i);
+                ++repacked;
+            }
+        }
+        return repacked;
+    }
+
+    size_t get_pages_count() const {
+        std::lock_guard lock{mtx};
+        return pages.size();
+    }
+
+    uint64_t get_generation() const {
+        std::lock_guard lock{mtx};
+        return generation;
+    }
+
+private:
+    struct page_t {
+        page_t(uint32_t size): packer(size, size) {}
+
+        sf::Texture    texture;
+        skyline_packer packer;
+        uint64_t       released_area = 0;
+    };
+
+    uint64_t padded_area(const sf::IntRect& rect) const {
+        return uint64_t(rect.width + settings.padding) * uint64_t(rect.height + settings.padding);
+    }
+
+    void add_page() {
+        auto& page = pages.emplace_back(settings.page_size);
+        page.texture.create(settings.page_size, settings.page_size);
+        page.texture.setSmooth(smooth);
+        page.texture.setSrgb(srgb);
+
+        /* New texture memory is undefined, padding must stay transparent */
+        sf::Image clear;
+        clear.create(settings.page_size, settings.page_size, sf::Color::Transparent);
+        page.texture.update(clear);
+    }
+
+    /* Leaves region.texture empty if the page is full */
+    void place(atlas_region& region, uint32_t page_idx, const sf::Image& image) {
+        auto  size = image.getSize();
+        auto& page = pages[page_idx];
+
+        auto position = page.packer.insert(size.x + settings.padding, size.y + settings.padding);
+        if (!position)
+            return;
+
+        page.texture.update(image, position->x(), position->y());
+        region.texture = &page.texture;
+        region.rect    = {int(position->x()), int(position->y()), int(size.x), int(size.y)};
+        region.page    = page_idx;
+    }
+
+    /* Packs live regions of the page again, tallest first */
+    void repack(uint32_t page_idx) {
+        auto& page   = pages[page_idx];
+        auto  pixels = page.texture.copyToImage();
+
+        std::vector<atlas_region*> moved;
+        for (auto&& region : regions)
+            if (region.page == page_idx)
+                moved.push_back(&region);
+        std::sort(moved.begin(), moved.end(), [](auto a, auto b) { return a->rect.height > b->rect.height; });
+
+        sf::Image packed;
+        packed.create(settings.page_size, settings.page_size, sf::Color::Transparent);
+        page.packer.clear();
+        page.released_area = 0;
+
+        for (auto region : moved) {
+            auto old_rect = region->rect;
+            auto position = page.packer.insert(old_rect.width + settings.padding, old_rect.height + settings.padding);
+
+            /* Cannot happen in practice, the page held these regions before */
+            if (!position) {
+                sf::Image image;
+                image.create(old_rect.width, old_rect.height);
+                image.copy(pixels, 0, 0, old_rect);
+                add_page();
+                place(*region, uint32_t(pages.size() - 1), image);
+                continue;
+            }
+
+            packed.copy(pixels, position->x(), position->y(), old_rect);
+            region->rect = {int(position->x()), int(position->y()), old_rect.width, old_rect.height};
+        }
+
+        pages[page_idx].texture.update(packed);
+        ++generation;
+    }
+
+private:
+    texture_atlas_settings  settings;
+    bool                    smooth;
+    bool                    srgb;
+    mutable std::mutex      mtx;
+    std::deque<page_t>      pages;
+    std::list<atlas_region> regions;
+    uint64_t                generation = 0;
+};
+} // namespace grx
@@ -1,38 +1,885 @@
 #pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <limits>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
 
+#include <SFML/Graphics/Image.hpp>
 #include <SFML/Graphics/Texture.hpp>
 
+#include "core/asset_registry.hpp"
+#include "core/disk_cache.hpp"
+#include "core/hash.hpp"
+#include "core/profiler.hpp"
+#include "core/resource_pack.hpp"
+#include "core/thread_pool.hpp"
+#include "texture_atlas.hpp"
+#include "texture_variants.hpp"
+
 namespace grx
 {
+class texture_error : public std::runtime_error {
+public:
+    texture_error(std::string msg): std::runtime_error(std::move(msg)) {}
+};
+
 struct texture_def {
     std::string path;
     bool smooth = true;
     bool srgb = false;
     bool repeated = false;
 
+    /* GL mipmaps, for shapes and sprites drawn much smaller than the texture */
+    bool mipmap = false;
+
+    /* Number of half size copies made on a decode thread, scene draws sprites with the one nearest to screen size */
+    uint32_t variants = 0;
+
     auto operator<=>(const texture_def&) const = default;
 };
 
+struct texture_def_hash {
+    size_t operator()(const texture_def& def) const {
+        uint32_t flags = uint32_t(def.smooth) | uint32_t(def.srgb) << 1 | uint32_t(def.repeated) << 2 |
+                         uint32_t(def.mipmap) << 3 | def.variants << 4;
+        return size_t(core::fnv1a64(std::as_bytes(std::span(&flags, 1)), core::fnv1a64(def.path)));
+    }
+};
+
+struct texture_entry {
+    static int64_t now() {
+        return std::chrono::steady_clock::now().time_since_epoch().count();
+    }
+
+    sf::Texture           texture;
+    std::mutex            upload_mtx;
+    std::atomic<bool>     ready     = false;
+    std::atomic<bool>     requested = false; /* Queued for decoding by load_async, cleared by upload */
+    std::atomic<uint32_t> refs      = 0;
+    std::atomic<int64_t>  last_use  = 0;
+    std::atomic<bool>     pinned    = false; /* Returned by reference from texture_mgr::load, never evicted */
+    std::atomic<uint64_t> hits      = 0;     /* Per entry, a shared counter would be contended by all threads */
+    std::atomic<uint64_t> misses    = 0;
+    size_t                bytes     = 0;
+
+    /* Guarded by upload_mtx, variants_generation changes when variants are dropped so stale uploads are skipped */
+    std::vector<std::unique_ptr<sf::Texture>> variants;
+    size_t                                    variants_bytes      = 0;
+    bool                                      variants_requested  = false;
+    uint32_t                                  variants_generation = 0;
+};
+
+/*
+ * Counted reference to a texture, the texture is not evicted while any handle to it exists
+ * Handles made by load_async resolve to the placeholder until the texture is uploaded
+ * The placeholder has another size, sprites should reset their texture rect once the handle is ready
+ */
+class texture_handle {
+public:
+    texture_handle() = default;
+
+    texture_handle(const texture_handle& handle): entry(handle.entry), placeholder(handle.placeholder) {
+        if (entry)
+            entry->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    texture_handle(texture_handle&& handle) noexcept:
+        entry(std::exchange(handle.entry, nullptr)), placeholder(handle.placeholder) {}
+
+    texture_handle& operator=(texture_handle handle) noexcept {
+        std::swap(entry, handle.entry);
+        std::swap(placeholder, handle.placeholder);
+        return *this;
+    }
+
+    ~texture_handle() {
+        if (entry) {
+            entry->last_use.store(texture_entry::now(), std::memory_order_relaxed);
+            entry->refs.fetch_sub(1, std::memory_order_release);
+        }
+    }
+
+    bool is_ready() const {
+        return entry && entry->ready.load(std::memory_order_acquire);
+    }
+
+    const sf::Texture& get() const {
+        return is_ready() ? entry->texture : *placeholder;
+    }
+
+    const sf::Texture* operator->() const {
+        return &get();
+    }
+
+    explicit operator bool() const {
+        return entry;
+    }
+
+private:
+    friend class texture_mgr;
+
+    /* Takes the reference already counted by texture_mgr */
+    texture_handle(texture_entry* ientry, const sf::Texture* iplaceholder): entry(ientry), placeholder(iplaceholder) {}
+
+private:
+    texture_entry*     entry       = nullptr;
+    const sf::Texture* placeholder = nullptr;
+};
+
+/*
+ * Texture with the area of the image inside it, the whole texture or a part of an atlas page
+ * Rects given in the source image coordinates are mapped with map_rect
+ * Whole textures are held by a handle, atlas pages are never evicted
+ */
+class texture_region {
+public:
+    texture_region() = default;
+
+    texture_region(texture_handle ihandle):
+        handle(std::move(ihandle)),
+        whole_rect(0, 0, int(handle->getSize().x), int(handle->getSize().y)) {}
+
+    texture_region(const atlas_region& region): region(&region) {}
+
+    const sf::Texture& get_texture() const {
+        return region ? *region->texture : handle.get();
+    }
+
+    sf::IntRect get_rect() const {
+        return region ? region->rect : whole_rect;
+    }
+
+    sf::IntRect map_rect(const sf::IntRect& rect) const {
+        auto base = get_rect();
+        return {base.left + rect.left, base.top + rect.top, rect.width, rect.height};
+    }
+
+    bool is_atlas() const {
+        return region;
+    }
+
+    const texture_handle& get_handle() const {
+        return handle;
+    }
+
+private:
+    texture_handle      handle;
+    sf::IntRect         whole_rect;
+    const atlas_region* region = nullptr;
+};
+
+/* GPU upload limits for one texture_mgr::upload call, at least one texture is uploaded anyway */
+struct texture_upload_budget {
+    size_t bytes        = 16 << 20;
+    float  milliseconds = 2.f;
+};
+
+struct texture_stats {
+    uint64_t resident_bytes   = 0; /* Loaded textures without atlas pages */
+    uint64_t atlas_bytes      = 0;
+    uint64_t budget_bytes     = 0;
+    size_t   resident_count   = 0;
+    size_t   referenced_count = 0;
+    uint64_t hits             = 0; /* Requests for resident or already requested textures */
+    uint64_t misses           = 0; /* Requests which load the texture, first time or after eviction */
+    uint64_t evictions        = 0;
+};
+
+/*
+ * Thread-safe, every texture is loaded once, concurrent requests for the same texture wait for the first one
+ * Entries live in a sharded registry, requests for resident textures take no locks
+ * With a disk cache decoded pixels are stored by the definition and the source modification time,
+ * next runs map them and upload without reading or decoding the image file
+ * With a resource pack images are read from its mapping, files missing in the pack are loaded from disk
+ * load_async decodes images on background threads, upload() moves decoded images to GPU on the render thread
+ * Over the memory budget textures without handles are evicted, the least recently used first,
+ * an evicted texture is loaded again into the same sf::Texture on the next request
+ * Textures returned by reference from load are pinned and never evicted
+ * Downscaled variants requested by texture_def are decoded in background and uploaded by upload(),
+ * get_variants() gives them to scene::set_texture_variants
+ */
 class texture_mgr {
 public:
+    texture_mgr(size_t idecode_threads = 2): decode_threads(idecode_threads) {}
+
+    void set_cache(core::disk_cache* value) {
+        cache = value;
+    }
+
+    /* Should be set before loading, images found in the pack are decoded from it, others from loose files */
+    void set_pack(const core::resource_pack* value) {
+        pack = value;
+    }
+
+    /* Should be called before loading, textures loaded by load_region go to atlas pages if they fit */
+    void enable_atlas(const texture_atlas_settings& settings = {}) {
+        atlas_settings = settings;
+    }
+
+    /* Budget for textures outside atlas pages, unlimited by default */
+    void set_memory_budget(uint64_t bytes) {
+        memory_budget.store(bytes);
+        trim();
+    }
+
     sf::Texture& load(const texture_def& def) {
-        auto [it, was_insert] = cache.emplace(def, sf::Texture{});
-        if (was_insert) {
-            auto& texture = it->second;
-            texture.loadFromFile(def.path);
-            texture.setSmooth(def.smooth);
-            texture.setSrgb(def.srgb);
-            texture.setRepeated(def.repeated);
+        CORE_PROFILE_ZONE("texture_mgr::load");
+        auto& entry = get_entry(def);
+
+        /* Pinned before checking ready, trim checks them in the opposite order */
+        entry.pinned.store(true);
+        if (entry.ready.load()) {
+            entry.hits.fetch_add(1, std::memory_order_relaxed);
+            return entry.texture;
         }
-        return it->second;
+
+        {
+            std::lock_guard lock{entry.upload_mtx};
+            entry.last_use.store(texture_entry::now(), std::memory_order_relaxed);
+
+            /* Requested by load_async but not uploaded yet, the upload is skipped after this */
+            count_request(entry);
+            load_entry_locked(def, entry, false);
+        }
+
+        trim();
+        return entry.texture;
     }
 
     sf::Texture& load(const std::string& path, bool smooth = true, bool srgb = false, bool repeated = false) {
         return load(texture_def{path, smooth, srgb, repeated});
     }
 
+    /* Loads synchronously, the texture may be evicted after the last handle is destroyed */
+    texture_handle acquire(const texture_def& def) {
+        auto& entry = get_entry(def);
+
+        /* Counted before checking ready, trim checks them in the opposite order */
+        entry.refs.fetch_add(1);
+        if (entry.ready.load()) {
+            entry.hits.fetch_add(1, std::memory_order_relaxed);
+            return {&entry, &get_placeholder()};
+        }
+
+        {
+            std::lock_guard lock{entry.upload_mtx};
+            entry.last_use.store(texture_entry::now(), std::memory_order_relaxed);
+
+            count_request(entry);
+            load_entry_locked(def, entry, false);
+        }
+
+        trim();
+        return {&entry, &get_placeholder()};
+    }
+
+    texture_handle acquire(const std::string& path, bool smooth = true, bool srgb = false, bool repeated = false) {
+        return acquire(texture_def{path, smooth, srgb, repeated});
+    }
+
+    /*
+     * Small textures without repeat, mipmaps and variants are packed into atlas pages grouped by smooth and srgb flags
+     * Others and all textures without enabled atlas are loaded as with acquire
+     */
+    texture_region load_region(const texture_def& def) {
+        if (!atlas_settings || def.repeated || def.mipmap || def.variants > 0)
+            return acquire(def);
+
+        auto& entry = atlas_entries.get(def);
+        if (!entry.loaded.load(std::memory_order_acquire)) {
+            std::lock_guard lock{entry.load_mtx};
+            if (!entry.loaded.load(std::memory_order_relaxed)) {
+                sf::Image image;
+                if (decode_image(def, image)) {
+                    auto size = image.getSize();
+                    if (size.x <= atlas_settings->max_item_size && size.y <= atlas_settings->max_item_size)
+                        entry.region.store(get_atlas(def).insert(image), std::memory_order_relaxed);
+                }
+                entry.loaded.store(true, std::memory_order_release);
+            }
+        }
+
+        if (auto region = entry.region.load(std::memory_order_relaxed))
+            return *region;
+        return acquire(def);
+    }
+
+    texture_region load_region(const std::string& path, bool smooth = true, bool srgb = false) {
+        return load_region(texture_def{path, smooth, srgb, false});
+    }
+
+    /* Frees the atlas space, regions taken for the texture become invalid, other regions do not move */
+    void release_region(const texture_def& def) {
+        auto entry = atlas_entries.find(def);
+        if (!entry)
+            return;
+
+        std::lock_guard entry_lock{entry->load_mtx};
+        auto            region = entry->region.exchange(nullptr, std::memory_order_relaxed);
+        entry->loaded.store(false, std::memory_order_release);
+        if (!region)
+            return;
+
+        std::lock_guard lock{mtx};
+        atlases.at({def.smooth, def.srgb}).release(region);
+    }
+
+    /*
+     * Reclaims released atlas space, returns the number of repacked pages
+     * Live regions move, so sprites and effects set up from atlas regions must be built again after it
+     */
+    size_t repack_atlases() {
+        std::lock_guard lock{mtx};
+
+        size_t repacked = 0;
+        for (auto&& [_, atlas] : atlases) repacked += atlas.repack();
+        return repacked;
+    }
+
+    /* Changes when any atlas page is repacked */
+    uint64_t get_atlas_generation() const {
+        std::lock_guard lock{mtx};
+
+        uint64_t generation = 0;
+        for (auto&& [_, atlas] : atlases) generation += atlas.get_generation();
+        return generation;
+    }
+
+    size_t get_atlas_pages_count() const {
+        std::lock_guard lock{mtx};
+
+        size_t count = 0;
+        for (auto&& [_, atlas] : atlases) count += atlas.get_pages_count();
+        return count;
+    }
+
+    texture_handle load_async(const texture_def& def) {
+        auto& placeholder_texture = get_placeholder();
+        auto& entry               = get_entry(def);
+
+        std::lock_guard lock{entry.upload_mtx};
+        entry.refs.fetch_add(1, std::memory_order_relaxed);
+        entry.last_use.store(texture_entry::now(), std::memory_order_relaxed);
+        count_request(entry);
+
+        if (entry.ready.load(std::memory_order_relaxed)) {
+            request_variants_locked(def, entry);
+        }
+        else if (!entry.requested.exchange(true)) {
+            entry.variants_requested = entry.variants_requested || def.variants > 0;
+            ++pending;
+            get_decode_pool().submit([this, &entry, def, generation = entry.variants_generation] {
+                upload_t upload{&entry, def, {}, {}, generation, false};
+                decode_image(def, upload.image, &upload.variants);
+
+                std::lock_guard lock{uploads_mtx};
+                uploads.push_back(std::move(upload));
+            });
+        }
+
+        return {&entry, &placeholder_texture};
+    }
+
+    texture_handle load_async(const std::string& path, bool smooth = true, bool srgb = false, bool repeated = false) {
+        return load_async(texture_def{path, smooth, srgb, repeated});
+    }
+
+    /* Should be called before the first load_async */
+    void set_placeholder(const sf::Image& image) {
+        placeholder.loadFromImage(image);
+    }
+
+    /* Call on the render thread once per frame, returns the number of uploaded textures and variant sets */
+    size_t upload(const texture_upload_budget& budget = {}) {
+        auto start = std::chrono::steady_clock::now();
+
+        size_t bytes = 0;
+        size_t count = 0;
+        while (true) {
+            upload_t upload;
+            {
+                std::lock_guard lock{uploads_mtx};
+                if (uploads.empty())
+                    break;
+
+                auto elapsed = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start);
+                if (count > 0 && (bytes >= budget.bytes || elapsed.count() >= budget.milliseconds))
+                    break;
+
+                upload = std::move(uploads.front());
+                uploads.pop_front();
+            }
+
+            auto& entry = *upload.entry;
+            {
+                std::lock_guard lock{entry.upload_mtx};
+                if (!upload.variants_only) {
+                    if (!entry.ready.load(std::memory_order_relaxed)) {
+                        if (upload.image.getSize().x > 0)
+                            entry.texture.loadFromImage(upload.image);
+                        set_params(upload.def, entry.texture);
+                        set_resident(upload.def, entry);
+                    }
+                    entry.requested.store(false, std::memory_order_relaxed);
+                }
+
+                if (entry.ready.load(std::memory_order_relaxed) && entry.variants.empty() &&
+                    upload.variants_generation == entry.variants_generation)
+                    set_variants_locked(upload.def, entry, upload.variants);
+            }
+
+            bytes += size_t(upload.image.getSize().x) * upload.image.getSize().y * 4;
+            for (auto&& variant : upload.variants) bytes += size_t(variant.getSize().x) * variant.getSize().y * 4;
+            ++count;
+            if (!upload.variants_only)
+                --pending;
+        }
+
+        if (count > 0)
+            trim();
+        return count;
+    }
+
+    /* Textures requested by load_async and not uploaded yet */
+    size_t get_pending_count() const {
+        return pending.load();
+    }
+
+    /*
+     * Reloads in place every resident texture made from the file, drawables keep pointing to the same sf::Texture
+     * Evicted ones load the new file on the next request
+     * Atlas regions are updated in their pages, see texture_atlas::update. Throws texture_error if the new file
+     * cannot be decoded or is too large for the atlas, such regions keep the previous image
+     * Returns false if the file was never loaded
+     */
+    bool reload(const std::string& path) {
+        std::vector<std::pair<texture_def, texture_entry*>> found;
+        textures.for_each([&](auto&& def, auto&& entry) {
+            if (def.path == path)
+                found.emplace_back(def, &entry);
+        });
+
+        for (auto&& [def, entry] : found) {
+            std::lock_guard entry_lock{entry->upload_mtx};
+            if (entry->ready.load(std::memory_order_relaxed))
+                load_entry_locked(def, *entry, true);
+        }
+
+        std::vector<std::pair<texture_def, atlas_entry_t*>> found_regions;
+        atlas_entries.for_each([&](auto&& def, auto&& entry) {
+            if (def.path == path)
+                found_regions.emplace_back(def, &entry);
+        });
+
+        bool failed = false;
+        for (auto&& [def, entry] : found_regions) {
+            std::lock_guard entry_lock{entry->load_mtx};
+            auto            region = entry->region.load(std::memory_order_relaxed);
+            if (!region)
+                continue;
+
+            sf::Image image;
+            failed = !decode_image(def, image) || !get_atlas(def).update(region, image) || failed;
+        }
+        if (failed)
+            throw texture_error("Cannot reload atlas texture '" + path + "'");
+
+        return !found.empty() || !found_regions.empty();
+    }
+
+    /* Evicts unreferenced textures, the least recently used first, until the resident size fits the budget */
+    void trim() {
+        if (resident_bytes.load() <= memory_budget.load())
+            return;
+
+        std::lock_guard lock{trim_mtx};
+
+        std::vector<texture_entry*> candidates;
+        textures.for_each([&](auto&&, auto&& entry) {
+            if (is_evictable(entry))
+                candidates.push_back(&entry);
+        });
+
+        std::sort(candidates.begin(), candidates.end(), [](auto a, auto b) {
+            return a->last_use.load(std::memory_order_relaxed) < b->last_use.load(std::memory_order_relaxed);
+        });
+
+        for (auto entry : candidates) {
+            if (resident_bytes.load() <= memory_budget.load())
+                break;
+
+            /*
+             * upload_mtx only keeps loads of the entry out, acquire and load make handles and pins without it.
+             * They increment refs or set pinned and then read ready, here ready is cleared and then refs and
+             * pinned are read, all seq_cst: either the request sees ready cleared and loads the texture again
+             * under upload_mtx, or the count is seen here and the texture is kept
+             */
+            std::lock_guard entry_lock{entry->upload_mtx};
+            if (!is_evictable(*entry))
+                continue;
+
+            entry->ready.store(false);
+            if (entry->refs.load() > 0 || entry->pinned.load()) {
+                entry->ready.store(true);
+                continue;
+            }
+
+            drop_variants_locked(*entry);
+            sf::Texture().swap(entry->texture);
+            resident_bytes -= entry->bytes;
+            entry->bytes = 0;
+            ++evictions;
+        }
+    }
+
+    const texture_variants& get_variants() const {
+        return variants;
+    }
+
+    texture_stats get_stats() const {
+        texture_stats stats;
+        stats.resident_bytes = resident_bytes.load();
+        stats.budget_bytes   = memory_budget.load();
+        stats.evictions      = evictions.load();
+
+        textures.for_each([&](auto&&, auto&& entry) {
+            stats.hits += entry.hits.load(std::memory_order_relaxed);
+            stats.misses += entry.misses.load(std::memory_order_relaxed);
+            if (entry.ready.load(std::memory_order_relaxed))
+                ++stats.resident_count;
+            if (entry.refs.load(std::memory_order_relaxed) > 0 || entry.pinned.load(std::memory_order_relaxed))
+                ++stats.referenced_count;
+        });
+
+        std::lock_guard lock{mtx};
+        for (auto&& [_, atlas] : atlases)
+            stats.atlas_bytes += uint64_t(atlas.get_pages_count()) * atlas_settings->page_size *
+                                 atlas_settings->page_size * 4;
+        return stats;
+    }
+
+private:
+    /*
+     * Cached texture layout: header, then RGBA pixels of every mip level, each level is half of the previous one
+     * Level 0 is uploaded straight from the mapped file
+     */
+    struct cache_header_t {
+        std::array<char, 4> magic;
+        uint32_t            width;
+        uint32_t            height;
+        uint32_t            levels;
+    };
+
+    struct upload_t {
+        texture_entry*         entry = nullptr;
+        texture_def            def;
+        sf::Image              image;
+        std::vector<sf::Image> variants;
+        uint32_t               variants_generation = 0;
+        bool                   variants_only       = false;
+    };
+
+    /* Reset by release_region, the texture is packed again on the next request */
+    struct atlas_entry_t {
+        std::mutex                       load_mtx;
+        std::atomic<bool>                loaded = false;
+        std::atomic<const atlas_region*> region = nullptr;
+    };
+
+    static inline constexpr std::array<char, 4> cache_magic = {'F', 'D', 'T', 'X'};
+
+    template <typename T>
+    using entries_t = core::asset_registry<texture_def, T, texture_def_hash>;
+
+    texture_atlas& get_atlas(const texture_def& def) {
+        std::lock_guard lock{mtx};
+        return atlases.try_emplace({def.smooth, def.srgb}, *atlas_settings, def.smooth, def.srgb).first->second;
+    }
+
+    texture_entry& get_entry(const texture_def& def) {
+        return textures.get(def);
+    }
+
+    const sf::Texture& get_placeholder() {
+        std::call_once(placeholder_created, [&] {
+            if (placeholder.getSize().x == 0) {
+                sf::Image image;
+                image.create(1, 1, sf::Color::Transparent);
+                placeholder.loadFromImage(image);
+            }
+        });
+        return placeholder;
+    }
+
+    /* Created once without taking mtx, callers may hold mtx or entry locks */
+    core::thread_pool& get_decode_pool() {
+        std::call_once(decode_pool_created, [&] { decode_pool = std::make_unique<core::thread_pool>(decode_threads); });
+        return *decode_pool;
+    }
+
+    static void set_params(const texture_def& def, sf::Texture& texture) {
+        texture.setSmooth(def.smooth);
+        texture.setSrgb(def.srgb);
+        texture.setRepeated(def.repeated);
+        if (def.mipmap)
+            texture.generateMipmap();
+    }
+
+    static size_t texture_bytes(const texture_def& def, const sf::Texture& texture) {
+        auto size  = texture.getSize();
+        auto bytes = size_t(size.x) * size.y * 4;
+        return def.mipmap ? bytes + bytes / 3 : bytes;
+    }
+
+    static bool is_evictable(const texture_entry& entry) {
+        return entry.ready.load(std::memory_order_relaxed) && !entry.pinned.load(std::memory_order_relaxed) &&
+               entry.refs.load(std::memory_order_acquire) == 0;
+    }
+
+    static void count_request(texture_entry& entry) {
+        if (entry.ready.load(std::memory_order_relaxed) || entry.requested.load(std::memory_order_relaxed))
+            entry.hits.fetch_add(1, std::memory_order_relaxed);
+        else
+            entry.misses.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /* Called with entry.upload_mtx locked, variants are counted separately */
+    void set_resident(const texture_def& def, texture_entry& entry) {
+        auto bytes = texture_bytes(def, entry.texture);
+
+        resident_bytes += bytes;
+        resident_bytes -= entry.bytes;
+        entry.bytes = bytes;
+        entry.ready.store(true, std::memory_order_release);
+    }
+
+    /* Called with entry.upload_mtx locked */
+    void load_entry_locked(const texture_def& def, texture_entry& entry, bool force) {
+        if (!force && entry.ready.load(std::memory_order_relaxed))
+            return;
+
+        if (force)
+            drop_variants_locked(entry);
+        if (!cache || !load_cached(def, entry.texture))
+            load_source(def, entry.texture);
+        set_params(def, entry.texture);
+        set_resident(def, entry);
+        request_variants_locked(def, entry);
+    }
+
+    /* Called with entry.upload_mtx locked */
+    void request_variants_locked(const texture_def& def, texture_entry& entry) {
+        if (def.variants == 0 || entry.variants_requested)
+            return;
+
+        entry.variants_requested = true;
+        get_decode_pool().submit([this, &entry, def, generation = entry.variants_generation] {
+            upload_t upload{&entry, def, {}, {}, generation, true};
+            sf::Image image;
+            decode_image(def, image, &upload.variants);
+
+            std::lock_guard lock{uploads_mtx};
+            uploads.push_back(std::move(upload));
+        });
+    }
+
+    /* Called with entry.upload_mtx locked */
+    void set_variants_locked(const texture_def& def, texture_entry& entry, const std::vector<sf::Image>& images) {
+        std::vector<const sf::Texture*> variant_textures;
+        for (auto&& image : images) {
+            auto& texture = *entry.variants.emplace_back(std::make_unique<sf::Texture>());
+            texture.loadFromImage(image);
+            set_params(def, texture);
+            variant_textures.push_back(&texture);
+
+            auto bytes = texture_bytes(def, texture);
+            entry.variants_bytes += bytes;
+            resident_bytes += bytes;
+        }
+
+        if (!variant_textures.empty())
+            variants.set(&entry.texture, std::move(variant_textures));
+    }
+
+    /* Called with entry.upload_mtx locked, variants still being decoded are discarded on upload */
+    void drop_variants_locked(texture_entry& entry) {
+        if (!entry.variants.empty()) {
+            variants.remove(&entry.texture);
+            entry.variants.clear();
+        }
+
+        resident_bytes -= entry.variants_bytes;
+        entry.variants_bytes     = 0;
+        entry.variants_requested = false;
+        ++entry.variants_generation;
+    }
+
+    static sf::Vector2u level_size(const cache_header_t& header, uint32_t level) {
+        return {std::max(header.width >> level, 1u), std::max(header.height >> level, 1u)};
+    }
+
+    static size_t cached_pixels_size(const cache_header_t& header) {
+        size_t size = 0;
+        for (uint32_t level = 0; level < header.levels; ++level)
+            size += size_t(level_size(header, level).x) * level_size(header, level).y * 4;
+        return size;
+    }
+
+    /* Returns pointer to the level 0 pixels inside the mapped file or nullptr */
+    const sf::Uint8* find_cached(const std::string& key, core::mapped_file& cached, cache_header_t& header) const {
+        if (!cache->load(key, cached) || cached.size() < sizeof(cache_header_t))
+            return nullptr;
+
+        std::memcpy(&header, cached.data(), sizeof(header));
+        if (header.magic != cache_magic || header.levels == 0 || header.levels > 32 ||
+            cached.size() != sizeof(header) + cached_pixels_size(header))
+            return nullptr;
+
+        return reinterpret_cast<const sf::Uint8*>(cached.data() + sizeof(header));
+    }
+
+    /* Variants are the following mip levels */
+    void store_cached(const std::string& key, const sf::Image& image, const std::vector<sf::Image>& levels = {}) const {
+        cache_header_t header{cache_magic, image.getSize().x, image.getSize().y, uint32_t(1 + levels.size())};
+
+        std::vector<std::byte> data(sizeof(header) + cached_pixels_size(header));
+        std::memcpy(data.data(), &header, sizeof(header));
+
+        auto offset = sizeof(header);
+        for (uint32_t level = 0; level < header.levels; ++level) {
+            auto& level_image = level == 0 ? image : levels[level - 1];
+            auto  size        = size_t(level_image.getSize().x) * level_image.getSize().y * 4;
+            std::memcpy(data.data() + offset, level_image.getPixelsPtr(), size);
+            offset += size;
+        }
+        cache->store(key, data);
+    }
+
+    /*
+     * Key from the texture definition and the source file modification time and size,
+     * so hits do not read the source file at all, changed files get new keys
+     */
+    std::optional<std::string> cache_key(const texture_def& def) const {
+        auto flags = uint64_t(def.smooth) | uint64_t(def.srgb) << 1 | uint64_t(def.repeated) << 2;
+
+        /* Packed files have their content hash in the index */
+        if (auto entry = pack ? pack->find(def.path) : nullptr) {
+            uint64_t values[] = {entry->hash, uint64_t(entry->bytes.size()), flags};
+            auto     hash     = core::fnv1a64(entry->path);
+            return core::disk_cache::make_key("tx2", core::fnv1a64(std::as_bytes(std::span(values)), hash));
+        }
+
+        std::error_code ec;
+        auto            path = std::filesystem::absolute(def.path, ec);
+        auto            time = std::filesystem::last_write_time(path, ec);
+        if (ec)
+            return {};
+        auto size = std::filesystem::file_size(path, ec);
+        if (ec)
+            return {};
+
+        uint64_t values[] = {uint64_t(time.time_since_epoch().count()), uint64_t(size), flags};
+        auto     hash     = core::fnv1a64(path.string());
+        return core::disk_cache::make_key("tx2", core::fnv1a64(std::as_bytes(std::span(values)), hash));
+    }
+
+    /* The pack is zero-copy, its mapping is decoded in place */
+    bool decode_source(const texture_def& def, sf::Image& image) const {
+        if (auto entry = pack ? pack->find(def.path) : nullptr)
+            return image.loadFromMemory(entry->bytes.data(), entry->bytes.size());
+        return image.loadFromFile(def.path);
+    }
+
+    bool load_source(const texture_def& def, sf::Texture& texture) const {
+        if (auto entry = pack ? pack->find(def.path) : nullptr)
+            return texture.loadFromMemory(entry->bytes.data(), entry->bytes.size());
+        return texture.loadFromFile(def.path);
+    }
+
+    bool load_cached(const texture_def& def, sf::Texture& texture) const {
+        auto key = cache_key(def);
+        if (!key)
+            return false;
+
+        core::mapped_file cached;
+        cache_header_t    header;
+        if (auto pixels = find_cached(*key, cached, header); pixels && texture.create(header.width, header.height)) {
+            texture.update(pixels);
+            return true;
+        }
+
+        sf::Image image;
+        if (!decode_source(def, image) || !texture.loadFromImage(image))
+            return false;
+
+        /* With variants the decode thread making them stores all levels */
+        if (def.variants == 0)
+            store_cached(*key, image);
+        return true;
+    }
+
+    /* Runs on decode threads, no GL calls here, variants are taken from the cache or made by downscaling */
+    bool
+    decode_image(const texture_def& def, sf::Image& image, std::vector<sf::Image>* variant_images = nullptr) const {
+        auto key = cache ? cache_key(def) : std::nullopt;
+
+        core::mapped_file cached;
+        cache_header_t    header;
+        if (auto pixels = key ? find_cached(*key, cached, header) : nullptr;
+            pixels && (!variant_images || header.levels > def.variants)) {
+            image.create(header.width, header.height, pixels);
+            for (uint32_t level = 1; variant_images && level <= def.variants; ++level) {
+                auto prev_size = level_size(header, level - 1);
+                auto size      = level_size(header, level);
+                pixels += size_t(prev_size.x) * prev_size.y * 4;
+                variant_images->emplace_back().create(size.x, size.y, pixels);
+            }
+            return true;
+        }
+
+        if (!decode_source(def, image))
+            return false;
+
+        for (uint32_t level = 1; variant_images && level <= def.variants; ++level)
+            variant_images->push_back(downscale_half(level == 1 ? image : variant_images->back()));
+
+        if (key)
+            store_cached(*key, image, variant_images ? *variant_images : std::vector<sf::Image>{});
+        return true;
+    }
+
 private:
-    std::map<texture_def, sf::Texture> cache;
+    mutable std::mutex                             mtx; /* Guards atlases */
+    std::mutex                                     trim_mtx;
+    entries_t<texture_entry>                       textures;
+    std::optional<texture_atlas_settings>          atlas_settings;
+    std::map<std::pair<bool, bool>, texture_atlas> atlases;
+    entries_t<atlas_entry_t>                       atlas_entries;
+    texture_variants                               variants;
+    core::disk_cache*                              cache = nullptr;
+    const core::resource_pack*                     pack  = nullptr;
+    sf::Texture                                    placeholder;
+    std::once_flag                                 placeholder_created;
+    std::mutex                                     uploads_mtx;
+    std::deque<upload_t>                           uploads;
+    std::atomic<size_t>                            pending = 0;
+    std::atomic<uint64_t>                          memory_budget  = std::numeric_limits<uint64_t>::max();
+    std::atomic<uint64_t>                          resident_bytes = 0;
+    std::atomic<uint64_t>                          evictions      = 0;
+    size_t                                         decode_threads;
+    std::once_flag                                 decode_pool_created;
+    std::unique_ptr<core::thread_pool>             decode_pool; /* Last, stops decoding before the rest is destroyed */
 };
 } // namespace grx
@@ -0,0 +1,94 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/Graphics/Texture.hpp>
+
+namespace grx
+{
+/* Half size copy of the image, every pixel is the average of up to 2x2 source pixels */
+inline sf::Image downscale_half(const sf::Image& image) {
+    auto size   = image.getSize();
+    auto width  = std::max(size.x / 2, 1u);
+    auto height = std::max(size.y / 2, 1u);
+
+    std::vector<sf::Uint8> pixels(size_t(width) * height * 4);
+    auto                   src = image.getPixelsPtr();
+    if (src) {
+        for (unsigned y = 0; y < height; ++y) {
+            auto row0 = src + size_t(std::min(y * 2, size.y - 1)) * size.x * 4;
+            auto row1 = src + size_t(std::min(y * 2 + 1, size.y - 1)) * size.x * 4;
+            for (unsigned x = 0; x < width; ++x) {
+                auto x0 = std::min(x * 2, size.x - 1) * 4;
+                auto x1 = std::min(x * 2 + 1, size.x - 1) * 4;
+                for (unsigned c = 0; c < 4; ++c) {
+                    unsigned sum = row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c];
+                    pixels[(size_t(y) * width + x) * 4 + c] = sf::Uint8((sum + 2) / 4);
+                }
+            }
+        }
+    }
+
+    sf::Image result;
+    result.create(width, height, pixels.data());
+    return result;
+}
+
+/*
+ * Downscaled copies of textures, variant i is 2^(i+1) times smaller than its base texture
+ * Drawables keep referencing the base texture, the variant is looked up when drawing
+ * Thread-safe
+ */
+class texture_variants {
+public:
+    struct selection_t {
+        const sf::Texture* texture;
+        sf::Vector2f       texcoord_scale; /* Maps base texture coordinates to the selected texture */
+    };
+
+    void set(const sf::Texture* base, std::vector<const sf::Texture*> variants) {
+        std::lock_guard lock{mtx};
+        if (textures.insert_or_assign(base, std::move(variants)).second)
+            ++count;
+    }
+
+    void remove(const sf::Texture* base) {
+        std::lock_guard lock{mtx};
+        if (textures.erase(base))
+            --count;
+    }
+
+    /* The smallest variant not smaller than the base texture drawn with the scale (screen pixels per texel) */
+    selection_t select(const sf::Texture* base, float scale) const {
+        if (count.load(std::memory_order_relaxed) == 0 || !(scale > 0.f) || scale >= 0.5f)
+            return {base, {1.f, 1.f}};
+
+        std::shared_lock lock{mtx};
+
+        auto found = textures.find(base);
+        if (found == textures.end() || found->second.empty())
+            return {base, {1.f, 1.f}};
+
+        auto& variants = found->second;
+        auto  level    = std::min(size_t(std::floor(std::log2(1.f / scale))), variants.size());
+        if (level == 0)
+            return {base, {1.f, 1.f}};
+
+        auto variant      = variants[level - 1];
+        auto base_size    = base->getSize();
+        auto variant_size = variant->getSize();
+        return {variant, {float(variant_size.x) / float(base_size.x), float(variant_size.y) / float(base_size.y)}};
+    }
+
+private:
+    mutable std::shared_mutex                                               mtx;
+    std::unordered_map<const sf::Texture*, std::vector<const sf::Texture*>> textures;
+    std::atomic<size_t>                                                     count = 0;
+};
+} // namespace grx
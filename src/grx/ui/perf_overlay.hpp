@@ -0,0 +1,270 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <string_view>
+
+#include <imgui.h>
+
+#include "grx/efx.hpp"
+#include "grx/scene.hpp"
+#include "grx/texture_mgr.hpp"
+
+namespace ui
+{
+namespace imgui = ImGui;
+
+/* Last N samples, oldest first from offset(), nothing is allocated after construction */
+template <size_t N>
+class sample_ring {
+public:
+    void push(float value) {
+        values[next] = value;
+        next         = (next + 1) % N;
+        count        = std::min(count + 1, N);
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    const float* data() const {
+        return values.data();
+    }
+
+    /* Index of the oldest sample, as ImGui::PlotLines takes it */
+    size_t offset() const {
+        return count < N ? 0 : next;
+    }
+
+    float back() const {
+        return count ? values[(next + N - 1) % N] : 0.f;
+    }
+
+    float average() const {
+        float sum = 0.f;
+        for (size_t i = 0; i < count; ++i) sum += values[i];
+        return count ? sum / float(count) : 0.f;
+    }
+
+    float max() const {
+        return count ? *std::max_element(values.begin(), values.begin() + count) : 0.f;
+    }
+
+    /* Sorted copy of the samples to scratch, percentile() reads it */
+    void sort_to(std::array<float, N>& scratch) const {
+        std::copy_n(values.begin(), count, scratch.begin());
+        std::sort(scratch.begin(), scratch.begin() + count);
+    }
+
+    float percentile(const std::array<float, N>& sorted, float fraction) const {
+        if (!count)
+            return 0.f;
+        return sorted[std::min(size_t(fraction * float(count)), count - 1)];
+    }
+
+private:
+    std::array<float, N> values{};
+    size_t               next  = 0;
+    size_t               count = 0;
+};
+
+/*
+ * ImGui window with frame times of the last history_size frames: graph, distribution histogram and percentiles,
+ * where average FPS hides hitches. Also timings of sections measured with measure(), scene and effect counters,
+ * draw calls of the last scene::draw and texture memory
+ *
+ *     overlay.add_frame(frame_seconds);
+ *     { auto timer = overlay.measure("efx"); efx_mgr.update(timestep); }
+ *     overlay.show(scene, efx_mgr, &tx_mgr);
+ *
+ * Samples are kept in fixed rings, nothing is allocated per frame
+ */
+class perf_overlay {
+    using clock_t = std::chrono::steady_clock;
+
+public:
+    static constexpr size_t history_size  = 240;
+    static constexpr size_t max_sections  = 8;
+    static constexpr size_t buckets_count = 32;
+
+    class section_timer {
+    public:
+        section_timer(float* itarget): target(itarget), start(clock_t::now()) {}
+
+        section_timer(const section_timer&)            = delete;
+        section_timer& operator=(const section_timer&) = delete;
+
+        ~section_timer() {
+            if (target)
+                *target += std::chrono::duration<float, std::milli>(clock_t::now() - start).count();
+        }
+
+    private:
+        float*              target;
+        clock_t::time_point start;
+    };
+
+    /* Time of a finished frame, sections measured since the previous call are closed with it */
+    void add_frame(float frame_seconds) {
+        frame_times.push(frame_seconds * 1000.f);
+        for (size_t i = 0; i < sections_count; ++i) {
+            sections[i].times.push(sections[i].current);
+            sections[i].current = 0.f;
+        }
+    }
+
+    /*
+     * Adds the time until the timer is destroyed to the section of the current frame, names are compared by value
+     * and must outlive the overlay (string literals), sections over max_sections are not measured
+     */
+    section_timer measure(std::string_view name) {
+        for (size_t i = 0; i < sections_count; ++i)
+            if (sections[i].name == name)
+                return {&sections[i].current};
+
+        if (sections_count == max_sections)
+            return {nullptr};
+
+        auto& section = sections[sections_count++];
+        section.name  = name;
+        return {&section.current};
+    }
+
+    void set_visible(bool value) {
+        visible = value;
+    }
+
+    bool is_visible() const {
+        return visible;
+    }
+
+    void toggle() {
+        visible = !visible;
+    }
+
+    /* Between ImGui::SFML::Update and Render, textures are optional */
+    void show(const grx::scene& scene, const grx::efx_mgr& effects, const grx::texture_mgr* textures = nullptr) {
+        if (!visible)
+            return;
+
+        imgui::SetNextWindowPos({10.f, 10.f}, ImGuiCond_FirstUseEver);
+        imgui::SetNextWindowBgAlpha(0.7f);
+        auto flags = ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoFocusOnAppearing;
+        if (!imgui::Begin("Performance", &visible, flags)) {
+            imgui::End();
+            return;
+        }
+
+        show_frame_times();
+        show_sections();
+
+        imgui::Separator();
+        imgui::Text("batches %zu, elements %zu, draw calls %zu",
+                    scene.get_batches_count(),
+                    scene.get_elements_count(),
+                    scene.get_draw_calls());
+        imgui::Text("effect instances %zu", effects.get_instances_count());
+
+        if (textures) {
+            auto stats = textures->get_stats();
+            imgui::Text("textures %zu, %.1f MiB + atlases %.1f MiB, budget %.1f MiB",
+                        stats.resident_count,
+                        double(stats.resident_bytes) / mib,
+                        double(stats.atlas_bytes) / mib,
+                        double(stats.budget_bytes) / mib);
+        }
+
+        imgui::End();
+    }
+
+private:
+    static constexpr double mib = 1024. * 1024.;
+
+    struct section {
+        std::string_view          name;
+        float                     current = 0.f;
+        sample_ring<history_size> times;
+    };
+
+    void show_frame_times() {
+        frame_times.sort_to(sorted);
+        auto p50     = frame_times.percentile(sorted, 0.5f);
+        auto p95     = frame_times.percentile(sorted, 0.95f);
+        auto p99     = frame_times.percentile(sorted, 0.99f);
+        auto max     = frame_times.max();
+        auto average = frame_times.average();
+
+        imgui::Text("frame %.2f ms, average %.2f ms (%.0f fps)",
+                    frame_times.back(),
+                    average,
+                    average > 0.f ? 1000.f / average : 0.f);
+        imgui::Text("p50 %.2f  p95 %.2f  p99 %.2f  max %.2f ms", p50, p95, p99, max);
+
+        /* Graph scale and histogram range are rounded up to whole milliseconds, so they do not jitter */
+        auto range = std::max(std::ceil(max), 1.f);
+        imgui::PlotLines("##frame_times",
+                         frame_times.data(),
+                         int(frame_times.size()),
+                         int(frame_times.offset()),
+                         nullptr,
+                         0.f,
+                         range,
+                         {300.f, 60.f});
+
+        buckets.fill(0.f);
+        for (size_t i = 0; i < frame_times.size(); ++i)
+            ++buckets[std::min(size_t(sorted[i] / range * float(buckets_count)), buckets_count - 1)];
+
+        char label[32];
+        std::snprintf(label, sizeof(label), "0 - %.0f ms", range);
+        imgui::PlotHistogram("##frame_histogram",
+                             buckets.data(),
+                             int(buckets.size()),
+                             0,
+                             label,
+                             0.f,
+                             float(frame_times.size()),
+                             {300.f, 60.f});
+    }
+
+    void show_sections() {
+        if (!sections_count)
+            return;
+
+        imgui::Separator();
+        if (!imgui::BeginTable("##sections", 4))
+            return;
+
+        imgui::TableSetupColumn("section");
+        imgui::TableSetupColumn("last ms");
+        imgui::TableSetupColumn("average");
+        imgui::TableSetupColumn("max");
+        imgui::TableHeadersRow();
+
+        for (size_t i = 0; i < sections_count; ++i) {
+            auto& s = sections[i];
+            imgui::TableNextRow();
+            imgui::TableNextColumn();
+            imgui::Text("%.*s", int(s.name.size()), s.name.data());
+            imgui::TableNextColumn();
+            imgui::Text("%.2f", s.times.back());
+            imgui::TableNextColumn();
+            imgui::Text("%.2f", s.times.average());
+            imgui::TableNextColumn();
+            imgui::Text("%.2f", s.times.max());
+        }
+        imgui::EndTable();
+    }
+
+private:
+    sample_ring<history_size>         frame_times;
+    std::array<float, history_size>   sorted{};
+    std::array<float, buckets_count>  buckets{};
+    std::array<section, max_sections> sections;
+    size_t                            sections_count = 0;
+    bool                              visible        = true;
+};
+} // namespace ui
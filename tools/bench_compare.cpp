@@ -0,0 +1,94 @@
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <string_view>
+
+#include <nlohmann/json.hpp>
+
+struct bench_result {
+    double      value;
+    std::string unit;
+    bool        lower_is_better;
+};
+
+static std::map<std::string, bench_result> load_results(const std::string& path) {
+    std::ifstream ifs(path);
+    if (!ifs)
+        throw std::runtime_error("Cannot open '" + path + "'");
+
+    auto json = nlohmann::json::parse(ifs);
+
+    std::map<std::string, bench_result> results;
+    for (auto&& r : json.at("results"))
+        results.emplace(r.at("name").get<std::string>(),
+                        bench_result{r.at("value").get<double>(),
+                                     r.at("unit").get<std::string>(),
+                                     r.value("lower_is_better", true)});
+    return results;
+}
+
+/*
+ * Compares two result files of bench::reporter (bench_suite --json), a case which got worse by more than
+ * the threshold percent is a regression, cases present in one file only are listed but do not fail
+ * Usage: bench_compare <baseline.json> <current.json> [--threshold <percent>]
+ * Exits with 1 if there are regressions
+ */
+int main(int argc, char** argv) {
+    if (argc != 3 && !(argc == 5 && std::string_view(argv[3]) == "--threshold")) {
+        std::cerr << "Usage: " << argv[0] << " <baseline.json> <current.json> [--threshold <percent>]" << std::endl;
+        return 1;
+    }
+
+    auto threshold = argc == 5 ? std::stod(argv[4]) : 10.;
+
+    std::map<std::string, bench_result> baseline, current;
+    try {
+        baseline = load_results(argv[1]);
+        current  = load_results(argv[2]);
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    size_t regressions = 0;
+    std::cout << std::fixed << std::setprecision(3);
+    for (auto&& [name, base] : baseline) {
+        auto found = current.find(name);
+        if (found == current.end()) {
+            std::cout << name << ": missing in current" << std::endl;
+            continue;
+        }
+
+        auto& cur = found->second;
+        if (cur.unit != base.unit) {
+            std::cout << name << ": unit changed from " << base.unit << " to " << cur.unit << std::endl;
+            continue;
+        }
+
+        /* Positive change is worse whichever direction is better */
+        auto change = base.value == 0. ? 0. : (cur.value - base.value) / std::abs(base.value) * 100.;
+        if (!base.lower_is_better)
+            change = -change;
+
+        auto regression = change > threshold;
+        regressions += regression;
+
+        std::cout << name << ": " << base.value << " -> " << cur.value << " " << cur.unit << ", "
+                  << std::showpos << change << std::noshowpos << "%"
+                  << (regression ? "  REGRESSION" : change < -threshold ? "  improved" : "") << std::endl;
+    }
+
+    for (auto&& [name, _] : current)
+        if (!baseline.contains(name))
+            std::cout << name << ": new" << std::endl;
+
+    if (regressions) {
+        std::cout << regressions << " regressions over " << threshold << "%" << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,35 @@
+#include <iostream>
+
+#include "grx/efx_binary.hpp"
+#include "grx/efx_editor.hpp"
+
+/*
+ * Compiles effect JSON files to the binary format loaded by efx_binary_loader
+ * Usage: efx_compiler <input.json> <output.efxb> [<input.json> <output.efxb>...]
+ */
+int main(int argc, char** argv) {
+    if (argc < 3 || argc % 2 == 0) {
+        std::cerr << "Usage: " << argv[0] << " <input.json> <output.efxb> [<input.json> <output.efxb>...]" << std::endl;
+        return 1;
+    }
+
+    grx::texture_mgr tx_mgr;
+
+    for (int i = 1; i < argc; i += 2) {
+        std::string input  = argv[i];
+        std::string output = argv[i + 1];
+
+        try {
+            grx::efx_editor::efx_binary_writer writer;
+            writer.write(grx::efx_editor::efx_builder(tx_mgr, input).describe());
+            if (!writer.save(output)) {
+                std::cerr << "Cannot write '" << output << "'" << std::endl;
+                return 1;
+            }
+        }
+        catch (const std::exception& e) {
+            std::cerr << input << ": " << e.what() << std::endl;
+            return 1;
+        }
+    }
+}
@@ -0,0 +1,54 @@
+#include <filesystem>
+#include <iostream>
+
+#include "core/resource_pack.hpp"
+
+/*
+ * Packs files into one resource pack, directories are packed recursively
+ * Entries keep the paths as given, so run it from the directory the game is started from
+ * Usage: resource_packer <output.pack> <file or directory>...
+ */
+int main(int argc, char** argv) {
+    namespace fs = std::filesystem;
+
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " <output.pack> <file or directory>..." << std::endl;
+        return 1;
+    }
+
+    core::resource_pack_writer writer;
+
+    auto add_file = [&](const fs::path& path) {
+        if (!writer.add_file(path.string())) {
+            std::cerr << "Cannot read '" << path.string() << "'" << std::endl;
+            return false;
+        }
+        return true;
+    };
+
+    for (int i = 2; i < argc; ++i) {
+        fs::path        input = argv[i];
+        std::error_code ec;
+
+        if (fs::is_directory(input, ec)) {
+            for (auto&& entry : fs::recursive_directory_iterator(input, ec))
+                if (entry.is_regular_file() && !add_file(entry.path()))
+                    return 1;
+        }
+        else if (!add_file(input)) {
+            return 1;
+        }
+
+        if (ec) {
+            std::cerr << "Cannot read '" << input.string() << "': " << ec.message() << std::endl;
+            return 1;
+        }
+    }
+
+    if (!writer.save(argv[1])) {
+        std::cerr << "Cannot write '" << argv[1] << "'" << std::endl;
+        return 1;
+    }
+
+    std::cout << writer.size() << " files packed into '" << argv[1] << "'" << std::endl;
+}